@@ -0,0 +1,87 @@
+# FindFFTW3Ext.cmake
+#
+# Find the FFTW3 libraries that are not provided by FFTW3::FFTW3 (double
+# precision): the single-precision and thread libraries. Each requested
+# component defines the imported target FFTW3Ext::<component>, e.g.
+#
+#   find_package(FFTW3Ext REQUIRED COMPONENTS fftw3f fftw3_threads fftw3f_threads)
+#   target_link_libraries(mylib PRIVATE FFTW3Ext::fftw3f)
+#
+# Valid components are fftw3f, fftw3l, fftw3_threads, fftw3f_threads and
+# fftw3l_threads. The libraries are searched for next to the library of
+# FFTW3::FFTW3 (if it is already found) and in $FFTW_LIBRARY. Each target
+# carries the FFTW3::FFTW3 usage requirements (the fftw3.h include path) and
+# a thread library also links its precision library.
+
+include(FindPackageHandleStandardArgs)
+
+set(_fftw3ext_hints)
+if (TARGET FFTW3::FFTW3)
+  get_target_property(_fftw3ext_loc FFTW3::FFTW3 IMPORTED_LOCATION)
+  if (_fftw3ext_loc)
+    get_filename_component(_fftw3ext_dir "${_fftw3ext_loc}" DIRECTORY)
+    list(APPEND _fftw3ext_hints "${_fftw3ext_dir}")
+  endif()
+endif()
+
+set(_fftw3ext_libs)
+foreach (_fftw3ext_comp IN LISTS FFTW3Ext_FIND_COMPONENTS)
+  if (NOT _fftw3ext_comp MATCHES "^fftw3[fl]?(_threads)?$" OR _fftw3ext_comp STREQUAL "fftw3")
+    message(WARNING "FindFFTW3Ext: ignoring invalid component ${_fftw3ext_comp}")
+    continue()
+  endif()
+  string(TOUPPER "${_fftw3ext_comp}" _fftw3ext_COMP)
+  find_library(FFTW3Ext_${_fftw3ext_COMP}_LIBRARY NAMES ${_fftw3ext_comp}
+    HINTS ${_fftw3ext_hints} ENV FFTW_LIBRARY)
+  mark_as_advanced(FFTW3Ext_${_fftw3ext_COMP}_LIBRARY)
+  if (FFTW3Ext_${_fftw3ext_COMP}_LIBRARY)
+    set(FFTW3Ext_${_fftw3ext_comp}_FOUND TRUE)
+    list(APPEND _fftw3ext_libs "${FFTW3Ext_${_fftw3ext_COMP}_LIBRARY}")
+  else()
+    set(FFTW3Ext_${_fftw3ext_comp}_FOUND FALSE)
+  endif()
+endforeach()
+
+find_package_handle_standard_args(FFTW3Ext
+  REQUIRED_VARS _fftw3ext_libs
+  HANDLE_COMPONENTS)
+
+if (FFTW3Ext_FOUND)
+  set(FFTW3Ext_LIBRARIES ${_fftw3ext_libs})
+  set(_fftw3ext_new)
+  foreach (_fftw3ext_comp IN LISTS FFTW3Ext_FIND_COMPONENTS)
+    if (NOT FFTW3Ext_${_fftw3ext_comp}_FOUND OR TARGET FFTW3Ext::${_fftw3ext_comp})
+      continue()
+    endif()
+    string(TOUPPER "${_fftw3ext_comp}" _fftw3ext_COMP)
+    add_library(FFTW3Ext::${_fftw3ext_comp} UNKNOWN IMPORTED)
+    set_target_properties(FFTW3Ext::${_fftw3ext_comp} PROPERTIES
+      IMPORTED_LOCATION "${FFTW3Ext_${_fftw3ext_COMP}_LIBRARY}")
+    list(APPEND _fftw3ext_new ${_fftw3ext_comp})
+  endforeach()
+  # Dependencies are added once all targets exist.
+  foreach (_fftw3ext_comp IN LISTS _fftw3ext_new)
+    set(_fftw3ext_deps)
+    if (TARGET FFTW3::FFTW3)
+      list(APPEND _fftw3ext_deps FFTW3::FFTW3)
+    endif()
+    string(REPLACE "_threads" "" _fftw3ext_base "${_fftw3ext_comp}")
+    if (NOT _fftw3ext_base STREQUAL _fftw3ext_comp AND TARGET FFTW3Ext::${_fftw3ext_base})
+      list(APPEND _fftw3ext_deps FFTW3Ext::${_fftw3ext_base})
+    endif()
+    if (_fftw3ext_deps)
+      set_target_properties(FFTW3Ext::${_fftw3ext_comp} PROPERTIES
+        INTERFACE_LINK_LIBRARIES "${_fftw3ext_deps}")
+    endif()
+  endforeach()
+endif()
+
+unset(_fftw3ext_hints)
+unset(_fftw3ext_loc)
+unset(_fftw3ext_dir)
+unset(_fftw3ext_libs)
+unset(_fftw3ext_deps)
+unset(_fftw3ext_new)
+unset(_fftw3ext_base)
+unset(_fftw3ext_comp)
+unset(_fftw3ext_COMP)
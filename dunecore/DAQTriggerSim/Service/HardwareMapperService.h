@@ -24,6 +24,8 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <mutex>
 #include <iostream>
 #include <iosfwd> // std::ostream
 
@@ -49,19 +51,27 @@ class HardwareMapperService{
 
   void printGeometryInfo(); //jpd -- testing function to print geometry information once loaded
 
-  unsigned int getNASICs() const { return fASICMap.size();}
-  unsigned int getNBoards() const { return fBoardMap.size();}
-  unsigned int getNAPAs() const { return fAPAMap.size();}
-  unsigned int getNTPCs() const { return fTPCMap.size();}
+  //The maps are built on first access (thread safe).
+  unsigned int getNASICs() const { return getASICMap().size();}
+  unsigned int getNBoards() const { return getBoardMap().size();}
+  unsigned int getNAPAs() const { return getAPAMap().size();}
+  unsigned int getNTPCs() const { return getTPCMap().size();}
+
+  Hardware::ASICMap const& getASICMap() const;
+  Hardware::BoardMap const& getBoardMap() const;
+  Hardware::TPCMap const& getTPCMap() const;
+  Hardware::APAMap const& getAPAMap() const;
 
 
   //jpd -- These are the main user accessible functions - dish out vectors of channel ids
+  //The channels are in increasing order.
   std::vector<raw::ChannelID_t> const& getTPCChannels(Hardware::ID tpc_id);
   std::vector<raw::ChannelID_t> const& getAPAChannels(Hardware::ID apa_id);
 
   //jpd -- For users that prefer a std::set
-  std::set<raw::ChannelID_t> const& getTPCChannelsSet(Hardware::ID tpc_id);
-  std::set<raw::ChannelID_t> const& getAPAChannelsSet(Hardware::ID apa_id);
+  //The set is built from the sorted channels on each call.
+  std::set<raw::ChannelID_t> getTPCChannelsSet(Hardware::ID tpc_id);
+  std::set<raw::ChannelID_t> getAPAChannelsSet(Hardware::ID apa_id);
 
   //jpd -- We register this such that it gets called just before we process a new run
   //    -- It double checks that the geometry we filled with is the same as that used 
@@ -82,16 +92,26 @@ class HardwareMapperService{
   std::string fDetectorNameFromFile;
 
   //jpd -- these read in the geometry information and fill internal maps of ID->Hardware::Element
-  void fillASICMap();
-  void fillBoardMap();
-  void fillTPCMap();
-  void fillAPAMap();
+  //    -- They are called once each through the getters.
+  void fillASICMap() const;
+  void fillBoardMap() const;
+  void fillTPCMap() const;
+  void fillAPAMap() const;
   void fillHardwareMaps();
 
-  Hardware::ASICMap fASICMap;
-  Hardware::BoardMap fBoardMap;
-  Hardware::TPCMap fTPCMap;
-  Hardware::APAMap fAPAMap;
+  //Return the channels for each TPC number found from the readout planes.
+  std::map<Hardware::ID, std::vector<raw::ChannelID_t>> findTPCChannels() const;
+
+  //The maps are filled lazily under the once flags.
+  mutable Hardware::ASICMap fASICMap;
+  mutable Hardware::BoardMap fBoardMap;
+  mutable Hardware::TPCMap fTPCMap;
+  mutable Hardware::APAMap fAPAMap;
+
+  mutable std::once_flag fASICMapFilled;
+  mutable std::once_flag fBoardMapFilled;
+  mutable std::once_flag fTPCMapFilled;
+  mutable std::once_flag fAPAMapFilled;
 };
 
 //......................................................
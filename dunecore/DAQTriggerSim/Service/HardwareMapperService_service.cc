@@ -13,9 +13,15 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "larcorealg/Geometry/PlaneGeo.h"
+#include "tbb/parallel_for.h"
+
 #include <sstream>
 #include <set>
 #include <memory>
+#include <algorithm>
+#include <iterator>
 
 //......................................................
 HardwareMapperService::HardwareMapperService(fhicl::ParameterSet const& pset, art::ActivityRegistry& reg)
@@ -36,6 +42,7 @@ HardwareMapperService::HardwareMapperService(fhicl::ParameterSet const& pset, ar
   //    -- begin run) this function (HardwareMapperService::preBeginRun) will be called
 
   reg.sPreBeginRun.watch(this, &HardwareMapperService::checkGeomVsFileDetectorName);
+  //The maps themselves are filled on first access.
   fillHardwareMaps();
 }
 
@@ -69,7 +76,7 @@ void HardwareMapperService::checkGeomVsFileDetectorName(art::Run const& run){
 }
 
 //......................................................
-void HardwareMapperService::fillASICMap(){
+void HardwareMapperService::fillASICMap() const{
   const std::string func_name = "fillASICMap";
 
   mf::LogInfo loginfo(fServiceName);
@@ -81,7 +88,7 @@ void HardwareMapperService::fillASICMap(){
   if(fLogLevel>0) loginfo << "Looping over Boards" << "\n";
 
   Hardware::ID current_asic_id = 0;
-  for(auto id_board_pair: fBoardMap){
+  for(auto id_board_pair: getBoardMap()){
     std::shared_ptr<Hardware::Board> board_ptr = id_board_pair.second;
     
     if(fLogLevel>0) loginfo << *board_ptr << "\n";
@@ -138,17 +145,17 @@ void HardwareMapperService::fillASICMap(){
     current_asic_id++;//start each Board with a new ASIC 
     if(fLogLevel>0) loginfo << "Finished this Board\n"
                             << *board_ptr << "\n"
-                            << "Total ASICs in fASICMap: " << getNASICs() << "\n"
+                            << "Total ASICs in fASICMap: " << fASICMap.size() << "\n"
                             << "-----------------------\n\n";
   }//id_board_pair;
   loginfo << "Finished filling ASIC Map\n"
-          << "Filled: " << getNASICs() << " ASICs";
+          << "Filled: " << fASICMap.size() << " ASICs";
   
   
 }
 
 //......................................................
-void HardwareMapperService::fillBoardMap(){
+void HardwareMapperService::fillBoardMap() const{
  const std::string func_name = "fillBoardMap";
   if(fLogLevel>1||true) mf::LogInfo(fServiceName) << "In Function: " << func_name;//FIXME
 
@@ -159,7 +166,7 @@ void HardwareMapperService::fillBoardMap(){
   if(fLogLevel>0) loginfo << "Looping over apas" << "\n";
 
   // --- Lets loop over the APA map
-  for(auto id_apa_pair: fAPAMap){
+  for(auto id_apa_pair: getAPAMap()){
     // --- Get a handle to this APA object.
     std::shared_ptr<Hardware::APA> apa_ptr = id_apa_pair.second;
     // --- How many channels should there be per board? 
@@ -281,48 +288,92 @@ void HardwareMapperService::fillBoardMap(){
 		<< ", it has " << BoardsFromAPA[ cb ]->getNChannels() << " - " << fBoardMap[ ThisID ]->getNChannels()
 		<< std::endl;
     }
-    if(fLogLevel>0) loginfo << "Finished this APA\n" << *apa_ptr << "\n" << "Total Boards in fBoardMap: " << getNBoards() << "\n-----------------------\n\n";
+    if(fLogLevel>0) loginfo << "Finished this APA\n" << *apa_ptr << "\n" << "Total Boards in fBoardMap: " << fBoardMap.size() << "\n-----------------------\n\n";
     // --- Start each APA with a new board
     //current_board_id++;
   }//id_apa_pair;
   
-  loginfo<< "Finished filling Board Map\n Filled: " << getNBoards() << " Boards";
+  loginfo<< "Finished filling Board Map\n Filled: " << fBoardMap.size() << " Boards";
 }
 
 //......................................................
-void HardwareMapperService::fillTPCMap(){
+std::map<Hardware::ID, std::vector<raw::ChannelID_t>> HardwareMapperService::findTPCChannels() const{
+  //The channels for each TPC are found plane by plane rather than by calling
+  //ChannelToWire for every channel in the detector.
+  //A plane that is the only one in its readout plane (ROP), and whose wires and
+  //channels are one to one, contributes the whole channel block of the ROP.
+  //Otherwise the channels are found from the wires of the plane.
+  //The TPCs are independent and are processed in parallel.
+  std::vector<geo::TPCID> tpcids;
+  for(auto const& tpc : fGeometryService->Iterate<geo::TPCGeo>()) tpcids.push_back(tpc.ID());
+  std::vector<std::vector<raw::ChannelID_t>> channels_by_tpc(tpcids.size());
+  tbb::parallel_for(std::size_t(0), tpcids.size(), [&](std::size_t itpc){
+    std::vector<raw::ChannelID_t>& channels = channels_by_tpc[itpc];
+    for(auto const& plane : fWireReadoutGeom->Iterate<geo::PlaneGeo>(tpcids[itpc])){
+      geo::PlaneID const& planeid = plane.ID();
+      unsigned int const nwires = plane.Nwires();
+      if(nwires == 0) continue;
+      readout::ROPID const ropid = fWireReadoutGeom->WirePlaneToROP(planeid);
+      bool use_block = ropid.isValid &&
+                       fWireReadoutGeom->ROPtoWirePlanes(ropid).size() == 1 &&
+                       fWireReadoutGeom->Nchannels(ropid) == nwires;
+      raw::ChannelID_t first_channel = raw::InvalidChannelID;
+      if(use_block){
+        first_channel = fWireReadoutGeom->FirstChannelInROP(ropid);
+        raw::ChannelID_t const channel1 = fWireReadoutGeom->PlaneWireToChannel(geo::WireID(planeid, 0));
+        raw::ChannelID_t const channel2 = fWireReadoutGeom->PlaneWireToChannel(geo::WireID(planeid, nwires-1));
+        use_block = std::min(channel1, channel2) == first_channel &&
+                    std::max(channel1, channel2) == first_channel + nwires - 1;
+      }
+      if(use_block){
+        for(unsigned int ich=0; ich<nwires; ++ich) channels.push_back(first_channel + ich);
+      } else {
+        for(unsigned int iwire=0; iwire<nwires; ++iwire){
+          channels.push_back(fWireReadoutGeom->PlaneWireToChannel(geo::WireID(planeid, iwire)));
+        }
+      }
+    }
+    std::sort(channels.begin(), channels.end());
+    channels.erase(std::unique(channels.begin(), channels.end()), channels.end());
+  });
+  //jpd -- TPCs are identified by TPC number only
+  std::map<Hardware::ID, std::vector<raw::ChannelID_t>> result;
+  for(std::size_t itpc=0; itpc<tpcids.size(); ++itpc){
+    std::vector<raw::ChannelID_t>& channels = result[tpcids[itpc].TPC];
+    if(channels.empty()){
+      channels = std::move(channels_by_tpc[itpc]);
+    } else {
+      std::vector<raw::ChannelID_t> merged;
+      std::set_union(channels.begin(), channels.end(),
+                     channels_by_tpc[itpc].begin(), channels_by_tpc[itpc].end(),
+                     std::back_inserter(merged));
+      channels = std::move(merged);
+    }
+  }
+  return result;
+}
+
+//......................................................
+void HardwareMapperService::fillTPCMap() const{
   const std::string func_name = "fillTPCMap";
   mf::LogInfo loginfo(fServiceName);
   if(fLogLevel>1) loginfo << "In Function: " << func_name << "\n";
   unsigned int Nchannels   = fWireReadoutGeom->Nchannels();
   loginfo  << "Filling TPC Map with " << Nchannels << " channels" << "\n";
 
-  for(raw::ChannelID_t channel=0; channel<Nchannels ;channel++){
-    std::vector<geo::WireID> const Wires = fWireReadoutGeom->ChannelToWire(channel);
-    for(auto wire : Wires){
-      auto tpc_id = wire.TPC;
-      //jpd -- See if we have already created a TPC object for this tpc_id in our map
-      auto find_result = fTPCMap.find(tpc_id);
-      std::shared_ptr<Hardware::TPC> this_tpc;
-      if(find_result != fTPCMap.end()){
-        //jpd -- We already have one, add this channel
-        this_tpc = (*find_result).second;
-      }
-      else{
-        //jpd -- We don't have one. Create a new one and add this channel
-        this_tpc = std::shared_ptr<Hardware::TPC>(new Hardware::TPC(tpc_id));
-      }
-      this_tpc->addChannel(channel);
-      fTPCMap[tpc_id] = this_tpc;
-    }//loop over wires
-  }//loop over channels
+  for(auto const& [tpc_id, channels] : findTPCChannels()){
+    if(channels.empty()) continue;
+    auto this_tpc = std::make_shared<Hardware::TPC>(tpc_id);
+    this_tpc->addSortedChannels(channels);
+    fTPCMap[tpc_id] = this_tpc;
+  }
   loginfo  << "Finished filling TPC Map\n"
-           << "Filled: " << getNTPCs() << " TPCs";
+           << "Filled: " << fTPCMap.size() << " TPCs";
 
 }
 
 //......................................................
-void HardwareMapperService::fillAPAMap(){
+void HardwareMapperService::fillAPAMap() const{
   const std::string func_name = "fillAPAMap";
 
   mf::LogInfo loginfo(fServiceName);
@@ -331,29 +382,50 @@ void HardwareMapperService::fillAPAMap(){
   unsigned int Nchannels   = fWireReadoutGeom->Nchannels();
   loginfo  << "Filling APA Map with " << Nchannels << " channels" << "\n";
 
-  for(raw::ChannelID_t channel=0; channel<Nchannels ;channel++){
-    std::vector<geo::WireID> const Wires = fWireReadoutGeom->ChannelToWire(channel);
-    for(auto wire : Wires){
-      auto apa_id = wire.TPC / 2;
-      //jpd -- See if we have already created a APA object for this apa_id in our map
-      auto find_result = fAPAMap.find(apa_id);
-      std::shared_ptr<Hardware::APA> this_apa;
-      if(find_result != fAPAMap.end()){
-        //jpd -- We already have one, add this channel
-        this_apa = (*find_result).second;
-      }
-      else{
-        //jpd -- We don't have one. Create a new one and add this channel
-        this_apa = std::shared_ptr<Hardware::APA>(new Hardware::APA(apa_id));
-      }
-      this_apa->addChannel(channel);
-      fAPAMap[apa_id] = this_apa;
-    }//loop over wires
-  }//loop over channels
+  //jpd -- Each APA holds the channels of two TPCs
+  std::map<Hardware::ID, std::vector<raw::ChannelID_t>> apa_channels;
+  for(auto const& [tpc_id, tpc_ptr] : getTPCMap()){
+    std::vector<raw::ChannelID_t>& channels = apa_channels[tpc_id / 2];
+    std::vector<raw::ChannelID_t> const& tpc_channels = tpc_ptr->getChannelsSorted();
+    std::vector<raw::ChannelID_t> merged;
+    merged.reserve(channels.size() + tpc_channels.size());
+    std::set_union(channels.begin(), channels.end(),
+                   tpc_channels.begin(), tpc_channels.end(),
+                   std::back_inserter(merged));
+    channels = std::move(merged);
+  }
+  for(auto const& [apa_id, channels] : apa_channels){
+    auto this_apa = std::make_shared<Hardware::APA>(apa_id);
+    this_apa->addSortedChannels(channels);
+    fAPAMap[apa_id] = this_apa;
+  }
   loginfo  << "Finished filling APA Map\n"
-           << "Filled: " << getNAPAs() << " APAs";
+           << "Filled: " << fAPAMap.size() << " APAs";
+}
+
+//......................................................
+Hardware::ASICMap const& HardwareMapperService::getASICMap() const{
+  std::call_once(fASICMapFilled, [this]{ fillASICMap(); });
+  return fASICMap;
 }
 
+//......................................................
+Hardware::BoardMap const& HardwareMapperService::getBoardMap() const{
+  std::call_once(fBoardMapFilled, [this]{ fillBoardMap(); });
+  return fBoardMap;
+}
+
+//......................................................
+Hardware::TPCMap const& HardwareMapperService::getTPCMap() const{
+  std::call_once(fTPCMapFilled, [this]{ fillTPCMap(); });
+  return fTPCMap;
+}
+
+//......................................................
+Hardware::APAMap const& HardwareMapperService::getAPAMap() const{
+  std::call_once(fAPAMapFilled, [this]{ fillAPAMap(); });
+  return fAPAMap;
+}
 
 //......................................................
 void HardwareMapperService::fillHardwareMaps(){
@@ -365,7 +437,7 @@ void HardwareMapperService::fillHardwareMaps(){
     mf::LogInfo loginfo(fServiceName);
     
     loginfo << "HardwareMapperService\n";
-    loginfo << "Filling Hardware Maps using geometry service\n";
+    loginfo << "Hardware Maps will be filled on first use from geometry service\n";
     loginfo << "DetectorName: " << fGeometryService->DetectorName() << "\n";
     loginfo << "Ncryostats:   " << fGeometryService->Ncryostats()   << "\n";
     loginfo << "TotalNTPC:    " << fGeometryService->TotalNTPC()    << "\n";
@@ -373,17 +445,6 @@ void HardwareMapperService::fillHardwareMaps(){
     loginfo << "NOpChannels:  " << fWireReadoutGeom->NOpChannels()  << "\n";
   }//using annonymous namespace to force mf::LogInfo destructor call to flush output
 
-  fillTPCMap();
-  fillAPAMap();
-  fillBoardMap();
-  fillASICMap();
-  
-  mf::LogInfo loginfo(fServiceName);
-  loginfo << "Number of TPCs:   " << getNTPCs() << "\n"
-          << "Number of APAs:   " << getNAPAs() << "\n"
-          << "Number of Boards: " << getNBoards() << "\n"
-          << "Number of ASICs:  " << getNASICs() << "\n";
-
 }
 
 //......................................................
@@ -394,7 +455,7 @@ void HardwareMapperService::printASICMap(unsigned int num_asics_to_print){
   loginfo << "Printing the first: " << num_asics_to_print << " ASICs\n";
   unsigned int total_channels = 0;
   unsigned int count = 0;
-  for(auto this_pair : fASICMap ){
+  for(auto this_pair : getASICMap() ){
     if(count++ >= num_asics_to_print) break;
     std::shared_ptr<Hardware::ASIC> this_asic = this_pair.second;
     total_channels += this_asic->getNChannels();
@@ -413,7 +474,7 @@ void HardwareMapperService::printBoardMap(unsigned int num_boards_to_print){
   loginfo << "Printing the first: " << num_boards_to_print << " Boards\n";
   unsigned int total_channels = 0;
   unsigned int count = 0;
-  for(auto this_pair : fBoardMap ){
+  for(auto this_pair : getBoardMap() ){
     if(count++ >= num_boards_to_print) break;
     std::shared_ptr<Hardware::Board> this_board = this_pair.second;
     total_channels += this_board->getNChannels();
@@ -432,7 +493,7 @@ void HardwareMapperService::printTPCMap(unsigned int num_tpcs_to_print){
   loginfo << "Printing the first: " << num_tpcs_to_print << " TPCs\n";
   unsigned int total_channels = 0;
   unsigned int count = 0;
-  for(auto this_pair : fTPCMap ){
+  for(auto this_pair : getTPCMap() ){
     if(count++ >= num_tpcs_to_print) break;
     std::shared_ptr<Hardware::TPC> this_tpc = this_pair.second;
     total_channels += this_tpc->getNChannels();
@@ -452,7 +513,7 @@ void HardwareMapperService::printAPAMap(unsigned int num_apas_to_print){
   loginfo << "Printing the first: " << num_apas_to_print << " APAs\n";
   unsigned int total_channels = 0;
   unsigned int count = 0;
-  for(auto this_pair : fAPAMap ){
+  for(auto this_pair : getAPAMap() ){
     if(count++ >= num_apas_to_print) break;
     std::shared_ptr<Hardware::APA> this_apa = this_pair.second;
     total_channels += this_apa->getNChannels();
@@ -520,10 +581,10 @@ std::vector<raw::ChannelID_t> const& HardwareMapperService::getTPCChannels(Hardw
   if(fLogLevel>1) loginfo << "In Function: " << func_name << "\n";
   if(fLogLevel>1) loginfo << "Finding channels for TPC: " << tpc_id << "\n";
 
-  auto find_result = fTPCMap.find(tpc_id);
+  auto find_result = getTPCMap().find(tpc_id);
   std::shared_ptr<Hardware::TPC> this_tpc;
   
-  if(find_result == fTPCMap.end()){
+  if(find_result == getTPCMap().end()){
     mf::LogError(fServiceName) << "Failed to find this TPC: " << tpc_id << "\n";
     mf::LogError(fServiceName) << "Returning an empty vector of channels\n";
     static std::vector<raw::ChannelID_t> emptyVector;
@@ -542,10 +603,10 @@ std::vector<raw::ChannelID_t> const& HardwareMapperService::getAPAChannels(Hardw
   mf::LogInfo loginfo(fServiceName);
   if(fLogLevel>1) loginfo << "Finding channels for APA: " << apa_id << "\n";
 
-  auto find_result = fAPAMap.find(apa_id);
+  auto find_result = getAPAMap().find(apa_id);
   std::shared_ptr<Hardware::APA> this_apa;
   
-  if(find_result == fAPAMap.end()){
+  if(find_result == getAPAMap().end()){
     mf::LogError(fServiceName) << "Failed to find this APA: " << apa_id << "\n";
     mf::LogError(fServiceName) << "Returning an empty vector of channels\n";
     static std::vector<raw::ChannelID_t> emptyVector;
@@ -558,47 +619,47 @@ std::vector<raw::ChannelID_t> const& HardwareMapperService::getAPAChannels(Hardw
 }
 
 //......................................................
-std::set<raw::ChannelID_t> const& HardwareMapperService::getTPCChannelsSet(Hardware::ID tpc_id){
+std::set<raw::ChannelID_t> HardwareMapperService::getTPCChannelsSet(Hardware::ID tpc_id){
   const std::string func_name = "getTPCChannelsSet";
   if(fLogLevel>1) mf::LogInfo(fServiceName) << "In Function: " << func_name;
   mf::LogInfo loginfo(fServiceName);
   if(fLogLevel>1) loginfo << "Finding channels for TPC: " << tpc_id << "\n";
 
-  auto find_result = fTPCMap.find(tpc_id);
+  auto find_result = getTPCMap().find(tpc_id);
   std::shared_ptr<Hardware::TPC> this_tpc;
   
-  if(find_result == fTPCMap.end()){
+  if(find_result == getTPCMap().end()){
     mf::LogError(fServiceName) << "Failed to find this TPC: " << tpc_id << "\n";
     mf::LogError(fServiceName) << "Returning an empty set of channels\n";
-    static std::set<raw::ChannelID_t> emptySet;
-    return emptySet;
+    return std::set<raw::ChannelID_t>();
   }
   this_tpc = (*find_result).second;
   if(fLogLevel>1) loginfo << "Found " << *this_tpc << "\n";
   if(fLogLevel>1) loginfo << "\n";
-  return this_tpc->getChannelsSet();  
+  std::vector<raw::ChannelID_t> const& channels = this_tpc->getChannelsSorted();
+  return std::set<raw::ChannelID_t>(channels.begin(), channels.end());
 }
 
 //......................................................
-std::set<raw::ChannelID_t> const& HardwareMapperService::getAPAChannelsSet(Hardware::ID apa_id){
+std::set<raw::ChannelID_t> HardwareMapperService::getAPAChannelsSet(Hardware::ID apa_id){
   const std::string func_name = "getAPAChannelsSet";
   if(fLogLevel>1) mf::LogInfo(fServiceName) << "In Function: " << func_name;
   mf::LogInfo loginfo(fServiceName);
   if(fLogLevel>1) loginfo << "Finding channels for APA: " << apa_id << "\n";
 
-  auto find_result = fAPAMap.find(apa_id);
+  auto find_result = getAPAMap().find(apa_id);
   std::shared_ptr<Hardware::APA> this_apa;
   
-  if(find_result == fAPAMap.end()){
+  if(find_result == getAPAMap().end()){
     mf::LogError(fServiceName) << "Failed to find this APA: " << apa_id << "\n";
     mf::LogError(fServiceName) << "Returning an empty set of channels\n";
-    static std::set<raw::ChannelID_t> emptySet;
-    return emptySet;
+    return std::set<raw::ChannelID_t>();
   }
   this_apa = (*find_result).second;
   if(fLogLevel>1) loginfo << "Found " << *this_apa << "\n";
   if(fLogLevel>1) loginfo << "\n";
-  return this_apa->getChannelsSet();  
+  std::vector<raw::ChannelID_t> const& channels = this_apa->getChannelsSorted();
+  return std::set<raw::ChannelID_t>(channels.begin(), channels.end());
 }
 
 //......................................................
@@ -12,7 +12,7 @@
 #include <memory>
 #include <map>
 #include <vector>
-#include <set>
+#include <algorithm>
 #include <iostream>
 #include <iosfwd> // std::ostream
 #endif //__GCCXML__
@@ -72,36 +72,58 @@ namespace Hardware{
   {
   public:
     Element(ID id, std::string this_type) : HardwareID(id, this_type) {}
+    //jpd -- Channels in the order they were added
     std::vector<raw::ChannelID_t> const& getChannels() const{ return fChannelIDs;}
-    std::set<raw::ChannelID_t> const& getChannelsSet() const{ return fChannelIDsSet;}
+    //Channels in increasing order
+    std::vector<raw::ChannelID_t> const& getChannelsSorted() const{ return fSortedChannelIDs;}
+    //Kept for users of the old std::set accessor: the sorted, duplicate-free channels
+    std::vector<raw::ChannelID_t> const& getChannelsSet() const{ return fSortedChannelIDs;}
     size_t getNChannels() const{ return fChannelIDs.size();}
-    size_t getNChannelsSet() const{ return fChannelIDsSet.size();}
+    size_t getNChannelsSet() const{ return fSortedChannelIDs.size();}
+    bool hasChannel(raw::ChannelID_t channel) const{
+      return std::binary_search(fSortedChannelIDs.begin(), fSortedChannelIDs.end(), channel);
+    }
 
     std::vector<HardwareID> const& getHardwareIDs() const{ return fHardwareIDs;}
-    std::set<HardwareID> const& getHardwareIDsSet() const{ return fHardwareIDsSet;}
+    std::vector<HardwareID> const& getHardwareIDsSorted() const{ return fSortedHardwareIDs;}
+    std::vector<HardwareID> const& getHardwareIDsSet() const{ return fSortedHardwareIDs;}
     size_t getNHardwareIDs() const{ return fHardwareIDs.size();}
-    size_t getNHardwareIDsSet() const{ return fHardwareIDsSet.size();}
+    size_t getNHardwareIDsSet() const{ return fSortedHardwareIDs.size();}
 
     void addChannel(raw::ChannelID_t channel){ 
       //jpd -- Only add channel to the vector if it is not already in the set
-      //addChannelToSet returns true if channel was no already in the set and false otherwise
-      if(addChannelToSet(channel)) fChannelIDs.push_back(channel);
+      //addSorted returns true if channel was not already in the sorted vector
+      if(addSorted(fSortedChannelIDs, channel)){
+        fChannelIDs.push_back(channel);
+      }
+    }
+
+    //Add a block of channels that is already sorted and free of duplicates.
+    //This is much faster than adding them one at a time when the element is empty.
+    void addSortedChannels(std::vector<raw::ChannelID_t> const& channels){
+      if(fChannelIDs.empty()){
+        fChannelIDs = channels;
+        fSortedChannelIDs = channels;
+      } else {
+        for(auto channel : channels) addChannel(channel);
+      }
     }
 
     void addHardwareID(HardwareID id){
       //jpd -- Only add hardwareID to the vector if it is not already in the set
-      //addHardwareIDToSet returns true if hardwareID was no already in the set and false otherwise
-      if(addHardwareIDToSet(id)) fHardwareIDs.push_back(id);
+      //addSorted returns true if hardwareID was not already in the sorted vector
+      if(addSorted(fSortedHardwareIDs, id)){
+        fHardwareIDs.push_back(id);
+      }
     }
 
     friend std::ostream & operator << (std::ostream &os,  Element const &rhs){
       HardwareID const& base = rhs;
       os << base << " has "<< rhs.getNChannels() << " channels";
 
-      std::set<raw::ChannelID_t> channels = rhs.getChannelsSet();
       unsigned int max_num_channels = 16;
       unsigned int this_channel_num = 0;
-      for(auto channel : channels){
+      for(auto channel : rhs.getChannelsSorted()){
         if(this_channel_num==0)  os << ":";
         if(this_channel_num++ >= max_num_channels) { 
           os << " ...";
@@ -112,7 +134,7 @@ namespace Hardware{
 
       os << "\n";
       os << "Contains: " << rhs.getNHardwareIDs() << " pieces of hardware\n";
-      for(auto hardwareid : rhs.getHardwareIDsSet()){
+      for(auto hardwareid : rhs.getHardwareIDsSorted()){
         os << hardwareid << "\n";
       }
 
@@ -121,25 +143,22 @@ namespace Hardware{
 
   private:
     std::vector<raw::ChannelID_t> fChannelIDs;
-    std::set<raw::ChannelID_t> fChannelIDsSet;
-    std::set<HardwareID> fHardwareIDsSet;
+    std::vector<raw::ChannelID_t> fSortedChannelIDs;
+    std::vector<HardwareID> fSortedHardwareIDs;
     std::vector<HardwareID> fHardwareIDs;
 
-
-    //jpd -- Returns true if channel was not already in set and was inserted
-    //        false if channel was already in set / there was a problem
-    bool addChannelToSet(raw::ChannelID_t this_channel){
-      auto result = fChannelIDsSet.insert(this_channel);
-      if(result.first != fChannelIDsSet.end()) return result.second;
-      else return false;
-    }
-
-    //jpd -- Returns true if channel was not already in set and was inserted
-    //        false if channel was already in set / there was a problem
-    bool addHardwareIDToSet(HardwareID this_hardwareid){
-      auto result = fHardwareIDsSet.insert(this_hardwareid);
-      if(result.first != fHardwareIDsSet.end()) return result.second;
-      else return false;
+    //Returns true if val was not already in the sorted vector and was inserted.
+    //Values are usually added in increasing order so we first check the end.
+    template<class T>
+    static bool addSorted(std::vector<T>& vals, T const& val){
+      if(vals.empty() || vals.back() < val){
+        vals.push_back(val);
+        return true;
+      }
+      auto it = std::lower_bound(vals.begin(), vals.end(), val);
+      if(!(val < *it)) return false;
+      vals.insert(it, val);
+      return true;
     }
   };
 
@@ -0,0 +1,73 @@
+// CoherentNoiseRemovalService.h
+//
+// Implementation of AdcNoiseRemovalService that removes coherent noise from
+// the channel groups defined by ChannelGroupService.
+//
+// For each group, the samples of the channels present in the data map are
+// copied into a channel x tick Real2dData<float> block and the per-tick
+// correction is evaluated and subtracted with CoherentNoiseRemover. Ticks
+// flagged in AdcChannelData::signal may be excluded from the evaluation.
+// Channels whose sample count differs from that of the first channel in the
+// group are not corrected.
+//
+// Parameters:
+//   LogLevel - 0: silent, 1: init only, 2: warnings, 3: each group
+//   Method - "median" or "mean"
+//   MinChannelCount - minimum # unmasked channels to correct a tick
+//   BlockSize - # ticks in each processing block
+//   Parallel - if true, tick blocks are processed concurrently
+//   MaskSignal - if true, ticks flagged as signal are excluded
+//   Groups - names of the groups to process; empty for all
+
+#ifndef CoherentNoiseRemovalService_H
+#define CoherentNoiseRemovalService_H
+
+#include "dunecore/DuneInterface/Service/AdcNoiseRemovalService.h"
+#include "dunecore/DuneCommon/Utility/CoherentNoiseRemover.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include <memory>
+#include <vector>
+#include <string>
+
+class CoherentNoiseRemovalService : public AdcNoiseRemovalService {
+
+public:
+
+  using Index = unsigned int;
+  using Name = std::string;
+  using NameVector = std::vector<Name>;
+
+  // Ctor.
+  CoherentNoiseRemovalService(fhicl::ParameterSet const& pset);
+
+  // Ctor.
+  CoherentNoiseRemovalService(fhicl::ParameterSet const& pset, art::ActivityRegistry&);
+
+  // Dtor.
+  ~CoherentNoiseRemovalService() =default;
+
+  // Remove the coherent noise for the channels in each group.
+  int update(AdcChannelDataMap& datamap) const;
+
+  // Print parameters.
+  std::ostream& print(std::ostream& out =std::cout, std::string prefix ="") const;
+
+private:
+
+  // Parameters.
+  int m_LogLevel;
+  Name m_Method;
+  Index m_MinChannelCount;
+  Index m_BlockSize;
+  bool m_Parallel;
+  bool m_MaskSignal;
+  NameVector m_Groups;
+
+  // Engine.
+  std::unique_ptr<CoherentNoiseRemover> m_pcnr;
+
+};
+
+DECLARE_ART_SERVICE_INTERFACE_IMPL(CoherentNoiseRemovalService, AdcNoiseRemovalService, LEGACY)
+
+#endif
@@ -0,0 +1,137 @@
+// CoherentNoiseRemovalService_service.cc
+
+#include "dunecore/DuneCommon/Service/CoherentNoiseRemovalService.h"
+#include "dunecore/DuneInterface/Service/ChannelGroupService.h"
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "fhiclcpp/ParameterSet.h"
+#include <algorithm>
+
+using std::cout;
+using std::ostream;
+using std::endl;
+using std::string;
+using std::vector;
+
+using Index = CoherentNoiseRemovalService::Index;
+using Name = CoherentNoiseRemovalService::Name;
+using NameVector = CoherentNoiseRemovalService::NameVector;
+using Data = CoherentNoiseRemover::Data;
+using MaskVector = CoherentNoiseRemover::MaskVector;
+
+//**********************************************************************
+
+CoherentNoiseRemovalService::
+CoherentNoiseRemovalService(fhicl::ParameterSet const& pset)
+: m_LogLevel(pset.get<int>("LogLevel")) {
+  const string myname = "CoherentNoiseRemovalService::ctor: ";
+  m_Method = pset.get<Name>("Method");
+  m_MinChannelCount = pset.get<Index>("MinChannelCount");
+  m_BlockSize = pset.get<Index>("BlockSize");
+  m_Parallel = pset.get<bool>("Parallel");
+  m_MaskSignal = pset.get<bool>("MaskSignal");
+  m_Groups = pset.get<NameVector>("Groups");
+  CoherentNoiseRemover::Method meth = CoherentNoiseRemover::Median;
+  if ( m_Method == "mean" ) {
+    meth = CoherentNoiseRemover::Mean;
+  } else if ( m_Method != "median" ) {
+    cout << myname << "WARNING: Invalid method " << m_Method << ". Using median." << endl;
+    m_Method = "median";
+  }
+  m_pcnr.reset(new CoherentNoiseRemover(meth, m_MinChannelCount, m_BlockSize, m_Parallel));
+  if ( m_LogLevel >= 1 ) print(cout, myname);
+}
+
+//**********************************************************************
+
+CoherentNoiseRemovalService::
+CoherentNoiseRemovalService(fhicl::ParameterSet const& pset, art::ActivityRegistry&)
+: CoherentNoiseRemovalService(pset) { }
+
+//**********************************************************************
+
+int CoherentNoiseRemovalService::update(AdcChannelDataMap& datamap) const {
+  const string myname = "CoherentNoiseRemovalService::update: ";
+  if ( datamap.size() == 0 ) return 0;
+  art::ServiceHandle<ChannelGroupService> hcgs;
+  int nerr = 0;
+  for ( Index igrp=0; igrp<hcgs->size(); ++igrp ) {
+    Name gname = hcgs->name(igrp);
+    if ( m_Groups.size() &&
+         std::find(m_Groups.begin(), m_Groups.end(), gname) == m_Groups.end() ) continue;
+    // Find the channels to correct.
+    vector<AdcChannelData*> acds;
+    Index ntck = 0;
+    for ( ChannelGroupService::Index chan : hcgs->channels(igrp) ) {
+      auto iacd = datamap.find(chan);
+      if ( iacd == datamap.end() ) continue;
+      AdcChannelData& acd = iacd->second;
+      if ( acds.empty() ) ntck = acd.sampleCount();
+      if ( acd.sampleCount() != ntck ) {
+        if ( m_LogLevel >= 2 ) {
+          cout << myname << "WARNING: Skipping channel " << chan << " with sample count "
+               << acd.sampleCount() << " != " << ntck << endl;
+        }
+        continue;
+      }
+      acds.push_back(&acd);
+    }
+    Index ncha = acds.size();
+    if ( ncha == 0 || ntck == 0 ) continue;
+    // Fill the data and mask blocks.
+    Data dat({ncha, ntck});
+    MaskVector mask;
+    if ( m_MaskSignal ) mask.assign(std::size_t(ncha)*ntck, 0);
+    for ( Index icha=0; icha<ncha; ++icha ) {
+      const AdcChannelData& acd = *acds[icha];
+      std::copy(acd.sampleData(), acd.sampleData() + ntck, dat.row(icha));
+      if ( m_MaskSignal ) {
+        Index nsig = std::min<Index>(acd.signal.size(), ntck);
+        unsigned char* pmsk = &mask[std::size_t(icha)*ntck];
+        for ( Index itck=0; itck<nsig; ++itck ) pmsk[itck] = acd.signal[itck];
+      }
+    }
+    // Remove the noise and copy back.
+    int stat = m_pcnr->remove(dat, mask);
+    if ( stat ) {
+      cout << myname << "ERROR: Removal failed for group " << gname << " with status " << stat << endl;
+      ++nerr;
+      continue;
+    }
+    for ( Index icha=0; icha<ncha; ++icha ) {
+      const float* prow = dat.row(icha);
+      std::copy(prow, prow + ntck, acds[icha]->mutableSamples().begin());
+    }
+    if ( m_LogLevel >= 3 ) {
+      cout << myname << "Corrected " << ncha << " channels with " << ntck << " ticks in group "
+           << gname << endl;
+    }
+  }
+  return nerr;
+}
+
+//**********************************************************************
+
+ostream& CoherentNoiseRemovalService::print(ostream& out, string prefix) const {
+  out << prefix << "CoherentNoiseRemovalService:" << endl;
+  out << prefix << "         LogLevel: " << m_LogLevel << endl;
+  out << prefix << "           Method: " << m_Method << endl;
+  out << prefix << "  MinChannelCount: " << m_MinChannelCount << endl;
+  out << prefix << "        BlockSize: " << m_BlockSize << endl;
+  out << prefix << "         Parallel: " << m_Parallel << endl;
+  out << prefix << "       MaskSignal: " << m_MaskSignal << endl;
+  out << prefix << "           Groups: [";
+  bool first = true;
+  for ( Name gname : m_Groups ) {
+    if ( ! first ) out << ", ";
+    first = false;
+    out << gname;
+  }
+  out << "]" << endl;
+  return out;
+}
+
+//**********************************************************************
+
+DEFINE_ART_SERVICE_INTERFACE_IMPL(CoherentNoiseRemovalService, AdcNoiseRemovalService)
+
+//**********************************************************************
@@ -0,0 +1,116 @@
+// FftwPlanService.h
+//
+// Service that creates FFTW plans at the start of the job.
+//
+// The FFT wrappers (FwFFT, Fw2dFFT, FwBatchFFT, DuneFFT) take their plans from
+// FftwPlanCache and create them on first use, i.e. in the first event with a
+// given data size. With FFTW_MEASURE or FFTW_PATIENT this can take seconds. This
+// service creates the plans for the expected sizes at beginJob so the first
+// events do not pay that cost. The plans are only used if they have the same
+// planner flag, i.e. Optimization must match that of the consumers.
+//
+// FFTW wisdom may be read from a file before the plans are created and written
+// at the end of the job so later jobs plan almost immediately.
+//
+// At endJob, the plan statistics are reported including the number of plans
+// created after beginJob, i.e. those for sizes that were not anticipated.
+//
+// Configuration:
+//   LogLevel - 0=quiet, 1=init and end summary, 2=each plan
+//   Optimization - FFTW planner flag: 0-2 (FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT)
+//   Precisions - List of precisions to plan: "double" and/or "float"
+//   Sizes - List of 1D transform lengths
+//   BatchCounts - List of transform counts for the 1D plans, e.g. [1] for FwFFT
+//                 and DuneFFT, the channel batch size for FwBatchFFT
+//   Sizes2d - List of 2D array dimensions [n0, n1]
+//   InPlace2d - If true, 2D plans are in-place (Tpc2dRoiBuffer) else out-of-place
+//   Threads2d - # threads for 2D plans as in Fw2dFFT(ndat, opt, nthread)
+//   UseReadoutWindow - If true, the readout window size and number of time
+//                      samples from DetectorPropertiesService are added to Sizes
+//   PadSizes - If true, each 1D length is also planned at the smallest length
+//              not less than it with no prime factors other than 2, 3, 5 and 7.
+//              Consumers that can pad data should use fftSize(nsam).
+//   WisdomFile - If not blank, FFTW wisdom is imported from this file (if it
+//                exists) at beginJob and exported to it at endJob. Single
+//                precision wisdom uses the name with suffix "_float".
+
+#ifndef FftwPlanService_H
+#define FftwPlanService_H
+
+#include "art/Framework/Services/Registry/ServiceDeclarationMacros.h"
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include <string>
+#include <vector>
+#include <array>
+#include <iostream>
+
+class FftwPlanService {
+
+public:
+
+  using Index = unsigned int;
+  using IndexVector = std::vector<Index>;
+  using IndexArray = std::array<Index, 2>;
+  using IndexArrayVector = std::vector<IndexArray>;
+  using Name = std::string;
+  using NameVector = std::vector<Name>;
+
+  // Ctor.
+  FftwPlanService(const fhicl::ParameterSet& ps, art::ActivityRegistry& reg);
+
+  // Return the transform length to use for nsam samples.
+  Index fftSize(Index nsam) const;
+
+  // Create the configured plans. Called at beginJob.
+  // Returns the number of plans created.
+  Index createPlans();
+
+  // Return the 1D lengths and 2D dimensions that are planned.
+  const IndexVector& sizes() const { return m_sizes; }
+  const IndexArrayVector& sizes2d() const { return m_Sizes2d; }
+
+  // Import or export wisdom for all configured precisions.
+  // Returns the number of failures.
+  Index importWisdom() const;
+  Index exportWisdom() const;
+
+  // Print the configuration.
+  std::ostream& print(std::ostream& out =std::cout, std::string prefix ="") const;
+
+private:
+
+  // Return the wisdom file name for a precision.
+  Name wisdomFile(const Name& prec) const;
+
+  // Plan creation statistics summed over precisions.
+  void planStats(Index& count, double& time, double& maxTime) const;
+
+  // Callbacks.
+  void postBeginJob();
+  void postEndJob();
+
+  // Configuration data.
+  Index m_LogLevel;
+  Index m_Optimization;
+  NameVector m_Precisions;
+  IndexVector m_Sizes;
+  IndexVector m_BatchCounts;
+  IndexArrayVector m_Sizes2d;
+  bool m_InPlace2d;
+  Index m_Threads2d;
+  bool m_UseReadoutWindow;
+  bool m_PadSizes;
+  Name m_WisdomFile;
+
+  // Derived data.
+  bool m_doDouble;
+  bool m_doFloat;
+  IndexVector m_sizes;
+  Index m_beginCount;
+  double m_beginTime;
+
+};
+
+DECLARE_ART_SERVICE(FftwPlanService, SHARED)
+
+#endif
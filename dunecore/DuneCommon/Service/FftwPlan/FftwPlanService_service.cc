@@ -0,0 +1,257 @@
+// FftwPlanService_service.cc
+
+#include "FftwPlanService.h"
+#include "dunecore/DuneCommon/Utility/FftwPlanCache.h"
+#include "dunecore/DuneCommon/Utility/Fw2dFFT.h"
+#include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "lardata/DetectorInfoServices/DetectorClocksService.h"
+#include "lardata/DetectorInfoServices/DetectorPropertiesService.h"
+#include <algorithm>
+#include <fstream>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::ostream;
+
+using Index = FftwPlanService::Index;
+using Name = FftwPlanService::Name;
+
+//**********************************************************************
+
+namespace {
+
+// Create the plans for one precision.
+template<typename F>
+Index createPrecisionPlans(const FftwPlanService::IndexVector& sizes,
+                           const FftwPlanService::IndexVector& batchCounts,
+                           const FftwPlanService::IndexArrayVector& sizes2d,
+                           bool inPlace2d, Index nthread2d, unsigned flag, Index logLevel) {
+  const string myname = "FftwPlanService::createPlans: ";
+  FftwPlanCache<F>& cache = FftwPlanCache<F>::instance();
+  Index nplan0 = cache.size();
+  for ( Index nsam : sizes ) {
+    for ( Index nbat : batchCounts ) {
+      if ( cache.forwardPlan(nsam, nbat, flag) == nullptr ||
+           cache.backwardPlan(nsam, nbat, flag) == nullptr ) {
+        cout << myname << "WARNING: Unable to create " << FftwTraits<F>::name() << " plans for length "
+             << nsam << " and count " << nbat << endl;
+      } else if ( logLevel >= 2 ) {
+        cout << myname << "Planned " << FftwTraits<F>::name() << " " << nbat << " x " << nsam << endl;
+      }
+    }
+  }
+  for ( const FftwPlanService::IndexArray& nsams : sizes2d ) {
+    Index nthr = nsams[0]*nsams[1] >= Fw2dFFT::threadMinSize() ? nthread2d : 1;
+    if ( cache.forward2dPlan(nsams, inPlace2d, flag, nthr) == nullptr ||
+         cache.backward2dPlan(nsams, inPlace2d, flag, nthr) == nullptr ) {
+      cout << myname << "WARNING: Unable to create " << FftwTraits<F>::name() << " 2D plans for "
+           << nsams[0] << " x " << nsams[1] << endl;
+    } else if ( logLevel >= 2 ) {
+      cout << myname << "Planned " << FftwTraits<F>::name() << " 2D " << nsams[0] << " x " << nsams[1]
+           << " with " << nthr << " thread" << (nthr == 1 ? "" : "s") << endl;
+    }
+  }
+  return cache.size() - nplan0;
+}
+
+}  // end unnamed namespace
+
+//**********************************************************************
+
+FftwPlanService::FftwPlanService(const fhicl::ParameterSet& ps, art::ActivityRegistry& reg)
+: m_LogLevel(ps.get<Index>("LogLevel")),
+  m_Optimization(ps.get<Index>("Optimization")),
+  m_Precisions(ps.get<NameVector>("Precisions")),
+  m_Sizes(ps.get<IndexVector>("Sizes")),
+  m_BatchCounts(ps.get<IndexVector>("BatchCounts")),
+  m_Sizes2d(ps.get<IndexArrayVector>("Sizes2d")),
+  m_InPlace2d(ps.get<bool>("InPlace2d")),
+  m_Threads2d(ps.get<Index>("Threads2d")),
+  m_UseReadoutWindow(ps.get<bool>("UseReadoutWindow")),
+  m_PadSizes(ps.get<bool>("PadSizes")),
+  m_WisdomFile(ps.get<Name>("WisdomFile")),
+  m_doDouble(false), m_doFloat(false),
+  m_beginCount(0), m_beginTime(0.0) {
+  const string myname = "FftwPlanService::ctor: ";
+  for ( const Name& prec : m_Precisions ) {
+    if ( prec == "double" ) m_doDouble = true;
+    else if ( prec == "float" ) m_doFloat = true;
+    else cout << myname << "WARNING: Ignoring invalid precision: " << prec << endl;
+  }
+  if ( m_Optimization > 2 ) {
+    cout << myname << "WARNING: Invalid optimization " << m_Optimization << " replaced with 2." << endl;
+    m_Optimization = 2;
+  }
+  if ( m_LogLevel >= 1 ) print(cout, myname);
+  reg.sPostBeginJob.watch(this, &FftwPlanService::postBeginJob);
+  reg.sPostEndJob.watch(this, &FftwPlanService::postEndJob);
+}
+
+//**********************************************************************
+
+Index FftwPlanService::fftSize(Index nsam) const {
+  return m_PadSizes ? FftwPlanCache<double>::goodSize(nsam) : nsam;
+}
+
+//**********************************************************************
+
+Index FftwPlanService::createPlans() {
+  IndexVector sizes = m_Sizes;
+  if ( m_UseReadoutWindow ) {
+    auto const clockData = art::ServiceHandle<detinfo::DetectorClocksService const>()->DataForJob();
+    auto const detProp = art::ServiceHandle<detinfo::DetectorPropertiesService const>()->DataForJob(clockData);
+    sizes.push_back(detProp.ReadOutWindowSize());
+    sizes.push_back(detProp.NumberTimeSamples());
+  }
+  m_sizes.clear();
+  for ( Index nsam : sizes ) {
+    if ( nsam == 0 ) continue;
+    m_sizes.push_back(nsam);
+    Index nfft = fftSize(nsam);
+    if ( nfft != nsam ) m_sizes.push_back(nfft);
+  }
+  std::sort(m_sizes.begin(), m_sizes.end());
+  m_sizes.erase(std::unique(m_sizes.begin(), m_sizes.end()), m_sizes.end());
+  unsigned flag = FftwPlanCache<double>::flag(m_Optimization);
+  Index nplan = 0;
+  if ( m_doDouble ) {
+    nplan += createPrecisionPlans<double>(m_sizes, m_BatchCounts, m_Sizes2d,
+                                          m_InPlace2d, m_Threads2d, flag, m_LogLevel);
+  }
+  if ( m_doFloat ) {
+    nplan += createPrecisionPlans<float>(m_sizes, m_BatchCounts, m_Sizes2d,
+                                         m_InPlace2d, m_Threads2d, flag, m_LogLevel);
+  }
+  return nplan;
+}
+
+//**********************************************************************
+
+Index FftwPlanService::importWisdom() const {
+  const string myname = "FftwPlanService::importWisdom: ";
+  Index nerr = 0;
+  if ( m_WisdomFile.empty() ) return nerr;
+  for ( Name prec : {"double", "float"} ) {
+    if ( prec == "double" && ! m_doDouble ) continue;
+    if ( prec == "float" && ! m_doFloat ) continue;
+    Name fnam = wisdomFile(prec);
+    if ( ! std::ifstream(fnam) ) {
+      if ( m_LogLevel >= 1 ) cout << myname << "Wisdom file not found: " << fnam << endl;
+      continue;
+    }
+    int stat = prec == "double" ? FftwPlanCache<double>::instance().importWisdom(fnam)
+                                : FftwPlanCache<float>::instance().importWisdom(fnam);
+    if ( stat ) {
+      cout << myname << "WARNING: Unable to import wisdom from " << fnam << endl;
+      ++nerr;
+    } else if ( m_LogLevel >= 1 ) {
+      cout << myname << "Imported " << prec << " wisdom from " << fnam << endl;
+    }
+  }
+  return nerr;
+}
+
+//**********************************************************************
+
+Index FftwPlanService::exportWisdom() const {
+  const string myname = "FftwPlanService::exportWisdom: ";
+  Index nerr = 0;
+  if ( m_WisdomFile.empty() ) return nerr;
+  for ( Name prec : {"double", "float"} ) {
+    if ( prec == "double" && ! m_doDouble ) continue;
+    if ( prec == "float" && ! m_doFloat ) continue;
+    Name fnam = wisdomFile(prec);
+    int stat = prec == "double" ? FftwPlanCache<double>::instance().exportWisdom(fnam)
+                                : FftwPlanCache<float>::instance().exportWisdom(fnam);
+    if ( stat ) {
+      cout << myname << "WARNING: Unable to export wisdom to " << fnam << endl;
+      ++nerr;
+    } else if ( m_LogLevel >= 1 ) {
+      cout << myname << "Exported " << prec << " wisdom to " << fnam << endl;
+    }
+  }
+  return nerr;
+}
+
+//**********************************************************************
+
+ostream& FftwPlanService::print(ostream& out, string prefix) const {
+  out << prefix << "FftwPlanService:" << endl;
+  out << prefix << "          LogLevel: " << m_LogLevel << endl;
+  out << prefix << "      Optimization: " << m_Optimization << endl;
+  out << prefix << "        Precisions: [";
+  for ( Index iprc=0; iprc<m_Precisions.size(); ++iprc ) out << (iprc ? ", " : "") << m_Precisions[iprc];
+  out << "]" << endl;
+  out << prefix << "             Sizes: [";
+  for ( Index isiz=0; isiz<m_Sizes.size(); ++isiz ) out << (isiz ? ", " : "") << m_Sizes[isiz];
+  out << "]" << endl;
+  out << prefix << "       BatchCounts: [";
+  for ( Index ibat=0; ibat<m_BatchCounts.size(); ++ibat ) out << (ibat ? ", " : "") << m_BatchCounts[ibat];
+  out << "]" << endl;
+  out << prefix << "           Sizes2d: [";
+  for ( Index isiz=0; isiz<m_Sizes2d.size(); ++isiz ) {
+    out << (isiz ? ", " : "") << "[" << m_Sizes2d[isiz][0] << ", " << m_Sizes2d[isiz][1] << "]";
+  }
+  out << "]" << endl;
+  out << prefix << "         InPlace2d: " << (m_InPlace2d ? "true" : "false") << endl;
+  out << prefix << "         Threads2d: " << m_Threads2d << endl;
+  out << prefix << "  UseReadoutWindow: " << (m_UseReadoutWindow ? "true" : "false") << endl;
+  out << prefix << "          PadSizes: " << (m_PadSizes ? "true" : "false") << endl;
+  out << prefix << "        WisdomFile: " << m_WisdomFile << endl;
+  return out;
+}
+
+//**********************************************************************
+
+Name FftwPlanService::wisdomFile(const Name& prec) const {
+  return prec == "float" ? m_WisdomFile + "_float" : m_WisdomFile;
+}
+
+//**********************************************************************
+
+void FftwPlanService::planStats(Index& count, double& time, double& maxTime) const {
+  FftwPlanCache<double>::PlanStats dstats = FftwPlanCache<double>::instance().planStats();
+  FftwPlanCache<float>::PlanStats fstats = FftwPlanCache<float>::instance().planStats();
+  count = dstats.count + fstats.count;
+  time = dstats.time + fstats.time;
+  maxTime = std::max(dstats.maxTime, fstats.maxTime);
+}
+
+//**********************************************************************
+
+void FftwPlanService::postBeginJob() {
+  const string myname = "FftwPlanService::postBeginJob: ";
+  importWisdom();
+  Index nplan = createPlans();
+  double maxTime = 0.0;
+  planStats(m_beginCount, m_beginTime, maxTime);
+  if ( m_LogLevel >= 1 ) {
+    cout << myname << "Created " << nplan << " plans for " << m_sizes.size() << " lengths and "
+         << m_Sizes2d.size() << " 2D sizes." << endl;
+    cout << myname << "Job plan count: " << m_beginCount << ", time: " << m_beginTime
+         << " sec, max time: " << maxTime << " sec" << endl;
+  }
+}
+
+//**********************************************************************
+
+void FftwPlanService::postEndJob() {
+  const string myname = "FftwPlanService::postEndJob: ";
+  if ( m_LogLevel >= 1 ) {
+    Index count = 0;
+    double time = 0.0;
+    double maxTime = 0.0;
+    planStats(count, time, maxTime);
+    cout << myname << "Plans created at beginJob: " << m_beginCount << " in " << m_beginTime << " sec" << endl;
+    cout << myname << "Plans created later: " << count - m_beginCount << " in "
+         << time - m_beginTime << " sec" << endl;
+    cout << myname << "Slowest plan: " << maxTime << " sec" << endl;
+  }
+  exportWisdom();
+}
+
+//**********************************************************************
+
+DEFINE_ART_SERVICE(FftwPlanService)
@@ -0,0 +1,103 @@
+// test_FftwPlanService.cxx
+//
+// Test FftwPlanService.
+
+#include "../FftwPlanService.h"
+#include "dunecore/DuneCommon/Utility/FftwPlanCache.h"
+#include "dunecore/ArtSupport/ArtServiceHelper.h"
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::ifstream;
+using art::ServiceHandle;
+using Index = FftwPlanService::Index;
+
+#undef NDEBUG
+#include <cassert>
+
+int test_FftwPlanService() {
+  const string myname = "test_FftwPlanService: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  const string line = "-----------------------------";
+  string wfnam = "test_FftwPlanService.wisdom";
+
+  cout << myname << line << endl;
+  cout << myname << "Loading services." << endl;
+  std::ostringstream oss;
+  oss << "services: {" << endl;
+  oss << "  FftwPlanService: {" << endl;
+  oss << "    service_provider: \"FftwPlanService\"" << endl;
+  oss << "    LogLevel: 2" << endl;
+  oss << "    Optimization: 0" << endl;
+  oss << "    Precisions: [\"double\", \"float\"]" << endl;
+  oss << "    Sizes: [4492, 100, 4500]" << endl;
+  oss << "    BatchCounts: [1, 4]" << endl;
+  oss << "    Sizes2d: [[4, 8]]" << endl;
+  oss << "    InPlace2d: true" << endl;
+  oss << "    Threads2d: 1" << endl;
+  oss << "    UseReadoutWindow: false" << endl;
+  oss << "    PadSizes: true" << endl;
+  oss << "    WisdomFile: \"" << wfnam << "\"" << endl;
+  oss << "  }" << endl;
+  oss << "}" << endl;
+  ArtServiceHelper::load_services(oss.str());
+
+  cout << myname << line << endl;
+  cout << myname << "Fetch service." << endl;
+  ServiceHandle<FftwPlanService> hfps;
+  FftwPlanService* pfps = hfps.get();
+  assert( pfps != nullptr );
+  assert( pfps->fftSize(4492) == 4500 );
+  assert( pfps->fftSize(4410) == 4410 );
+
+  cout << myname << line << endl;
+  cout << myname << "Create plans." << endl;
+  Index nplan0 = FftwPlanCache<double>::instance().size();
+  Index nplan0f = FftwPlanCache<float>::instance().size();
+  Index nplan = pfps->createPlans();
+  // Three sizes (raw 4492 and padded 4500) x two batch counts x (forward, backward)
+  // + two 2D plans.
+  assert( pfps->sizes().size() == 3 );
+  assert( pfps->sizes()[0] == 100 );
+  assert( pfps->sizes()[1] == 4492 );
+  assert( pfps->sizes()[2] == 4500 );
+  assert( FftwPlanCache<double>::instance().size() == nplan0 + 14 );
+  assert( FftwPlanCache<float>::instance().size() == nplan0f + 14 );
+  assert( nplan == 28 );
+  assert( pfps->createPlans() == 0 );
+  unsigned flag = FftwPlanCache<double>::flag(0);
+  Index nplan1 = FftwPlanCache<double>::instance().size();
+  FftwPlanCache<double>::instance().forwardPlan(4500, 1, flag);
+  FftwPlanCache<double>::instance().forwardPlan(4492, 1, flag);
+  FftwPlanCache<double>::instance().forward2dPlan({4, 8}, true, flag);
+  assert( FftwPlanCache<double>::instance().size() == nplan1 );
+
+  cout << myname << line << endl;
+  cout << myname << "Export and import wisdom." << endl;
+  assert( pfps->exportWisdom() == 0 );
+  assert( ifstream(wfnam) );
+  assert( ifstream(wfnam + "_float") );
+  assert( pfps->importWisdom() == 0 );
+  std::remove(wfnam.c_str());
+  std::remove((wfnam + "_float").c_str());
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  if ( argc > 1 ) {
+    cout << "Usage: " << argv[0] << endl;
+  }
+  return test_FftwPlanService();
+}
@@ -0,0 +1,136 @@
+// test_CoherentNoiseRemovalService.cxx
+//
+// Test CoherentNoiseRemovalService.
+
+#include "../CoherentNoiseRemovalService.h"
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include "dunecore/ArtSupport/ArtServiceHelper.h"
+
+using std::string;
+using std::cout;
+using std::endl;
+using art::ServiceHandle;
+
+#undef NDEBUG
+#include <cassert>
+
+using Index = unsigned int;
+
+//**********************************************************************
+
+// Coherent noise for group igrp and tick itck.
+float noise(Index igrp, Index itck) { return (igrp + 1)*2.0*sin(0.1*itck); }
+
+//**********************************************************************
+
+int test_CoherentNoiseRemovalService(string meth) {
+  const string myname = "test_CoherentNoiseRemovalService: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  const string line = "-----------------------------";
+
+  cout << myname << line << endl;
+  cout << myname << "Create fcl file." << endl;
+  std::ostringstream oss;
+  oss << "services.ChannelGroupService: {" << endl;
+  oss << "  service_provider: \"FixedChannelGroupService\"" << endl;
+  oss << "  group1: [1, 2, 3, 4, 5]" << endl;
+  oss << "  group2: [11, 12, 13, 14, 15]" << endl;
+  oss << "}" << endl;
+  oss << "services.AdcNoiseRemovalService: {" << endl;
+  oss << "  service_provider: \"CoherentNoiseRemovalService\"" << endl;
+  oss << "  LogLevel: 1" << endl;
+  oss << "  Method: \"" << meth << "\"" << endl;
+  oss << "  MinChannelCount: 2" << endl;
+  oss << "  BlockSize: 64" << endl;
+  oss << "  Parallel: true" << endl;
+  oss << "  MaskSignal: true" << endl;
+  oss << "  Groups: []" << endl;
+  oss << "}" << endl;
+  ArtServiceHelper::load_services(oss.str());
+
+  cout << myname << line << endl;
+  cout << myname << "Fetch AdcNoiseRemovalService." << endl;
+  ServiceHandle<AdcNoiseRemovalService> hnrs;
+  hnrs->print(cout, myname);
+
+  cout << myname << line << endl;
+  cout << myname << "Build data with a signal in channel 3." << endl;
+  Index ntck = 500;
+  AdcChannelDataMap acds;
+  for ( Index igrp=0; igrp<2; ++igrp ) {
+    for ( Index icha=1; icha<=5; ++icha ) {
+      Index chan = 10*igrp + icha;
+      AdcChannelData& acd = acds[chan];
+      acd.setChannelInfo(chan);
+      acd.samples.resize(ntck);
+      acd.signal.resize(ntck, false);
+      for ( Index itck=0; itck<ntck; ++itck ) acd.samples[itck] = noise(igrp, itck);
+    }
+  }
+  for ( Index itck=100; itck<120; ++itck ) {
+    acds[3].samples[itck] += 200.0;
+    acds[3].signal[itck] = true;
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Remove noise from referenced samples." << endl;
+  {
+    AdcChannelDataMap vacds;
+    for ( auto& iacd : acds ) {
+      vacds[iacd.first] = std::move(iacd.second.addSampleView("ref", 0, ntck));
+      assert( vacds[iacd.first].hasSampleRef() );
+    }
+    assert( hnrs->update(vacds) == 0 );
+    for ( const auto& iacd : vacds ) {
+      const AdcChannelData& vacd = iacd.second;
+      const AdcChannelData& acd = acds[iacd.first];
+      assert( ! vacd.hasSampleRef() );
+      assert( vacd.samples.size() == ntck );
+      Index igrp = iacd.first/10;
+      for ( Index itck=0; itck<ntck; ++itck ) {
+        float exp = iacd.first == 3 && itck >= 100 && itck < 120 ? 200.0 : 0.0;
+        assert( fabs(vacd.samples[itck] - exp) < 1.e-4 );
+        assert( acd.samples[itck] == noise(igrp, itck) + exp );
+      }
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Remove noise." << endl;
+  assert( hnrs->update(acds) == 0 );
+  for ( const auto& iacd : acds ) {
+    const AdcChannelData& acd = iacd.second;
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      float exp = acd.channel() == 3 && itck >= 100 && itck < 120 ? 200.0 : 0.0;
+      assert( fabs(acd.samples[itck] - exp) < 1.e-4 );
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main(int argc, char* argv[]) {
+  string meth = "median";
+  if ( argc > 1 ) {
+    string sarg(argv[1]);
+    if ( sarg == "-h" ) {
+      cout << "Usage: " << argv[0] << " [METH]" << endl;
+      cout << "  METH = median or mean" << endl;
+      return 0;
+    }
+    meth = sarg;
+  }
+  return test_CoherentNoiseRemovalService(meth);
+}
+
+//**********************************************************************
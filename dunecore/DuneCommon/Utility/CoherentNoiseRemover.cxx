@@ -0,0 +1,139 @@
+// CoherentNoiseRemover.cxx
+
+#include "CoherentNoiseRemover.h"
+#include "tbb/parallel_for.h"
+#include <algorithm>
+#include <iostream>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+using Index = CoherentNoiseRemover::Index;
+using Data = CoherentNoiseRemover::Data;
+using FloatVector = CoherentNoiseRemover::FloatVector;
+using MaskVector = CoherentNoiseRemover::MaskVector;
+
+//**********************************************************************
+
+CoherentNoiseRemover::
+CoherentNoiseRemover(Method meth, Index minCount, Index blockSize, bool parallel)
+: m_method(meth),
+  m_minCount(minCount ? minCount : 1),
+  m_blockSize(blockSize ? blockSize : 1),
+  m_parallel(parallel) { }
+
+//**********************************************************************
+
+int CoherentNoiseRemover::evaluate(const Data& dat, const MaskVector& mask, FloatVector& cors) const {
+  const string myname = "CoherentNoiseRemover::evaluate: ";
+  cors.clear();
+  if ( ! dat.isValid() ) return 1;
+  if ( mask.size() && mask.size() != dat.size() ) {
+    cout << myname << "ERROR: Mask size " << mask.size() << " != data size " << dat.size() << endl;
+    return 2;
+  }
+  if ( m_method != Mean && m_method != Median ) {
+    cout << myname << "ERROR: Invalid method " << m_method << endl;
+    return 3;
+  }
+  Index ntck = dat.nSamples()[1];
+  cors.assign(ntck, 0.0);
+  Index nblk = (ntck + m_blockSize - 1)/m_blockSize;
+  auto doBlock = [this, &dat, &mask, &cors, ntck](Index iblk) {
+    Index itck0 = iblk*m_blockSize;
+    Index itck1 = std::min(itck0 + m_blockSize, ntck);
+    if ( m_method == Mean ) evaluateMean(dat, mask, itck0, itck1, &cors[itck0]);
+    else evaluateMedian(dat, mask, itck0, itck1, &cors[itck0]);
+  };
+  if ( m_parallel && nblk > 1 ) {
+    tbb::parallel_for(Index(0), nblk, doBlock);
+  } else {
+    for ( Index iblk=0; iblk<nblk; ++iblk ) doBlock(iblk);
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+int CoherentNoiseRemover::remove(Data& dat, const MaskVector& mask, FloatVector* pcors) const {
+  FloatVector cors;
+  int stat = evaluate(dat, mask, cors);
+  if ( stat ) return stat;
+  Index ncha = dat.nSamples()[0];
+  Index ntck = dat.nSamples()[1];
+  const float* pcor = cors.data();
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    float* pdat = dat.row(icha);
+    for ( Index itck=0; itck<ntck; ++itck ) pdat[itck] -= pcor[itck];
+  }
+  if ( pcors != nullptr ) *pcors = std::move(cors);
+  return 0;
+}
+
+//**********************************************************************
+
+void CoherentNoiseRemover::
+evaluateMean(const Data& dat, const MaskVector& mask, Index itck0, Index itck1, float* pcor) const {
+  Index ncha = dat.nSamples()[0];
+  Index ntck = dat.nSamples()[1];
+  Index nblk = itck1 - itck0;
+  FloatVector sums(nblk, 0.0);
+  FloatVector counts(nblk, 0.0);
+  float* psum = sums.data();
+  float* pcnt = counts.data();
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    const float* pdat = dat.row(icha) + itck0;
+    if ( mask.empty() ) {
+      for ( Index ktck=0; ktck<nblk; ++ktck ) psum[ktck] += pdat[ktck];
+    } else {
+      const unsigned char* pmsk = mask.data() + std::size_t(icha)*ntck + itck0;
+      for ( Index ktck=0; ktck<nblk; ++ktck ) {
+        float keep = pmsk[ktck] == 0;
+        psum[ktck] += keep*pdat[ktck];
+        pcnt[ktck] += keep;
+      }
+    }
+  }
+  if ( mask.empty() ) std::fill(counts.begin(), counts.end(), float(ncha));
+  for ( Index ktck=0; ktck<nblk; ++ktck ) {
+    pcor[ktck] = pcnt[ktck] >= m_minCount ? psum[ktck]/pcnt[ktck] : 0.0;
+  }
+}
+
+//**********************************************************************
+
+void CoherentNoiseRemover::
+evaluateMedian(const Data& dat, const MaskVector& mask, Index itck0, Index itck1, float* pcor) const {
+  Index ncha = dat.nSamples()[0];
+  Index ntck = dat.nSamples()[1];
+  Index nblk = itck1 - itck0;
+  // Gather the values for each tick into a contiguous array of channels.
+  // Each value is written and the count is advanced only if it is kept.
+  FloatVector vals(std::size_t(nblk)*ncha);
+  std::vector<Index> counts(nblk, 0);
+  Index* pcnt = counts.data();
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    const float* pdat = dat.row(icha) + itck0;
+    const unsigned char* pmsk = mask.empty() ? nullptr : mask.data() + std::size_t(icha)*ntck + itck0;
+    for ( Index ktck=0; ktck<nblk; ++ktck ) {
+      vals[std::size_t(ktck)*ncha + pcnt[ktck]] = pdat[ktck];
+      pcnt[ktck] += pmsk == nullptr || pmsk[ktck] == 0;
+    }
+  }
+  for ( Index ktck=0; ktck<nblk; ++ktck ) {
+    Index nval = pcnt[ktck];
+    if ( nval < m_minCount ) {
+      pcor[ktck] = 0.0;
+      continue;
+    }
+    float* pval = &vals[std::size_t(ktck)*ncha];
+    Index imid = nval/2;
+    std::nth_element(pval, pval + imid, pval + nval);
+    float med = pval[imid];
+    if ( nval%2 == 0 ) med = 0.5*(med + *std::max_element(pval, pval + imid));
+    pcor[ktck] = med;
+  }
+}
+
+//**********************************************************************
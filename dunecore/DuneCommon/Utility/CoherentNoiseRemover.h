@@ -0,0 +1,75 @@
+// CoherentNoiseRemover.h
+//
+// Removal of coherent noise from a block of channels.
+//
+// The data are a Real2dData<float> array with one row per channel and one
+// column per tick. For each tick, the correction is the mean or median over
+// channels of the values not masked, e.g. by signal, and is subtracted from all
+// channels. Ticks with fewer than minCount unmasked channels are not corrected.
+//
+// The mask is a row-major array with the shape of the data. Nonzero entries
+// are excluded from the evaluation. An empty mask excludes nothing.
+//
+// The ticks are processed in blocks of blockSize. For the mean, the sums for
+// a block are accumulated row by row in unit-stride loops over ticks. For the
+// median, the unmasked values for the ticks of a block are gathered row by
+// row into a contiguous channel array for each tick with branch-free compaction
+// and the median is selected with nth_element. If parallel is true, the blocks
+// are processed concurrently with TBB.
+//
+// Usage:
+//   CoherentNoiseRemover cnr(CoherentNoiseRemover::Median, 5);
+//   cnr.remove(dat, mask);
+
+#ifndef CoherentNoiseRemover_H
+#define CoherentNoiseRemover_H
+
+#include "dunecore/DuneInterface/Data/Real2dData.h"
+#include <vector>
+
+class CoherentNoiseRemover {
+
+public:
+
+  using Index = unsigned int;
+  using Data = Real2dData<float>;
+  using FloatVector = std::vector<float>;
+  using MaskVector = std::vector<unsigned char>;
+
+  enum Method { Mean=1, Median=2 };
+
+  // Ctor.
+  //   meth - evaluation method
+  //   minCount - minimum number of unmasked channels to evaluate a tick
+  //   blockSize - # ticks in each processing block
+  //   parallel - if true, blocks are processed concurrently
+  CoherentNoiseRemover(Method meth, Index minCount =1, Index blockSize =256, bool parallel =true);
+
+  // Return the configuration.
+  Method method() const { return m_method; }
+  Index minCount() const { return m_minCount; }
+  Index blockSize() const { return m_blockSize; }
+  bool parallel() const { return m_parallel; }
+
+  // Evaluate the correction for each tick.
+  // Returns nonzero if the data are invalid or the mask has the wrong size.
+  int evaluate(const Data& dat, const MaskVector& mask, FloatVector& cors) const;
+
+  // Evaluate the correction and subtract it from the data.
+  // If pcors is not null, the corrections are returned there.
+  int remove(Data& dat, const MaskVector& mask, FloatVector* pcors =nullptr) const;
+
+private:
+
+  // Evaluate the correction for ticks [itck0, itck1).
+  void evaluateMean(const Data& dat, const MaskVector& mask, Index itck0, Index itck1, float* pcor) const;
+  void evaluateMedian(const Data& dat, const MaskVector& mask, Index itck0, Index itck1, float* pcor) const;
+
+  Method m_method;
+  Index m_minCount;
+  Index m_blockSize;
+  bool m_parallel;
+
+};
+
+#endif
@@ -0,0 +1,234 @@
+// ComplexRealDftData.h
+//
+// Concrete class that holds a 1D DFT of real data as complex values.
+//
+// For nsam samples, the nsam/2 + 1 compact terms are stored as interleaved
+// (real, imaginary) pairs in the layout of the FFTW r2c output. The values
+// include the global normalization but not the term normalization, which is
+// applied when terms are accessed through the RealDftData interface. Amplitudes
+// and phases are only calculated when requested so transforms and filters that
+// work with the complex values avoid the trig round trip of CompactRealDftData.
+//
+// The spectral operations multiply, multiplyConjugate and divide modify the
+// terms in place. Multiplying two DFTs gives the DFT of the circular convolution
+// of the corresponding real data in the normalization of this object, i.e. the
+// factor from the global normalization of the argument is removed.
+
+#ifndef ComplexRealDftData_H
+#define ComplexRealDftData_H
+
+#include "dunecore/DuneCommon/Utility/RealDftData.h"
+#include <complex>
+#include <vector>
+#include <cmath>
+
+//**********************************************************************
+
+template<typename F>
+class ComplexRealDftData : public RealDftData<F> {
+
+public:
+
+  using typename RealDftData<F>::Index;
+  using Complex = std::complex<F>;      // same memory layout as fftw_complex
+  using ComplexVector = std::vector<Complex>;
+  using FloatVector = std::vector<F>;
+  using Norm = RealDftNormalization;
+
+  // Return the number of compact terms for nsam samples.
+  static Index compactSize(Index nsam) { return nsam ? nsam/2 + 1 : 0; }
+
+  // Return the factor applied to standard-normalized terms for a global
+  // normalization and sample count.
+  static F globalFactor(const Norm& norm, Index nsam) {
+    if ( norm.isConsistent() ) return 1.0/sqrt(F(nsam));
+    if ( norm.isBin() ) return 1.0/F(nsam);
+    return 1.0;
+  }
+
+  // Default ctor.
+  ComplexRealDftData() =default;
+
+  // Ctor from normalization. Leaves object empty and so invalid.
+  explicit ComplexRealDftData(Norm norm)
+  : m_norm(norm) { }
+
+  // Ctor from normalization and sample count. The terms are zero.
+  ComplexRealDftData(Norm norm, Index nsam)
+  : m_norm(norm) {
+    reset(nsam);
+  }
+
+  // Ctor from normalization, sample count and compact terms.
+  // Must have cmps.size() = nsam/2 + 1. If not, the object is left empty.
+  ComplexRealDftData(Norm norm, Index nsam, const ComplexVector& cmps)
+  : m_norm(norm) {
+    copyIn(nsam, cmps);
+  }
+
+  // Copy ctor from any representation. Changes normalization if needed.
+  ComplexRealDftData(Norm norm, const RealDftData<F>& rhs)
+  : m_norm(norm) {
+    if ( ! rhs.isValid() ) return;
+    Index nsam = rhs.nSample();
+    reset(nsam);
+    const Norm& rnorm = rhs.normalization();
+    F gfac = globalFactor(m_norm, nsam)/globalFactor(rnorm, nsam);
+    const F osq2 = 1.0/sqrt(2.0);
+    for ( Index ifrq=0; ifrq<nCompact(); ++ifrq ) {
+      F fac = gfac;
+      if ( rnorm.isPower() && this->isAliased(ifrq) ) fac *= osq2;
+      m_cmps[ifrq] = fac*Complex(rhs.real(ifrq), rhs.imag(ifrq));
+    }
+  }
+
+  // Normalization.
+  const Norm& normalization() const override { return m_norm; }
+
+  // Clear data.
+  void clear() override {
+    m_nsam = 0;
+    m_cmps.clear();
+  }
+
+  // Reset to nsam samples with all terms zero.
+  void reset(Index nsam) override {
+    m_nsam = nsam;
+    m_cmps.assign(compactSize(nsam), Complex(0.0, 0.0));
+  }
+
+  // Move or copy data in. Returns nonzero and clears if the size is wrong.
+  int moveIn(Index nsam, ComplexVector& cmps) {
+    if ( cmps.size() != compactSize(nsam) ) {
+      clear();
+      return 1;
+    }
+    m_nsam = nsam;
+    m_cmps = std::move(cmps);
+    return 0;
+  }
+  int copyIn(Index nsam, const ComplexVector& cmps) {
+    ComplexVector tmp(cmps);
+    return moveIn(nsam, tmp);
+  }
+
+  // Move the data out. The object is left empty.
+  int moveOut(ComplexVector& cmps) {
+    cmps = std::move(m_cmps);
+    clear();
+    return 0;
+  }
+
+  // Convert to the compact amplitude-phase representation of CompactRealDftData.
+  int copyOut(FloatVector& amps, FloatVector& phas) const {
+    Index namp = nCompact();
+    Index npha = (m_nsam + 1)/2;
+    amps.resize(namp);
+    phas.resize(npha);
+    for ( Index ifrq=0; ifrq<npha; ++ifrq ) {
+      amps[ifrq] = compactAmplitude(ifrq);
+      phas[ifrq] = std::arg(m_cmps[ifrq]);
+    }
+    if ( namp > npha ) amps[npha] = m_cmps[npha].real();
+    return 0;
+  }
+
+  // Check and return dimension information.
+  Index nSample() const override { return m_nsam; }
+  Index nCompact() const override { return m_cmps.size(); }
+
+  // Compact complex terms with global normalization.
+  ComplexVector& complexData() { return m_cmps; }
+  const ComplexVector& complexData() const { return m_cmps; }
+  Complex* data() { return m_cmps.data(); }
+  const Complex* data() const { return m_cmps.data(); }
+  Complex compactValue(Index ifrq) const {
+    return ifrq < nCompact() ? m_cmps[ifrq] : Complex(this->badValue(), 0.0);
+  }
+
+  // Overide methods that return DFT terms for any representation.
+  // For even nsam, the Nyquist term is real and the amplitude carries its sign.
+  F amplitude(Index ifrq) const override {
+    return ifrq < nCompact() ? compactAmplitude(ifrq) :
+           ifrq < this->size() ? compactAmplitude(this->size() - ifrq) :
+           this->badValue();
+  }
+  F phase(Index ifrq) const override {
+    return 2*ifrq == this->size() ? 0.0 :
+           ifrq < nCompact() ? std::arg(m_cmps[ifrq]) :
+           ifrq < this->size() ? -std::arg(m_cmps[this->size() - ifrq]) :
+           this->badValue();
+  }
+  F real(Index ifrq) const override {
+    return ifrq < nCompact() ? termFactor(ifrq)*m_cmps[ifrq].real() :
+           ifrq < this->size() ? termFactor(ifrq)*m_cmps[this->size() - ifrq].real() :
+           this->badValue();
+  }
+  F imag(Index ifrq) const override {
+    return ifrq < nCompact() ? termFactor(ifrq)*m_cmps[ifrq].imag() :
+           ifrq < this->size() ? -termFactor(ifrq)*m_cmps[this->size() - ifrq].imag() :
+           this->badValue();
+  }
+
+  // Multiply each term by the corresponding term of rhs (or its conjugate).
+  // Returns nonzero if the sample counts differ.
+  int multiply(const ComplexRealDftData& rhs) {
+    if ( rhs.nSample() != nSample() ) return 1;
+    F fac = 1.0/globalFactor(rhs.normalization(), m_nsam);
+    const Complex* prhs = rhs.data();
+    for ( Index ifrq=0; ifrq<nCompact(); ++ifrq ) m_cmps[ifrq] *= fac*prhs[ifrq];
+    return 0;
+  }
+  int multiplyConjugate(const ComplexRealDftData& rhs) {
+    if ( rhs.nSample() != nSample() ) return 1;
+    F fac = 1.0/globalFactor(rhs.normalization(), m_nsam);
+    const Complex* prhs = rhs.data();
+    for ( Index ifrq=0; ifrq<nCompact(); ++ifrq ) m_cmps[ifrq] *= fac*std::conj(prhs[ifrq]);
+    return 0;
+  }
+
+  // Divide each term by the corresponding term of rhs.
+  // Terms where the rhs magnitude is not above minMag are set to zero.
+  int divide(const ComplexRealDftData& rhs, F minMag =0.0) {
+    if ( rhs.nSample() != nSample() ) return 1;
+    F fac = 1.0/globalFactor(rhs.normalization(), m_nsam);
+    F minNorm = minMag*minMag;
+    const Complex* prhs = rhs.data();
+    for ( Index ifrq=0; ifrq<nCompact(); ++ifrq ) {
+      Complex den = fac*prhs[ifrq];
+      m_cmps[ifrq] = std::norm(den) > minNorm ? m_cmps[ifrq]/den : Complex(0.0, 0.0);
+    }
+    return 0;
+  }
+
+  // Multiply each term by a real factor, e.g. a filter response.
+  // The vector must have nCompact entries.
+  int multiply(const FloatVector& facs) {
+    if ( facs.size() != nCompact() ) return 1;
+    for ( Index ifrq=0; ifrq<nCompact(); ++ifrq ) m_cmps[ifrq] *= facs[ifrq];
+    return 0;
+  }
+
+private:
+
+  // Factor for the term normalization.
+  F termFactor(Index ifrq) const {
+    return m_norm.isPower() && this->isAliased(ifrq) ? sqrt(F(2.0)) : F(1.0);
+  }
+
+  // Amplitude for a compact term.
+  F compactAmplitude(Index ifrq) const {
+    if ( this->isNyquist(ifrq) ) return m_cmps[ifrq].real();
+    return termFactor(ifrq)*std::abs(m_cmps[ifrq]);
+  }
+
+  // Data.
+  Norm m_norm;
+  Index m_nsam =0;
+  ComplexVector m_cmps;
+
+};
+
+//**********************************************************************
+
+#endif
@@ -0,0 +1,94 @@
+// CorrelationMatrix.cxx
+
+#include "CorrelationMatrix.h"
+#include <iomanip>
+
+using std::string;
+using std::ostream;
+using std::endl;
+using std::setw;
+
+using Index = CorrelationMatrix::Index;
+using Name = CorrelationMatrix::Name;
+using IntVector = CorrelationMatrix::IntVector;
+
+//**********************************************************************
+
+void CorrelationMatrix::reset(const IndexVector& chans, Index maxLag) {
+  m_chans = chans;
+  m_maxLag = maxLag;
+  std::size_t nval = std::size_t(size())*size();
+  m_zeroLags.assign(nval, 0.0);
+  m_peaks.assign(nval, 0.0);
+  m_peakLags.assign(nval, 0);
+}
+
+//**********************************************************************
+
+void CorrelationMatrix::set(Index icha, Index jcha, float zeroLag, float peak, int peakLag) {
+  if ( icha >= size() || jcha >= size() ) return;
+  std::size_t ival = index(icha, jcha);
+  std::size_t jval = index(jcha, icha);
+  m_zeroLags[ival] = zeroLag;
+  m_zeroLags[jval] = zeroLag;
+  m_peaks[ival] = peak;
+  m_peaks[jval] = peak;
+  m_peakLags[ival] = peakLag;
+  m_peakLags[jval] = -peakLag;
+}
+
+//**********************************************************************
+
+void CorrelationMatrix::fill(DataMap& res, Name prefix) const {
+  res.setIntVector(prefix + "Channels", IntVector(m_chans.begin(), m_chans.end()));
+  res.setInt(prefix + "MaxLag", m_maxLag);
+  res.setFloatVector(prefix + "ZeroLag", m_zeroLags);
+  res.setFloatVector(prefix + "Peak", m_peaks);
+  res.setIntVector(prefix + "PeakLag", m_peakLags);
+}
+
+//**********************************************************************
+
+int CorrelationMatrix::read(const DataMap& res, Name prefix) {
+  if ( ! res.haveIntVector(prefix + "Channels") ) return 1;
+  if ( ! res.haveInt(prefix + "MaxLag") ) return 2;
+  if ( ! res.haveFloatVector(prefix + "ZeroLag") ) return 3;
+  if ( ! res.haveFloatVector(prefix + "Peak") ) return 4;
+  if ( ! res.haveIntVector(prefix + "PeakLag") ) return 5;
+  const IntVector& chans = res.getIntVector(prefix + "Channels");
+  std::size_t nval = chans.size()*chans.size();
+  if ( res.getFloatVector(prefix + "ZeroLag").size() != nval ||
+       res.getFloatVector(prefix + "Peak").size() != nval ||
+       res.getIntVector(prefix + "PeakLag").size() != nval ) return 6;
+  m_chans.assign(chans.begin(), chans.end());
+  m_maxLag = res.getInt(prefix + "MaxLag");
+  m_zeroLags = res.getFloatVector(prefix + "ZeroLag");
+  m_peaks = res.getFloatVector(prefix + "Peak");
+  m_peakLags = res.getIntVector(prefix + "PeakLag");
+  return 0;
+}
+
+//**********************************************************************
+
+ostream& CorrelationMatrix::print(ostream& out, Name prefix, bool usePeak) const {
+  out << prefix << "CorrelationMatrix " << (usePeak ? "peak" : "zero-lag") << " values for "
+      << size() << " channels, max lag " << m_maxLag << ":" << endl;
+  std::ios::fmtflags oldflags = out.flags();
+  std::streamsize oldprec = out.precision();
+  out << prefix << setw(8) << "";
+  for ( Index chan : m_chans ) out << setw(8) << chan;
+  out << endl;
+  for ( Index icha=0; icha<size(); ++icha ) {
+    out << prefix << setw(8) << m_chans[icha];
+    for ( Index jcha=0; jcha<size(); ++jcha ) {
+      float val = usePeak ? peak(icha, jcha) : zeroLag(icha, jcha);
+      out << setw(8) << std::fixed << std::setprecision(3) << val;
+    }
+    out << endl;
+  }
+  out.flags(oldflags);
+  out.precision(oldprec);
+  return out;
+}
+
+//**********************************************************************
@@ -0,0 +1,87 @@
+// CorrelationMatrix.h
+//
+// Correlations between all pairs of a list of channels, e.g. as evaluated by
+// FwCorrelator.
+//
+// For each pair (i, j), the matrix holds the correlation at zero lag, the
+// correlation at the lag with the largest magnitude (the peak) and that lag.
+// The lag is that of channel j with respect to channel i so the peak lag for
+// (j, i) is the negative of that for (i, j). The diagonal holds the
+// autocorrelations.
+//
+// The matrix may be written to and read from a DataMap with the entries
+//   PREChannels - IntVector of the channels
+//   PREMaxLag - Int maximum lag searched
+//   PREZeroLag - FloatVector of the zero-lag correlations, row-major
+//   PREPeak - FloatVector of the peak correlations, row-major
+//   PREPeakLag - IntVector of the peak lags, row-major
+// where PRE is a caller-supplied prefix, "corr" by default.
+
+#ifndef CorrelationMatrix_H
+#define CorrelationMatrix_H
+
+#include "dunecore/DuneInterface/Data/DataMap.h"
+#include <vector>
+#include <string>
+#include <iostream>
+
+class CorrelationMatrix {
+
+public:
+
+  using Index = unsigned int;
+  using Name = std::string;
+  using IndexVector = std::vector<Index>;
+  using IntVector = std::vector<int>;
+  using FloatVector = std::vector<float>;
+
+  // Ctor for an empty matrix.
+  CorrelationMatrix() =default;
+
+  // Ctor from the channels and maximum lag. All values are zero.
+  CorrelationMatrix(const IndexVector& chans, Index maxLag) { reset(chans, maxLag); }
+
+  // Set the channels and maximum lag and zero all values.
+  void reset(const IndexVector& chans, Index maxLag);
+
+  // Return the dimensions.
+  Index size() const { return m_chans.size(); }
+  const IndexVector& channels() const { return m_chans; }
+  Index channel(Index icha) const { return icha < size() ? m_chans[icha] : 0; }
+  Index maxLag() const { return m_maxLag; }
+
+  // Set the values for pair (icha, jcha) and those for (jcha, icha).
+  void set(Index icha, Index jcha, float zeroLag, float peak, int peakLag);
+
+  // Return the values for pair (icha, jcha). Unchecked.
+  float zeroLag(Index icha, Index jcha) const { return m_zeroLags[index(icha, jcha)]; }
+  float peak(Index icha, Index jcha) const { return m_peaks[index(icha, jcha)]; }
+  int peakLag(Index icha, Index jcha) const { return m_peakLags[index(icha, jcha)]; }
+
+  // Return the row-major arrays.
+  const FloatVector& zeroLags() const { return m_zeroLags; }
+  const FloatVector& peaks() const { return m_peaks; }
+  const IntVector& peakLags() const { return m_peakLags; }
+
+  // Write to a DataMap.
+  void fill(DataMap& res, Name prefix ="corr") const;
+
+  // Read from a DataMap. Returns nonzero if entries are missing or inconsistent.
+  int read(const DataMap& res, Name prefix ="corr");
+
+  // Print the zero-lag or peak matrix.
+  std::ostream& print(std::ostream& out =std::cout, Name prefix ="", bool usePeak =false) const;
+
+private:
+
+  std::size_t index(Index icha, Index jcha) const { return std::size_t(icha)*size() + jcha; }
+
+  IndexVector m_chans;
+  Index m_maxLag =0;
+  FloatVector m_zeroLags;
+  FloatVector m_peaks;
+  IntVector m_peakLags;
+
+};
+
+#endif
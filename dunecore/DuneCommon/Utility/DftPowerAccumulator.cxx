@@ -0,0 +1,372 @@
+// DftPowerAccumulator.cxx
+
+#include "DftPowerAccumulator.h"
+#include <fstream>
+#include <cstring>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::ostream;
+using std::ifstream;
+using std::ofstream;
+
+using Index = DftPowerAccumulator::Index;
+using Size = DftPowerAccumulator::Size;
+using IndexVector = DftPowerAccumulator::IndexVector;
+using Name = DftPowerAccumulator::Name;
+
+namespace {
+// File identifier and version.
+const char fileTag[8] = {'D', 'F', 'T', 'P', 'W', 'R', '0', '1'};
+}
+
+//**********************************************************************
+
+DftPowerAccumulator::DftPowerAccumulator(Norm norm, Index nsam)
+: m_norm(norm) {
+  setSize(norm, nsam);
+}
+
+//**********************************************************************
+
+IndexVector DftPowerAccumulator::channels() const {
+  IndexVector chans;
+  chans.reserve(m_rows.size());
+  for ( const auto& irow : m_rows ) chans.push_back(irow.first);
+  return chans;
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::add(Index chan, const DFT& dft) {
+  const string myname = "DftPowerAccumulator::add: ";
+  if ( ! dft.isValid() ) return 1;
+  if ( dft.nSample() != m_nsam ) {
+    cout << myname << "ERROR: Sample count " << dft.nSample() << " != " << m_nsam << endl;
+    return 2;
+  }
+  if ( dft.normalization().globalNormalization() != m_norm.globalNormalization() ) {
+    cout << myname << "ERROR: DFT global normalization " << dft.normalization().globalName()
+         << " != " << m_norm.globalName() << endl;
+    return 3;
+  }
+  // Amplitudes with unit term normalization are missing the factor for the aliased term.
+  bool unitTerm = dft.normalization().isUnit();
+  float* pwr = m_work.data();
+  for ( Index ibin=0; ibin<m_nbin; ++ibin ) {
+    float amp = dft.compactAmplitude(ibin);
+    pwr[ibin] = (unitTerm ? m_binFactors[ibin] : 1.0f)*amp*amp;
+  }
+  addPower(chan, pwr);
+  return 0;
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::add(const AdcChannelDataMap& acds) {
+  const string myname = "DftPowerAccumulator::add: ";
+  Norm acdNorm(AdcChannelData::dftNormalization());
+  if ( acdNorm.globalNormalization() != m_norm.globalNormalization() ) {
+    cout << myname << "ERROR: AdcChannelData global normalization " << acdNorm.globalName()
+         << " != " << m_norm.globalName() << endl;
+    return 1;
+  }
+  // AdcChannelData uses power term normalization so the power is the squared magnitude.
+  int nbad = 0;
+  float* pwr = m_work.data();
+  for ( const auto& iacd : acds ) {
+    const AdcChannelData& acd = iacd.second;
+    if ( acd.dftmags.size() == 0 ) continue;
+    if ( acd.dftmags.size() != m_nbin ) {
+      ++nbad;
+      continue;
+    }
+    const float* pmag = acd.dftmags.data();
+    for ( Index ibin=0; ibin<m_nbin; ++ibin ) pwr[ibin] = pmag[ibin]*pmag[ibin];
+    addPower(acd.channel(), pwr);
+  }
+  if ( nbad ) {
+    cout << myname << "WARNING: Skipped " << nbad << " channels with DFT size != " << m_nbin << endl;
+    return 2;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+void DftPowerAccumulator::addPower(Index chan, const float* pwr) {
+  update(row(chan), pwr);
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::merge(const DftPowerAccumulator& rhs) {
+  const string myname = "DftPowerAccumulator::merge: ";
+  if ( rhs.nSample() != m_nsam ||
+       rhs.normalization().globalNormalization() != m_norm.globalNormalization() ) {
+    cout << myname << "ERROR: Accumulators are not compatible." << endl;
+    return 1;
+  }
+  for ( const auto& irow : rhs.m_rows ) {
+    Index jrow = irow.second;
+    Size ioff = Size(jrow)*rhs.rowStride();
+    combine(row(irow.first), rhs.m_counts[jrow], &rhs.m_means[ioff], &rhs.m_m2s[ioff]);
+  }
+  for ( const auto& igrp : rhs.m_groups ) {
+    if ( m_groups.count(igrp.first) == 0 ) m_groups[igrp.first] = igrp.second;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+Index DftPowerAccumulator::count(Index chan) const {
+  auto irow = m_rows.find(chan);
+  return irow == m_rows.end() ? 0 : m_counts[irow->second];
+}
+
+//**********************************************************************
+
+const float* DftPowerAccumulator::mean(Index chan) const {
+  auto irow = m_rows.find(chan);
+  if ( irow == m_rows.end() ) return nullptr;
+  return &m_means[Size(irow->second)*rowStride()];
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::stats(Index chan, FloatVector& means, FloatVector& vars) const {
+  auto irow = m_rows.find(chan);
+  if ( irow == m_rows.end() ) return 1;
+  Index nent = m_counts[irow->second];
+  Size ioff = Size(irow->second)*rowStride();
+  means.assign(&m_means[ioff], &m_means[ioff] + m_nbin);
+  vars.assign(m_nbin, 0.0);
+  if ( nent > 1 ) {
+    float fac = 1.0/(nent - 1);
+    for ( Index ibin=0; ibin<m_nbin; ++ibin ) vars[ibin] = fac*m_m2s[ioff + ibin];
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+void DftPowerAccumulator::addGroup(Name name, const IndexVector& chans) {
+  m_groups[name] = chans;
+}
+
+//**********************************************************************
+
+std::vector<Name> DftPowerAccumulator::groupNames() const {
+  std::vector<Name> names;
+  for ( const auto& igrp : m_groups ) names.push_back(igrp.first);
+  return names;
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::groupStats(Name name, Index& count, FloatVector& means, FloatVector& vars) const {
+  count = 0;
+  means.clear();
+  vars.clear();
+  auto igrp = m_groups.find(name);
+  if ( igrp == m_groups.end() ) return 1;
+  // Merge the channel rows into a one-row accumulator.
+  DftPowerAccumulator grp(m_norm, m_nsam);
+  for ( Index chan : igrp->second ) {
+    auto irow = m_rows.find(chan);
+    if ( irow == m_rows.end() ) continue;
+    Size ioff = Size(irow->second)*rowStride();
+    grp.combine(grp.row(0), m_counts[irow->second], &m_means[ioff], &m_m2s[ioff]);
+  }
+  count = grp.count(0);
+  if ( count == 0 ) return 2;
+  return grp.stats(0, means, vars);
+}
+
+//**********************************************************************
+
+void DftPowerAccumulator::clear() {
+  m_rows.clear();
+  m_counts.clear();
+  m_means.clear();
+  m_m2s.clear();
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::write(Name fnam) const {
+  const string myname = "DftPowerAccumulator::write: ";
+  ofstream fout(fnam, std::ios::binary);
+  if ( ! fout ) {
+    cout << myname << "ERROR: Unable to open " << fnam << endl;
+    return 1;
+  }
+  auto put = [&fout](const void* pdat, Size nbyte) {
+    fout.write(static_cast<const char*>(pdat), nbyte);
+  };
+  Index inorm = 10*m_norm.termNormalization() + m_norm.globalNormalization();
+  Index ncha = m_rows.size();
+  Index ngrp = m_groups.size();
+  put(fileTag, sizeof(fileTag));
+  put(&inorm, sizeof(Index));
+  put(&m_nsam, sizeof(Index));
+  put(&ncha, sizeof(Index));
+  put(&ngrp, sizeof(Index));
+  for ( const auto& irow : m_rows ) {
+    Size ioff = Size(irow.second)*rowStride();
+    put(&irow.first, sizeof(Index));
+    put(&m_counts[irow.second], sizeof(Index));
+    put(&m_means[ioff], m_nbin*sizeof(float));
+    put(&m_m2s[ioff], m_nbin*sizeof(float));
+  }
+  for ( const auto& igrp : m_groups ) {
+    Index nchr = igrp.first.size();
+    Index ngch = igrp.second.size();
+    put(&nchr, sizeof(Index));
+    put(igrp.first.data(), nchr);
+    put(&ngch, sizeof(Index));
+    put(igrp.second.data(), ngch*sizeof(Index));
+  }
+  if ( ! fout ) {
+    cout << myname << "ERROR: Write failed for " << fnam << endl;
+    return 2;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+int DftPowerAccumulator::read(Name fnam) {
+  const string myname = "DftPowerAccumulator::read: ";
+  ifstream fin(fnam, std::ios::binary);
+  if ( ! fin ) {
+    cout << myname << "ERROR: Unable to open " << fnam << endl;
+    return 1;
+  }
+  auto get = [&fin](void* pdat, Size nbyte) {
+    fin.read(static_cast<char*>(pdat), nbyte);
+    return bool(fin);
+  };
+  char tag[sizeof(fileTag)];
+  Index inorm = 0;
+  Index nsam = 0;
+  Index ncha = 0;
+  Index ngrp = 0;
+  if ( ! get(tag, sizeof(tag)) || std::memcmp(tag, fileTag, sizeof(tag)) != 0 ) {
+    cout << myname << "ERROR: Invalid file " << fnam << endl;
+    return 2;
+  }
+  if ( ! get(&inorm, sizeof(Index)) || ! get(&nsam, sizeof(Index)) ||
+       ! get(&ncha, sizeof(Index)) || ! get(&ngrp, sizeof(Index)) ) {
+    cout << myname << "ERROR: Unable to read header from " << fnam << endl;
+    return 3;
+  }
+  Norm norm(inorm);
+  setSize(norm, nsam);
+  m_groups.clear();
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    Index chan = 0;
+    Index nent = 0;
+    Index irow = 0;
+    if ( ! get(&chan, sizeof(Index)) || ! get(&nent, sizeof(Index)) ) break;
+    irow = row(chan);
+    Size ioff = Size(irow)*rowStride();
+    m_counts[irow] = nent;
+    if ( ! get(&m_means[ioff], m_nbin*sizeof(float)) ) break;
+    if ( ! get(&m_m2s[ioff], m_nbin*sizeof(float)) ) break;
+  }
+  for ( Index igrp=0; fin && igrp<ngrp; ++igrp ) {
+    Index nchr = 0;
+    Index ngch = 0;
+    if ( ! get(&nchr, sizeof(Index)) ) break;
+    Name name(nchr, ' ');
+    if ( ! get(&name[0], nchr) || ! get(&ngch, sizeof(Index)) ) break;
+    IndexVector chans(ngch);
+    if ( ! get(chans.data(), ngch*sizeof(Index)) ) break;
+    m_groups[name] = chans;
+  }
+  if ( ! fin ) {
+    cout << myname << "ERROR: File is truncated: " << fnam << endl;
+    clear();
+    return 4;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+ostream& DftPowerAccumulator::print(ostream& out, Name prefix) const {
+  out << prefix << "DftPowerAccumulator: " << m_nsam << " samples, " << m_nbin << " bins, "
+      << m_norm.globalName() << " normalization" << endl;
+  out << prefix << "  # channels: " << nChannel() << endl;
+  out << prefix << "    # groups: " << m_groups.size() << endl;
+  return out;
+}
+
+//**********************************************************************
+
+Index DftPowerAccumulator::row(Index chan) {
+  auto irow = m_rows.find(chan);
+  if ( irow != m_rows.end() ) return irow->second;
+  Index jrow = m_counts.size();
+  m_rows[chan] = jrow;
+  m_counts.push_back(0);
+  Size nval = Size(jrow + 1)*rowStride();
+  m_means.resize(nval, 0.0);
+  m_m2s.resize(nval, 0.0);
+  return jrow;
+}
+
+//**********************************************************************
+
+void DftPowerAccumulator::update(Index irow, const float* pwr) {
+  Index nent = ++m_counts[irow];
+  float fac = 1.0/nent;
+  Size ioff = Size(irow)*rowStride();
+  float* pmea = &m_means[ioff];
+  float* pm2 = &m_m2s[ioff];
+  for ( Index ibin=0; ibin<m_nbin; ++ibin ) {
+    float dev = pwr[ibin] - pmea[ibin];
+    pmea[ibin] += fac*dev;
+    pm2[ibin] += dev*(pwr[ibin] - pmea[ibin]);
+  }
+}
+
+//**********************************************************************
+
+void DftPowerAccumulator::combine(Index irow, Index count, const float* mean, const float* m2) {
+  if ( count == 0 ) return;
+  Index nold = m_counts[irow];
+  Index nnew = nold + count;
+  m_counts[irow] = nnew;
+  float wrhs = float(count)/nnew;
+  float wdev = float(nold)*wrhs;
+  Size ioff = Size(irow)*rowStride();
+  float* pmea = &m_means[ioff];
+  float* pm2 = &m_m2s[ioff];
+  for ( Index ibin=0; ibin<m_nbin; ++ibin ) {
+    float dev = mean[ibin] - pmea[ibin];
+    pmea[ibin] += wrhs*dev;
+    pm2[ibin] += m2[ibin] + wdev*dev*dev;
+  }
+}
+
+//**********************************************************************
+
+void DftPowerAccumulator::setSize(Norm norm, Index nsam) {
+  clear();
+  m_norm = norm;
+  m_nsam = nsam;
+  m_nbin = nsam ? nsam/2 + 1 : 0;
+  // Pad rows to a multiple of the allocator alignment.
+  const Index nalign = AlignedFloatVector::allocator_type::alignment()/sizeof(float);
+  m_stride = nalign*((m_nbin + nalign - 1)/nalign);
+  m_binFactors.assign(m_nbin, 2.0);
+  if ( m_nbin ) m_binFactors[0] = 1.0;
+  if ( nsam && nsam%2 == 0 ) m_binFactors[m_nbin - 1] = 1.0;
+  m_work.assign(m_nbin, 0.0);
+}
+
+//**********************************************************************
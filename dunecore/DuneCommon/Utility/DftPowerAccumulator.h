@@ -0,0 +1,180 @@
+// DftPowerAccumulator.h
+//
+// Running mean and variance of the DFT power in each frequency bin for many
+// channels, e.g. to build noise spectra over many events.
+//
+// The power in compact bin k of an nsam-sample DFT is the contribution of that
+// bin to the total power: |X_k|^2 for the zero and Nyquist bins and 2|X_k|^2
+// for the others, i.e. the square of the amplitude with power term normalization.
+// With consistent global normalization, the sum over bins is the sum of the
+// squares of the samples. The global normalization of the input data must be
+// that of the accumulator.
+//
+// For each channel, the count and the mean and sum of squared deviations
+// (Welford) for each of the nsam/2 + 1 bins are held in contiguous float arrays,
+// one aligned row per channel. The updates are branch-free loops over these
+// rows that the compiler can vectorize. Input may be
+//   - a block of complex DFTs for many channels as returned by FwBatchFFT,
+//   - a CompactRealDftData object (as returned by FwFFT), or
+//   - the dftmags of the channels in an AdcChannelDataMap.
+//
+// Accumulators filled in different threads (or jobs) may be combined with
+// merge and saved to or read from a compact binary file.
+//
+// Groups of channels may be defined. The group statistics are those for the
+// power of all the channel-events in the group and are obtained by merging the
+// channel statistics when requested, so they cost nothing during accumulation.
+//
+// Usage:
+//   DftPowerAccumulator acc(RealDftNormalization(22), nsam);
+//   FwBatchFFT<float> xf(0);
+//   for ( each event ) {
+//     xf.fftForward(nsam, ncha, psam, acc.normalization(), dfts);
+//     acc.add(chans, dfts.data());
+//   }
+//   acc.write("noise.dftpwr");
+
+#ifndef DftPowerAccumulator_H
+#define DftPowerAccumulator_H
+
+#include "dunecore/DuneCommon/Utility/CompactRealDftData.h"
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include "dunecore/DuneInterface/Data/AlignedAllocator.h"
+#include <complex>
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+
+class DftPowerAccumulator {
+
+public:
+
+  using Index = unsigned int;
+  using Size = std::size_t;
+  using Name = std::string;
+  using Norm = RealDftNormalization;
+  using IndexVector = std::vector<Index>;
+  using FloatVector = std::vector<float>;
+  using AlignedFloatVector = std::vector<float, AlignedAllocator<float>>;
+  using DFT = CompactRealDftData<float>;
+
+  // Ctor from the DFT normalization and sample count.
+  DftPowerAccumulator(Norm norm, Index nsam);
+
+  // Return the normalization, sample count and number of frequency bins.
+  const Norm& normalization() const { return m_norm; }
+  Index nSample() const { return m_nsam; }
+  Index nBin() const { return m_nbin; }
+
+  // Return the number of channels and the list of channels.
+  Index nChannel() const { return m_rows.size(); }
+  IndexVector channels() const;
+
+  // Add the DFTs of ncha = chans.size() channels. The complex terms for channel
+  // chans[icha] start at pdft[icha*nBin()] as for FwBatchFFT::fftForward.
+  // F may be float or double.
+  // Returns 0 for success.
+  template<typename F>
+  int add(const IndexVector& chans, const std::complex<F>* pdft);
+
+  // Add the DFT for one channel. Returns 0 for success.
+  int add(Index chan, const DFT& dft);
+
+  // Add the DFTs in dftmags for all channels in a map. Channels with no DFT are
+  // skipped. Returns 0 for success.
+  int add(const AdcChannelDataMap& acds);
+
+  // Add the power for one channel: pwr[ibin] for ibin < nBin().
+  void addPower(Index chan, const float* pwr);
+
+  // Merge the data from another accumulator.
+  // Returns nonzero if the normalization or sample counts differ.
+  int merge(const DftPowerAccumulator& rhs);
+
+  // Return the number of entries for a channel.
+  Index count(Index chan) const;
+
+  // Return the mean power for a channel. Null if the channel has no data.
+  const float* mean(Index chan) const;
+
+  // Fill the mean and (sample) variance of the power for a channel.
+  // Returns nonzero if the channel has no data.
+  int stats(Index chan, FloatVector& means, FloatVector& vars) const;
+
+  // Define a group of channels. An existing group with the same name is replaced.
+  void addGroup(Name name, const IndexVector& chans);
+
+  // Return the group names.
+  std::vector<Name> groupNames() const;
+
+  // Fill the count, mean and variance for a group from all its channels.
+  // Returns nonzero if the group is not defined or has no data.
+  int groupStats(Name name, Index& count, FloatVector& means, FloatVector& vars) const;
+
+  // Remove all data. Groups are kept.
+  void clear();
+
+  // Write to and read from a binary file. Read replaces the current content,
+  // including the normalization and sample count.
+  // Return 0 for success.
+  int write(Name fnam) const;
+  int read(Name fnam);
+
+  // Print a summary.
+  std::ostream& print(std::ostream& out =std::cout, Name prefix ="") const;
+
+private:
+
+  // Number of floats in each (aligned) row.
+  Index rowStride() const { return m_stride; }
+
+  // Return the row for a channel, creating it if needed.
+  Index row(Index chan);
+
+  // Welford update of row irow with power pwr.
+  void update(Index irow, const float* pwr);
+
+  // Merge (count, mean, m2) into row irow.
+  void combine(Index irow, Index count, const float* mean, const float* m2);
+
+  // Set the dimensions.
+  void setSize(Norm norm, Index nsam);
+
+  Norm m_norm;
+  Index m_nsam;
+  Index m_nbin;
+  Index m_stride;
+  AlignedFloatVector m_binFactors;  // 1 or 2: factor applied to |X_k|^2
+  std::map<Index, Index> m_rows;    // Row for each channel
+  IndexVector m_counts;             // Count for each row
+  AlignedFloatVector m_means;       // Mean for each row and bin
+  AlignedFloatVector m_m2s;         // Sum of squared deviations for each row and bin
+  AlignedFloatVector m_work;        // Power for one channel
+  std::map<Name, IndexVector> m_groups;
+
+};
+
+//**********************************************************************
+
+template<typename F>
+int DftPowerAccumulator::add(const IndexVector& chans, const std::complex<F>* pdft) {
+  if ( pdft == nullptr ) return 1;
+  Index nbin = m_nbin;
+  const float* pfac = m_binFactors.data();
+  float* pwr = m_work.data();
+  for ( Index icha=0; icha<chans.size(); ++icha ) {
+    const F* pval = reinterpret_cast<const F*>(pdft + Size(icha)*nbin);
+    for ( Index ibin=0; ibin<nbin; ++ibin ) {
+      F xre = pval[2*ibin];
+      F xim = pval[2*ibin + 1];
+      pwr[ibin] = pfac[ibin]*float(xre*xre + xim*xim);
+    }
+    addPower(chans[icha], pwr);
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+#endif
@@ -1,9 +1,14 @@
 // DuneFFT.cxx
 #include "DuneFFT.h"
+#include "FftwPlanCache.h"
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <iomanip>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
 #include "TVirtualFFT.h"
 #include "TComplex.h"
 
@@ -15,34 +20,219 @@ using std::vector;
 using std::setw;
 using std::fixed;
 
+using Index = DuneFFT::Index;
+using Complex = DuneFFTBackend::Complex;
+
+//**********************************************************************
+// Backends.
+//**********************************************************************
+
+namespace {
+
+// FFTW with shared plans and per-thread aligned work arrays.
+class FftwBackend : public DuneFFTBackend {
+
+public:
+
+  string name() const override { return "FFTW"; }
+
+  const Complex* forward(Index nsam, const float* psam) override {
+    Work& work = threadWork();
+    work.reserve(nsam);
+    fftw_plan plan = FftwPlanCache<double>::instance().forwardPlan(nsam, 1, FFTW_ESTIMATE);
+    if ( plan == nullptr ) return nullptr;
+    for ( Index isam=0; isam<nsam; ++isam ) work.rea[isam] = psam[isam];
+    fftw_execute_dft_r2c(plan, work.rea, work.cmp);
+    return reinterpret_cast<const Complex*>(work.cmp);
+  }
+
+  const double* backward(Index nsam, const Complex* pdft) override {
+    Work& work = threadWork();
+    work.reserve(nsam);
+    fftw_plan plan = FftwPlanCache<double>::instance().backwardPlan(nsam, 1, FFTW_ESTIMATE);
+    if ( plan == nullptr ) return nullptr;
+    std::copy(pdft, pdft + nsam/2 + 1, reinterpret_cast<Complex*>(work.cmp));
+    fftw_execute_dft_c2r(plan, work.cmp, work.rea);
+    return work.rea;
+  }
+
+private:
+
+  struct Work {
+    double* rea =nullptr;
+    fftw_complex* cmp =nullptr;
+    Index nsam =0;
+    ~Work() {
+      if ( rea != nullptr ) fftw_free(rea);
+      if ( cmp != nullptr ) fftw_free(cmp);
+    }
+    void reserve(Index a_nsam) {
+      if ( a_nsam <= nsam ) return;
+      if ( rea != nullptr ) fftw_free(rea);
+      if ( cmp != nullptr ) fftw_free(cmp);
+      rea = fftw_alloc_real(a_nsam);
+      cmp = fftw_alloc_complex(a_nsam/2 + 1);
+      nsam = a_nsam;
+    }
+  };
+
+  static Work& threadWork() {
+    thread_local Work work;
+    return work;
+  }
+
+};
+
+//**********************************************************************
+
+// Root TVirtualFFT.
+class RootBackend : public DuneFFTBackend {
+
+public:
+
+  string name() const override { return "ROOT"; }
+
+  const Complex* forward(Index nsam, const float* psam) override {
+    thread_local vector<double> sams;
+    thread_local vector<Complex> dft;
+    sams.assign(psam, psam + nsam);
+    Index ncmp = nsam/2 + 1;
+    dft.resize(ncmp);
+    int nsamInt = nsam;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TVirtualFFT* pfft = TVirtualFFT::FFT(1, &nsamInt, "R2C");
+    if ( pfft == nullptr ) return nullptr;
+    pfft->SetPoints(sams.data());
+    pfft->Transform();
+    double xre = 0.0;
+    double xim = 0.0;
+    for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) {
+      pfft->GetPointComplex(ifrq, xre, xim);
+      dft[ifrq] = Complex(xre, xim);
+    }
+    return dft.data();
+  }
+
+  const double* backward(Index nsam, const Complex* pdft) override {
+    thread_local vector<double> xres;
+    thread_local vector<double> xims;
+    thread_local vector<double> sams;
+    // Fill the full array using the conjugate symmetry.
+    xres.resize(nsam);
+    xims.resize(nsam);
+    for ( Index ifrq=0; ifrq<nsam; ++ifrq ) {
+      bool alias = 2*ifrq > nsam;
+      const Complex& val = pdft[alias ? nsam - ifrq : ifrq];
+      xres[ifrq] = val.real();
+      xims[ifrq] = alias ? -val.imag() : val.imag();
+    }
+    sams.resize(nsam);
+    int nsamInt = nsam;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TVirtualFFT* pfft = TVirtualFFT::FFT(1, &nsamInt, "C2R");
+    if ( pfft == nullptr ) return nullptr;
+    pfft->SetPointsComplex(xres.data(), xims.data());
+    pfft->Transform();
+    for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = pfft->GetPointReal(isam);
+    return sams.data();
+  }
+
+private:
+
+  std::mutex m_mutex;
+
+};
+
+//**********************************************************************
+
+// Registry of backends.
+struct BackendRegistry {
+  std::mutex mutex;
+  std::map<string, std::unique_ptr<DuneFFTBackend>> backends;
+  std::atomic<DuneFFTBackend*> current;
+  BackendRegistry() {
+    backends["FFTW"].reset(new FftwBackend);
+    backends["ROOT"].reset(new RootBackend);
+    const char* penv = std::getenv("DUNEFFT_BACKEND");
+    auto ibak = backends.find(penv == nullptr ? "FFTW" : penv);
+    if ( ibak == backends.end() ) {
+      cout << "DuneFFT: WARNING: Invalid backend " << penv << " requested. Using FFTW." << endl;
+      ibak = backends.find("FFTW");
+    }
+    current = ibak->second.get();
+  }
+};
+
+BackendRegistry& registry() {
+  static BackendRegistry reg;
+  return reg;
+}
+
+}  // end unnamed namespace
+
 //**********************************************************************
 // Class methods.
 //**********************************************************************
 
+DuneFFT::Backend& DuneFFT::backend() {
+  return *registry().current;
+}
+
+//**********************************************************************
+
+int DuneFFT::setBackend(const Name& name) {
+  const string myname = "DuneFFT::setBackend: ";
+  BackendRegistry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  auto ibak = reg.backends.find(name);
+  if ( ibak == reg.backends.end() ) {
+    cout << myname << "Backend not found: " << name << endl;
+    return 1;
+  }
+  reg.current = ibak->second.get();
+  return 0;
+}
+
+//**********************************************************************
+
+int DuneFFT::addBackend(std::unique_ptr<Backend> pbak) {
+  const string myname = "DuneFFT::addBackend: ";
+  if ( ! pbak ) return 1;
+  BackendRegistry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  Name name = pbak->name();
+  if ( reg.backends.count(name) ) {
+    cout << myname << "Backend already exists: " << name << endl;
+    return 2;
+  }
+  reg.backends[name] = std::move(pbak);
+  return 0;
+}
+
+//**********************************************************************
+
 int DuneFFT::
 fftForward(Index nsam, const float* psam, DFT& dft, Index logLevel) {
   const string myname = "DuneFFT::fftForward: ";
   dft.reset(nsam);
   if ( ! dft.isValid() ) return 1;
   if ( nsam == 0 ) return 0;
-  vector<double> sams(nsam);
-  for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = psam[isam];
-  int nsamInt = nsam;
-  TVirtualFFT* pfft = TVirtualFFT::FFT(1, &nsamInt, "R2C");
-  pfft->SetPoints(&sams[0]);
-  pfft->Transform();
+  const Complex* pdft = backend().forward(nsam, psam);
+  if ( pdft == nullptr ) {
+    cout << myname << "Transform failed for backend " << backend().name() << endl;
+    return 2;
+  }
   double xre = 0.0;
   double xim = 0.0;
   Index namp = dft.nAmplitude();
   Index npha = dft.nPhase();
-  FloatVector amps(namp);
-  FloatVector phas(npha);
   // Loop over the compact samples.
   float nfac = 1.0;
   if ( dft.normalization().isConsistent() ) nfac = 1.0/sqrt(nsam);
   if ( dft.normalization().isBin() ) nfac = 1.0/nsam;
   for ( Index ifrq=0; ifrq<namp; ++ifrq ) {
-    pfft->GetPointComplex(ifrq, xre, xim);
+    xre = pdft[ifrq].real();
+    xim = pdft[ifrq].imag();
     // For an even # samples (namp = npha + 1), the Nyquist term is real
     // and we store the sign with the amplitude.
     double xam = ifrq < npha ? sqrt(xre*xre + xim*xim) : xre;
@@ -85,33 +275,32 @@ fftInverse(const DFT& dft, FloatVector& sams, Index logLevel) {
   if ( namp < npha ) return 2;
   if ( namp - npha > 1 ) return 3;
   Index nsam = namp + npha - 1;
-  int nsamInt = nsam;
-  TVirtualFFT* pfft = TVirtualFFT::FFT(1, &nsamInt, "C2R");
-  vector<double> xdres(nsam, 0.0);
-  vector<double> xdims(nsam, 0.0);
-  for ( Index ifrq=0; ifrq<nsam; ++ifrq ) {
+  Index ncmp = nsam/2 + 1;
+  thread_local vector<Complex> xdft;
+  xdft.resize(ncmp);
+  for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) {
     double amp = dft.convAmplitude(ifrq);
     double pha = dft.phase(ifrq);
-    double xre = amp*cos(pha);
-    double xim = amp*sin(pha);
-    xdres[ifrq] = xre;
-    xdims[ifrq] = xim;
+    xdft[ifrq] = Complex(amp*cos(pha), amp*sin(pha));
   }
-  pfft->SetPointsComplex(&xdres[0], &xdims[0]);
   if ( logLevel >= 3 ) {
     cout << myname << "Inverting" << endl;
     cout << myname << "Real/imag components:" << endl;
-    for ( Index ifrq=0; ifrq<nsam; ++ifrq ) {
-      float xre = xdres[ifrq];
-      float xim = xdims[ifrq];
+    for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) {
+      float xre = xdft[ifrq].real();
+      float xim = xdft[ifrq].imag();
       cout << myname << setw(4) << ifrq << ": (" << setw(10) << fixed << xre
            << ", " << setw(10) << fixed << xim << ")" << endl;
     }
   }
-  pfft->Transform();
+  const double* pout = backend().backward(nsam, xdft.data());
+  if ( pout == nullptr ) {
+    cout << myname << "Transform failed for backend " << backend().name() << endl;
+    return 4;
+  }
   sams.resize(nsam);
   float nfac = 1.0/nsam;
-  for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = nfac*pfft->GetPointReal(isam);
+  for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = nfac*pout[isam];
   return 0;
 }
 
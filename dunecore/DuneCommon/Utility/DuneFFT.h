@@ -4,8 +4,14 @@
 // April 2019
 //
 // This utility provides wrappers for performing forward and backward DFT (discrete
-// Fourier transform) of real (time-domain) data. It uses the the Root TVirtualFFT
-// interface which in turn uses FFTW by default.
+// Fourier transform) of real (time-domain) data.
+//
+// The transforms are delegated to a backend (DuneFFTBackend). Two are provided:
+//   FFTW - FFTW with plans from FftwPlanCache and per-thread work arrays (default)
+//   ROOT - Root TVirtualFFT. Calls are serialized because TVirtualFFT shares one
+//          transform object and re-plans for each call.
+// The default may be changed with environment variable DUNEFFT_BACKEND or by
+// calling setBackend. Other backends may be added with addBackend.
 //
 // The real data is held in a vector of floats. The DFT is a vector of complex values
 // of the same length and so has a factor of two redundancy. The DFT data is returned
@@ -19,6 +25,38 @@
 #define DuneFFT_H
 
 #include "dunecore/DuneCommon/Utility/CompactRealDftData.h"
+#include <complex>
+#include <memory>
+#include <string>
+
+//**********************************************************************
+
+// Interface for the transform implementation.
+// Both methods return results held by the backend for the calling thread.
+// These remain valid until the next call from that thread.
+class DuneFFTBackend {
+
+public:
+
+  using Index = unsigned int;
+  using Complex = std::complex<double>;
+
+  virtual ~DuneFFTBackend() =default;
+
+  // Backend name.
+  virtual std::string name() const =0;
+
+  // Forward transform of nsam real values.
+  // Returns the nsam/2 + 1 unnormalized complex terms or null for error.
+  virtual const Complex* forward(Index nsam, const float* psam) =0;
+
+  // Backward transform of the nsam/2 + 1 compact complex terms for nsam samples.
+  // Returns the nsam unnormalized real values or null for error.
+  virtual const double* backward(Index nsam, const Complex* pdft) =0;
+
+};
+
+//**********************************************************************
 
 class DuneFFT {
 
@@ -27,6 +65,18 @@ public:
   using Index = unsigned int;
   using DFT = CompactRealDftData<float>;
   using FloatVector = std::vector<float>;
+  using Backend = DuneFFTBackend;
+  using Name = std::string;
+
+  // Return the current backend.
+  static Backend& backend();
+
+  // Select the backend by name. Returns nonzero if there is no such backend.
+  static int setBackend(const Name& name);
+
+  // Add a backend. Backends are held until the end of the job.
+  // Returns nonzero if there is already a backend with the same name.
+  static int addBackend(std::unique_ptr<Backend> pbak);
 
   // Forward transform: real data (ntick starting at psam[0] --> complex freqs).
   //   ntick - # ticks to use in transform.
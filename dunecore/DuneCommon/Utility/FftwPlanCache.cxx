@@ -0,0 +1,198 @@
+// FftwPlanCache.cxx
+#include "FftwPlanCache.h"
+#include <mutex>
+#include <chrono>
+
+//**********************************************************************
+
+template<typename F>
+FftwPlanCache<F>& FftwPlanCache<F>::instance() {
+  static FftwPlanCache cache;
+  return cache;
+}
+
+//**********************************************************************
+
+template<typename F>
+unsigned FftwPlanCache<F>::flag(Index opt) {
+  return opt==2 ? FFTW_PATIENT : opt==1 ? FFTW_MEASURE : FFTW_ESTIMATE;
+}
+
+//**********************************************************************
+
+template<typename F>
+bool FftwPlanCache<F>::isGoodSize(Index n) {
+  if ( n == 0 ) return false;
+  for ( Index fac : {2, 3, 5, 7} ) {
+    while ( n%fac == 0 ) n /= fac;
+  }
+  return n == 1;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Index FftwPlanCache<F>::goodSize(Index n) {
+  if ( n == 0 ) return 0;
+  while ( ! isGoodSize(n) ) ++n;
+  return n;
+}
+
+//**********************************************************************
+
+template<typename F>
+FftwPlanCache<F>::FftwPlanCache() {
+  m_threadsInitialized = Traits::initThreads();
+}
+
+//**********************************************************************
+
+template<typename F>
+FftwPlanCache<F>::~FftwPlanCache() {
+  for ( auto& iplan : m_plans ) {
+    if ( iplan.second != nullptr ) Traits::destroy(iplan.second);
+  }
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Plan
+FftwPlanCache<F>::forwardPlan(Index nsam, Index howmany, unsigned flag) {
+  if ( nsam == 0 || howmany == 0 ) return nullptr;
+  return getPlan(Key(true, 1, nsam, 0, howmany, false, flag, 1));
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Plan
+FftwPlanCache<F>::backwardPlan(Index nsam, Index howmany, unsigned flag) {
+  if ( nsam == 0 || howmany == 0 ) return nullptr;
+  return getPlan(Key(false, 1, nsam, 0, howmany, false, flag, 1));
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Plan
+FftwPlanCache<F>::forward2dPlan(const IndexArray& nsams, bool inPlace, unsigned flag, Index nthread) {
+  if ( nsams[0] == 0 || nsams[1] == 0 ) return nullptr;
+  return getPlan(Key(true, 2, nsams[0], nsams[1], 1, inPlace, flag, nthread ? nthread : 1));
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Plan
+FftwPlanCache<F>::backward2dPlan(const IndexArray& nsams, bool inPlace, unsigned flag, Index nthread) {
+  if ( nsams[0] == 0 || nsams[1] == 0 ) return nullptr;
+  return getPlan(Key(false, 2, nsams[0], nsams[1], 1, inPlace, flag, nthread ? nthread : 1));
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Index FftwPlanCache<F>::size() const {
+  std::shared_lock<std::shared_mutex> lock(m_mutex);
+  return m_plans.size();
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::PlanStats FftwPlanCache<F>::planStats() const {
+  std::shared_lock<std::shared_mutex> lock(m_mutex);
+  return m_stats;
+}
+
+//**********************************************************************
+
+template<typename F>
+int FftwPlanCache<F>::importWisdom(const Name& fnam) {
+  std::unique_lock<std::shared_mutex> lock(m_mutex);
+  return Traits::importWisdom(fnam.c_str()) ? 0 : 1;
+}
+
+//**********************************************************************
+
+template<typename F>
+int FftwPlanCache<F>::exportWisdom(const Name& fnam) const {
+  std::unique_lock<std::shared_mutex> lock(m_mutex);
+  return Traits::exportWisdom(fnam.c_str()) ? 0 : 1;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Plan FftwPlanCache<F>::getPlan(const Key& key) {
+  {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    typename PlanMap::const_iterator iplan = m_plans.find(key);
+    if ( iplan != m_plans.end() ) return iplan->second;
+  }
+  std::unique_lock<std::shared_mutex> lock(m_mutex);
+  // Another thread may have created the plan while we waited.
+  typename PlanMap::const_iterator iplan = m_plans.find(key);
+  if ( iplan != m_plans.end() ) return iplan->second;
+  auto tbeg = std::chrono::steady_clock::now();
+  Plan plan = createPlan(key);
+  std::chrono::duration<double> dtim = std::chrono::steady_clock::now() - tbeg;
+  ++m_stats.count;
+  m_stats.time += dtim.count();
+  if ( dtim.count() > m_stats.maxTime ) m_stats.maxTime = dtim.count();
+  m_plans[key] = plan;
+  return plan;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FftwPlanCache<F>::Plan FftwPlanCache<F>::createPlan(const Key& key) {
+  using Real = typename Traits::Real;
+  using Complex = typename Traits::Complex;
+  bool fwd = std::get<0>(key);
+  Index rank = std::get<1>(key);
+  Index n0 = std::get<2>(key);
+  Index n1 = std::get<3>(key);
+  Index howmany = std::get<4>(key);
+  bool inPlace = std::get<5>(key);
+  unsigned flag = std::get<6>(key);
+  Index nthread = std::get<7>(key);
+  // Sizes of the scratch arrays used for planning.
+  // For 1D, n0 is the transform length.
+  std::size_t nrow = rank == 1 ? howmany : n0;
+  std::size_t nrea = rank == 1 ? n0 : n1;
+  std::size_t ncmp = nrea/2 + 1;
+  Plan plan = nullptr;
+  if ( nthread > 1 && m_threadsInitialized ) Traits::planWithNthreads(nthread);
+  if ( inPlace ) {
+    Complex* pcmp = Traits::allocComplex(nrow*ncmp);
+    Real* prea = reinterpret_cast<Real*>(pcmp);
+    plan = fwd ? Traits::planR2c2d(n0, n1, prea, pcmp, flag)
+               : Traits::planC2r2d(n0, n1, pcmp, prea, flag);
+    Traits::free(pcmp);
+  } else {
+    Real* prea = Traits::allocReal(nrow*nrea);
+    Complex* pcmp = Traits::allocComplex(nrow*ncmp);
+    if ( rank == 1 ) {
+      plan = fwd ? Traits::planManyR2c(n0, howmany, prea, n0, pcmp, ncmp, flag)
+                 : Traits::planManyC2r(n0, howmany, pcmp, ncmp, prea, n0, flag);
+    } else {
+      plan = fwd ? Traits::planR2c2d(n0, n1, prea, pcmp, flag)
+                 : Traits::planC2r2d(n0, n1, pcmp, prea, flag);
+    }
+    Traits::free(prea);
+    Traits::free(pcmp);
+  }
+  // Later plans are single-threaded unless requested.
+  if ( nthread > 1 && m_threadsInitialized ) Traits::planWithNthreads(1);
+  return plan;
+}
+
+//**********************************************************************
+
+template class FftwPlanCache<double>;
+template class FftwPlanCache<float>;
+
+//**********************************************************************
@@ -0,0 +1,134 @@
+// FftwPlanCache.h
+//
+// Process-wide cache of FFTW plans.
+//
+// FFTW plans are expensive to create (especially with FFTW_MEASURE or
+// FFTW_PATIENT) and the FFTW planner is not thread-safe, but executing a
+// plan is. This class holds one plan for each transform type, size and
+// planner flag and creates it on first request under a lock. The plans are
+// created on scratch arrays and so are not bound to any caller data: they are
+// executed with the FFTW new-array interface, e.g.
+//   auto plan = FftwPlanCache<double>::instance().forwardPlan(nsam, 1, flag);
+//   fftw_execute_dft_r2c(plan, in, out);
+// on caller arrays allocated with fftw_malloc (or with the same alignment)
+// that have the layout of the plan. Any number of threads may then transform
+// concurrently with the same plan.
+//
+// Plans are held until the end of the job and must not be destroyed by the
+// caller.
+//
+// The FFTW wisdom accumulated in planning may be saved to a file with
+// exportWisdom and read back in a later job with importWisdom, after which
+// plans with the same flags are created almost immediately.
+//
+// 2D plans may be created to use multiple threads (FFTW threads library).
+// This pays only for large arrays, e.g. a full wire plane.
+//
+// The number of plans created and the time spent creating them are recorded
+// and returned by planStats.
+//
+// FFTW is fastest for lengths whose only prime factors are 2, 3, 5 and 7.
+// goodSize returns the smallest such length not less than a given length
+// for callers that can pad their data.
+//
+// The template parameter selects the precision: double (fftw_) or float (fftwf_).
+// FwFFT, Fw2dFFT and FwBatchFFT obtain their plans from here.
+//
+// Planning done outside this class (e.g. ROOT TVirtualFFT) is not serialized.
+
+#ifndef FftwPlanCache_H
+#define FftwPlanCache_H
+
+#include "dunecore/DuneCommon/Utility/FftwTraits.h"
+#include <array>
+#include <map>
+#include <string>
+#include <tuple>
+#include <shared_mutex>
+
+template<typename F>
+class FftwPlanCache {
+
+public:
+
+  using Index = unsigned int;
+  using IndexArray = std::array<Index, 2>;
+  using Traits = FftwTraits<F>;
+  using Plan = typename Traits::Plan;
+  using Name = std::string;
+
+  // Plan creation statistics.
+  struct PlanStats {
+    Index count =0;       // # plans created
+    double time =0.0;     // Total time [sec]
+    double maxTime =0.0;  // Time for the slowest plan [sec]
+  };
+
+  // Return the cache for this precision.
+  static FftwPlanCache& instance();
+
+  // Return the FFTW planner flag for an optimization level.
+  // opt = 0-2 (FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT)
+  static unsigned flag(Index opt);
+
+  // Return if n has no prime factors other than 2, 3, 5 and 7.
+  static bool isGoodSize(Index n);
+
+  // Return the smallest good size not less than n.
+  static Index goodSize(Index n);
+
+  // Dtor. Destroys the plans.
+  ~FftwPlanCache();
+
+  // No copy.
+  FftwPlanCache(const FftwPlanCache&) =delete;
+  FftwPlanCache& operator=(const FftwPlanCache&) =delete;
+
+  // Return the plan for howmany 1D transforms of nsam real values.
+  // The real data for transform i starts at i*nsam and the complex data at
+  // i*(nsam/2 + 1). Returns null if nsam or howmany is zero.
+  Plan forwardPlan(Index nsam, Index howmany, unsigned flag);
+  Plan backwardPlan(Index nsam, Index howmany, unsigned flag);
+
+  // Return the plan for a 2D transform of nsams[0] x nsams[1] real values.
+  // For out-of-place plans, the real data is contiguous. For in-place plans,
+  // each row is padded to 2*(nsams[1]/2 + 1) values (see Tpc2dRoiBuffer).
+  // The plan uses nthread threads.
+  // Returns null if either dimension is zero.
+  Plan forward2dPlan(const IndexArray& nsams, bool inPlace, unsigned flag, Index nthread =1);
+  Plan backward2dPlan(const IndexArray& nsams, bool inPlace, unsigned flag, Index nthread =1);
+
+  // Return the number of cached plans.
+  Index size() const;
+
+  // Return the plan creation statistics.
+  PlanStats planStats() const;
+
+  // Import or export FFTW wisdom from/to a file.
+  // Returns 0 for success.
+  int importWisdom(const Name& fnam);
+  int exportWisdom(const Name& fnam) const;
+
+private:
+
+  // Plan identifier: (forward, rank, n0, n1, howmany, inPlace, flag, nthread).
+  using Key = std::tuple<bool, Index, Index, Index, Index, bool, unsigned, Index>;
+  using PlanMap = std::map<Key, Plan>;
+
+  // Ctor. FFTW threads are initialized here, once per precision.
+  FftwPlanCache();
+
+  // Return the plan for a key, creating it if needed.
+  Plan getPlan(const Key& key);
+
+  // Create a plan. Called with the lock held.
+  Plan createPlan(const Key& key);
+
+  mutable std::shared_mutex m_mutex;
+  PlanMap m_plans;
+  bool m_threadsInitialized =false;
+  PlanStats m_stats;
+
+};
+
+#endif
@@ -0,0 +1,85 @@
+// FftwTraits.h
+//
+// Precision traits for FFTW.
+//
+// FftwTraits<F> maps the floating type F (double or float) onto the FFTW
+// types and calls for that precision (fftw_... or fftwf_...) so that FFT
+// classes may be written once as templates. Only the calls used by the
+// dunecore FFT wrappers are included.
+
+#ifndef FftwTraits_H
+#define FftwTraits_H
+
+#include "fftw3.h"
+#include <cstddef>
+
+template<typename F>
+struct FftwTraits;
+
+//**********************************************************************
+
+template<>
+struct FftwTraits<double> {
+  using Real = double;
+  using Complex = fftw_complex;
+  using Plan = fftw_plan;
+  static const char* name() { return "double"; }
+  static Real* allocReal(std::size_t n) { return n ? fftw_alloc_real(n) : nullptr; }
+  static Complex* allocComplex(std::size_t n) { return n ? fftw_alloc_complex(n) : nullptr; }
+  static void free(void* p) { if ( p != nullptr ) fftw_free(p); }
+  static Plan planManyR2c(int n, int howmany, Real* in, int idist, Complex* out, int odist, unsigned flags) {
+    return fftw_plan_many_dft_r2c(1, &n, howmany, in, nullptr, 1, idist, out, nullptr, 1, odist, flags);
+  }
+  static Plan planManyC2r(int n, int howmany, Complex* in, int idist, Real* out, int odist, unsigned flags) {
+    return fftw_plan_many_dft_c2r(1, &n, howmany, in, nullptr, 1, idist, out, nullptr, 1, odist, flags);
+  }
+  static Plan planR2c2d(int n0, int n1, Real* in, Complex* out, unsigned flags) {
+    return fftw_plan_dft_r2c_2d(n0, n1, in, out, flags);
+  }
+  static Plan planC2r2d(int n0, int n1, Complex* in, Real* out, unsigned flags) {
+    return fftw_plan_dft_c2r_2d(n0, n1, in, out, flags);
+  }
+  static void executeR2c(const Plan p, Real* in, Complex* out) { fftw_execute_dft_r2c(p, in, out); }
+  static void executeC2r(const Plan p, Complex* in, Real* out) { fftw_execute_dft_c2r(p, in, out); }
+  static void destroy(Plan p) { fftw_destroy_plan(p); }
+  static bool importWisdom(const char* fnam) { return fftw_import_wisdom_from_filename(fnam); }
+  static bool exportWisdom(const char* fnam) { return fftw_export_wisdom_to_filename(fnam); }
+  static bool initThreads() { return fftw_init_threads(); }
+  static void planWithNthreads(int nthread) { fftw_plan_with_nthreads(nthread); }
+};
+
+//**********************************************************************
+
+template<>
+struct FftwTraits<float> {
+  using Real = float;
+  using Complex = fftwf_complex;
+  using Plan = fftwf_plan;
+  static const char* name() { return "float"; }
+  static Real* allocReal(std::size_t n) { return n ? fftwf_alloc_real(n) : nullptr; }
+  static Complex* allocComplex(std::size_t n) { return n ? fftwf_alloc_complex(n) : nullptr; }
+  static void free(void* p) { if ( p != nullptr ) fftwf_free(p); }
+  static Plan planManyR2c(int n, int howmany, Real* in, int idist, Complex* out, int odist, unsigned flags) {
+    return fftwf_plan_many_dft_r2c(1, &n, howmany, in, nullptr, 1, idist, out, nullptr, 1, odist, flags);
+  }
+  static Plan planManyC2r(int n, int howmany, Complex* in, int idist, Real* out, int odist, unsigned flags) {
+    return fftwf_plan_many_dft_c2r(1, &n, howmany, in, nullptr, 1, idist, out, nullptr, 1, odist, flags);
+  }
+  static Plan planR2c2d(int n0, int n1, Real* in, Complex* out, unsigned flags) {
+    return fftwf_plan_dft_r2c_2d(n0, n1, in, out, flags);
+  }
+  static Plan planC2r2d(int n0, int n1, Complex* in, Real* out, unsigned flags) {
+    return fftwf_plan_dft_c2r_2d(n0, n1, in, out, flags);
+  }
+  static void executeR2c(const Plan p, Real* in, Complex* out) { fftwf_execute_dft_r2c(p, in, out); }
+  static void executeC2r(const Plan p, Complex* in, Real* out) { fftwf_execute_dft_c2r(p, in, out); }
+  static void destroy(Plan p) { fftwf_destroy_plan(p); }
+  static bool importWisdom(const char* fnam) { return fftwf_import_wisdom_from_filename(fnam); }
+  static bool exportWisdom(const char* fnam) { return fftwf_export_wisdom_to_filename(fnam); }
+  static bool initThreads() { return fftwf_init_threads(); }
+  static void planWithNthreads(int nthread) { fftwf_plan_with_nthreads(nthread); }
+};
+
+//**********************************************************************
+
+#endif
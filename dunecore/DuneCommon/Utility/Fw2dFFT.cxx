@@ -1,5 +1,6 @@
 // Fw2dFFT.cxx
 #include "Fw2dFFT.h"
+#include "FftwPlanCache.h"
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -19,17 +20,16 @@ using std::fixed;
 // Class methods.
 //**********************************************************************
 
-Fw2dFFT::Fw2dFFT(Index ndatMax, Index opt)
+Fw2dFFT::Fw2dFFT(Index ndatMax, Index opt, Index nthread)
 : m_ndatMax(ndatMax),
-  m_flag(opt==2 ? FFTW_PATIENT : opt==1 ? FFTW_MEASURE : FFTW_ESTIMATE),
+  m_flag(FftwPlanCache<DftFloat>::flag(opt)),
+  m_nthread(nthread ? nthread : 1),
   m_inData(reinterpret_cast<DftFloat*>(fftw_malloc(m_ndatMax*sizeof(DftFloat)))),
   m_outData(reinterpret_cast<Complex*>(fftw_malloc(m_ndatMax*sizeof(DftFloat)))) { }
 
 //**********************************************************************
 
 Fw2dFFT::~Fw2dFFT() {
-  for ( auto& iplan : m_forwardPlans ) fftw_destroy_plan(iplan.second);
-  for ( auto& iplan : m_backwardPlans ) fftw_destroy_plan(iplan.second);
   fftw_free(m_inData);
   fftw_free(m_outData);
 }
@@ -47,6 +47,12 @@ Fw2dFFT::Index Fw2dFFT::checkDataSize(const IndexArray& nsams) const {
 
 //**********************************************************************
 
+Fw2dFFT::Index Fw2dFFT::threadCount(const IndexArray& nsams) const {
+  return nsams[0]*nsams[1] >= threadMinSize() ? m_nthread : 1;
+}
+
+//**********************************************************************
+
 bool Fw2dFFT::haveForwardPlan(const IndexArray& nsams) const {
   return m_forwardPlans.count(nsams);
 }
@@ -67,7 +73,7 @@ Fw2dFFT::Plan& Fw2dFFT::forwardPlan(const IndexArray& nsams) {
     return badplan;
   }
   if ( m_forwardPlans.count(nsams) == 0 ) {
-    m_forwardPlans[nsams] = fftw_plan_dft_r2c_2d(nsams[0], nsams[1], m_inData, fftwOutData(), m_flag);
+    m_forwardPlans[nsams] = FftwPlanCache<DftFloat>::instance().forward2dPlan(nsams, false, m_flag, threadCount(nsams));
   }
   return m_forwardPlans[nsams];
 }
@@ -82,13 +88,45 @@ Fw2dFFT::Plan& Fw2dFFT::backwardPlan(const IndexArray& nsams) {
     return badplan;
   }
   if ( m_backwardPlans.count(nsams) == 0 ) {
-    m_backwardPlans[nsams] = fftw_plan_dft_c2r_2d(nsams[0], nsams[1], fftwOutData(), m_inData, m_flag);
+    m_backwardPlans[nsams] = FftwPlanCache<DftFloat>::instance().backward2dPlan(nsams, false, m_flag, threadCount(nsams));
   }
   return m_backwardPlans[nsams];
 }
 
 //**********************************************************************
 
+Fw2dFFT::Plan& Fw2dFFT::forwardInPlacePlan(const IndexArray& nsams) {
+  if ( m_forwardInPlacePlans.count(nsams) == 0 ) {
+    m_forwardInPlacePlans[nsams] =
+      FftwPlanCache<DftFloat>::instance().forward2dPlan(nsams, true, m_flag, threadCount(nsams));
+  }
+  return m_forwardInPlacePlans[nsams];
+}
+
+//**********************************************************************
+
+Fw2dFFT::Plan& Fw2dFFT::backwardInPlacePlan(const IndexArray& nsams) {
+  if ( m_backwardInPlacePlans.count(nsams) == 0 ) {
+    m_backwardInPlacePlans[nsams] =
+      FftwPlanCache<DftFloat>::instance().backward2dPlan(nsams, true, m_flag, threadCount(nsams));
+  }
+  return m_backwardInPlacePlans[nsams];
+}
+
+//**********************************************************************
+
+Fw2dFFT::FloatPlan Fw2dFFT::forwardFloatInPlacePlan(const IndexArray& nsams) {
+  return FftwPlanCache<float>::instance().forward2dPlan(nsams, true, m_flag, threadCount(nsams));
+}
+
+//**********************************************************************
+
+Fw2dFFT::FloatPlan Fw2dFFT::backwardFloatInPlacePlan(const IndexArray& nsams) {
+  return FftwPlanCache<float>::instance().backward2dPlan(nsams, true, m_flag, threadCount(nsams));
+}
+
+//**********************************************************************
+
 int Fw2dFFT::
 fftForward(const Data& dat, DFT& dft, Index logLevel) {
   const string myname = "Fw2dFFT::fftForward: ";
@@ -111,7 +149,7 @@ fftForward(const Data& dat, DFT& dft, Index logLevel) {
     cout << myname << "ERROR: Copy of input data failed." << endl;
     return 4;
   }
-  fftw_execute(plan);
+  fftw_execute_dft_r2c(plan, m_inData, fftwOutData());
   dft.reset(nsams);
   for ( Index idat=0; idat<ndatOut; ++idat ) dft.floatData()[idat] = nfac*floatOutData()[idat];
   return 0;
@@ -145,9 +183,123 @@ fftBackward(const DFT& dft, Data& dat, Index logLevel) {
                dft.normalization().isBin()        ? 1.0             : 0.0;
   Plan& plan = backwardPlan(nsams);
   for ( Index idat=0; idat<ndatOut; ++idat ) floatOutData()[idat] = nfac*dft.floatData()[idat];
-  fftw_execute(plan);
+  fftw_execute_dft_c2r(plan, fftwOutData(), m_inData);
   dat.copyDataIn(m_inData);
   return 0;
 }
 
 //**********************************************************************
+
+int Fw2dFFT::fftForward(Buffer& buf, Norm norm, Index logLevel) {
+  return transformInPlace(buf, true, norm, logLevel);
+}
+
+//**********************************************************************
+
+int Fw2dFFT::fftBackward(Buffer& buf, Norm norm, Index logLevel) {
+  return transformInPlace(buf, false, norm, logLevel);
+}
+
+//**********************************************************************
+
+int Fw2dFFT::fftForward(FloatBuffer& buf, Norm norm, Index logLevel) {
+  return transformInPlace(buf, true, norm, logLevel);
+}
+
+//**********************************************************************
+
+int Fw2dFFT::fftBackward(FloatBuffer& buf, Norm norm, Index logLevel) {
+  return transformInPlace(buf, false, norm, logLevel);
+}
+
+//**********************************************************************
+
+int Fw2dFFT::fftFilter(Buffer& buf, const ComplexVector& filter, Index logLevel) {
+  return filterInPlace(buf, filter, logLevel);
+}
+
+//**********************************************************************
+
+int Fw2dFFT::fftFilter(FloatBuffer& buf, const FloatComplexVector& filter, Index logLevel) {
+  return filterInPlace(buf, filter, logLevel);
+}
+
+//**********************************************************************
+
+template<typename F>
+int Fw2dFFT::transformInPlace(Tpc2dRoiFftwBuffer<F>& buf, bool fwd, Norm norm, Index logLevel) {
+  const string myname = fwd ? "Fw2dFFT::fftForward: " : "Fw2dFFT::fftBackward: ";
+  using Traits = FftwTraits<F>;
+  if ( buf.isDft() == fwd ) return 1;
+  const IndexArray& nsams = buf.nSamples();
+  if ( nsams[0] == 0 || nsams[1] == 0 ) {
+    if ( logLevel ) cout << myname << "Buffer has no data." << endl;
+    return 2;
+  }
+  if ( norm.isPower() ) {
+    cout << myname << "ERROR: Power normalization is not (yet) supported." << endl;
+    return 3;
+  }
+  auto plan = inPlacePlan(fwd, nsams, buf.data());
+  if ( plan == nullptr ) {
+    cout << myname << "ERROR: Unable to create plan." << endl;
+    return 4;
+  }
+  F fndat = F(nsams[0])*nsams[1];
+  F nfac = 1.0;
+  if ( norm.isConsistent() ) nfac = 1.0/sqrt(fndat);
+  else if ( norm.isStandard() && ! fwd ) nfac = 1.0/fndat;
+  else if ( norm.isBin() && fwd ) nfac = 1.0/fndat;
+  typename Tpc2dRoiFftwBuffer<F>::Size ndat;
+  if ( fwd ) {
+    Traits::executeR2c(plan, buf.data(), buf.fftwData());
+    ndat = 2*buf.complexSize();
+  } else {
+    Traits::executeC2r(plan, buf.fftwData(), buf.data());
+    ndat = buf.floatSize(nsams);
+  }
+  buf.setDft(fwd);
+  if ( nfac != 1.0 ) {
+    F* pdat = buf.data();
+    for ( typename Tpc2dRoiFftwBuffer<F>::Size idat=0; idat<ndat; ++idat ) pdat[idat] *= nfac;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+template<typename F>
+int Fw2dFFT::filterInPlace(Tpc2dRoiFftwBuffer<F>& buf, const std::vector<std::complex<F>>& filter, Index logLevel) {
+  const string myname = "Fw2dFFT::fftFilter: ";
+  using Traits = FftwTraits<F>;
+  using Complex = std::complex<F>;
+  if ( buf.isDft() ) return 1;
+  const IndexArray& nsams = buf.nSamples();
+  if ( nsams[0] == 0 || nsams[1] == 0 ) {
+    if ( logLevel ) cout << myname << "Buffer has no data." << endl;
+    return 2;
+  }
+  Index ncmp = buf.complexSize();
+  if ( filter.size() != ncmp ) {
+    cout << myname << "ERROR: Filter size " << filter.size() << " does not match DFT size "
+         << ncmp << "." << endl;
+    return 3;
+  }
+  auto fplan = inPlacePlan(true, nsams, buf.data());
+  auto bplan = inPlacePlan(false, nsams, buf.data());
+  if ( fplan == nullptr || bplan == nullptr ) {
+    cout << myname << "ERROR: Unable to create plan." << endl;
+    return 4;
+  }
+  // Unnormalized transforms so the round trip gives a factor of the sample count.
+  F nfac = 1.0/(F(nsams[0])*nsams[1]);
+  Traits::executeR2c(fplan, buf.data(), buf.fftwData());
+  Complex* pcmp = buf.complexData();
+  const Complex* pfil = filter.data();
+  for ( Index icmp=0; icmp<ncmp; ++icmp ) pcmp[icmp] *= nfac*pfil[icmp];
+  Traits::executeC2r(bplan, buf.fftwData(), buf.data());
+  buf.setDft(false);
+  return 0;
+}
+
+//**********************************************************************
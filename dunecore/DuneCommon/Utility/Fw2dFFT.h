@@ -8,7 +8,8 @@
 //
 // Separate forward and backward FFTW plans are created for each array of data dimensions.
 // These may be created in advance by calling fowardPlan or backwardPlan or are created
-// in the first call to perform an FFT with that set of dimentsions.
+// in the first call to perform an FFT with that set of dimentsions. The plans are held
+// in FftwPlanCache and so are shared by all instances.
 //
 // Space to hold the transformation data is allocated in the constructor. Use
 // checkDataSize to check if the space is sufficient for given data dimensions.
@@ -19,13 +20,30 @@
 //
 // The concrete type for the returned data is
 //   FftwReal2dDftData<double>
+//
+// Data held in a Tpc2dRoiBuffer may instead be transformed in place, avoiding
+// the copies to and from the internal arrays and the DFT object. Separate
+// in-place plans are used for these. A Tpc2dRoiFloatBuffer is transformed in
+// single precision (fftwf) with half the memory traffic. The in-place transforms
+// do not use the internal arrays and so are not limited by the maximum data size.
+//
+// fftFilter transforms a buffer, multiplies by a 2D filter and transforms back
+// with the normalization folded into the filter multiplication, i.e. with one
+// pass over the DFT in addition to the two transforms.
+//
+// For large arrays (e.g. a full wire plane), the 2D plans may use multiple
+// threads. The thread count nthread is given in the constructor and is used
+// for arrays with at least threadMinSize() samples.
 
 #ifndef Fw2dFFT_H
 #define Fw2dFFT_H
 
 #include "dunecore/DuneInterface/Data/Real2dData.h"
 #include "dunecore/DuneInterface/Data/FftwReal2dDftData.h"
+#include "dunecore/DuneInterface/Data/Tpc2dRoiBuffer.h"
 #include <map>
+#include <vector>
+#include <complex>
 
 class Fw2dFFT {
 
@@ -38,7 +56,13 @@ public:
   using Index = DFT::Index;
   using IndexArray = DFT::IndexArray;
   using Complex = DFT::Complex;
+  using Norm = DFT::Norm;
+  using Buffer = Tpc2dRoiBuffer;
+  using FloatBuffer = Tpc2dRoiFloatBuffer;
+  using ComplexVector = std::vector<std::complex<double>>;
+  using FloatComplexVector = std::vector<std::complex<float>>;
   using Plan = fftw_plan;
+  using FloatPlan = fftwf_plan;
   using PlanMap = std::map<IndexArray, Plan>;
   typedef double FftwComplex[2];
 
@@ -46,9 +70,10 @@ public:
   // For n1xn2 data, ndat must be at least as big as n1*n2 and 2*n1*(n2/2+1)
   // opt = 0-2 (FFTW_ESTIMATE, FFTW_PLAN, FFTW_PATIENT)
   //       Larger numbers take longer to build plans but are faster for each transform.
-  Fw2dFFT(Index ndatMax, Index opt);
+  // nthread = # threads used in transforming large arrays.
+  Fw2dFFT(Index ndatMax, Index opt, Index nthread =1);
 
-  // Dtor. Frees the data caches and destroys the plans.
+  // Dtor. Frees the data caches. The plans are owned by FftwPlanCache.
   ~Fw2dFFT();
 
   // Check an array of sample sizes.
@@ -58,6 +83,10 @@ public:
   //   3 - One or more dimensions has size zero.
   Index checkDataSize(const IndexArray& nsams) const;
 
+  // Return the number of threads used for the transforms of an array.
+  static Index threadMinSize() { return 65536; }
+  Index threadCount(const IndexArray& nsams) const;
+
   // Return if we have  plan for given data sizes.
   bool haveForwardPlan(const IndexArray& nsams) const;
   bool haveBackwardPlan(const IndexArray& nsams) const;
@@ -67,6 +96,13 @@ public:
   Plan& forwardPlan(const IndexArray& nsams);
   Plan& backwardPlan(const IndexArray& nsams);
 
+  // Return the in-place plan for a data size.
+  // The plan is created if not already existing.
+  Plan& forwardInPlacePlan(const IndexArray& nsams);
+  Plan& backwardInPlacePlan(const IndexArray& nsams);
+  FloatPlan forwardFloatInPlacePlan(const IndexArray& nsams);
+  FloatPlan backwardFloatInPlacePlan(const IndexArray& nsams);
+
   // Forward transform: real data (ntick starting at psam[0] --> complex freqs).
   //   psam - Address of the first element in input the data array
   //   dft - Output DFT data. Dimension sizes are obtained from this.
@@ -79,6 +115,25 @@ public:
   // Returns 0 for success.
   int fftBackward(const DFT& dft, Data& dat, Index logLevel =0);
 
+  // In-place transforms of the data in a buffer.
+  // Forward requires the buffer to hold real data and leaves the DFT.
+  // Backward requires the DFT and leaves real data.
+  // The normalization is applied as in the above methods.
+  // Returns 0 for success.
+  int fftForward(Buffer& buf, Norm norm, Index logLevel =0);
+  int fftBackward(Buffer& buf, Norm norm, Index logLevel =0);
+  int fftForward(FloatBuffer& buf, Norm norm, Index logLevel =0);
+  int fftBackward(FloatBuffer& buf, Norm norm, Index logLevel =0);
+
+  // Filter the real data in a buffer: forward transform, multiply each DFT term
+  // by the corresponding filter term and transform back. The filter has the
+  // layout of the buffer DFT (buf.complexSize() terms) and is the DFT of the
+  // kernel in standard normalization (unnormalized forward transform), i.e. the
+  // filter for a unit delta kernel is one everywhere and leaves the data unchanged.
+  // Returns 0 for success.
+  int fftFilter(Buffer& buf, const ComplexVector& filter, Index logLevel =0);
+  int fftFilter(FloatBuffer& buf, const FloatComplexVector& filter, Index logLevel =0);
+
   // Return the DFT data as FFTW complex.
   FftwComplex* fftwOutData() { return reinterpret_cast<FftwComplex*>(m_outData); }
 
@@ -87,12 +142,29 @@ public:
 
 private:
 
+  // Return the in-place plan for the buffer precision.
+  Plan inPlacePlan(bool fwd, const IndexArray& nsams, double*) {
+    return fwd ? forwardInPlacePlan(nsams) : backwardInPlacePlan(nsams);
+  }
+  FloatPlan inPlacePlan(bool fwd, const IndexArray& nsams, float*) {
+    return fwd ? forwardFloatInPlacePlan(nsams) : backwardFloatInPlacePlan(nsams);
+  }
+
+  // Implementation of the in-place transforms for either precision.
+  template<typename F>
+  int transformInPlace(Tpc2dRoiFftwBuffer<F>& buf, bool fwd, Norm norm, Index logLevel);
+  template<typename F>
+  int filterInPlace(Tpc2dRoiFftwBuffer<F>& buf, const std::vector<std::complex<F>>& filter, Index logLevel);
+
   Index m_ndatMax;
   Index m_flag;
+  Index m_nthread;
   DftFloat* m_inData;
   Complex* m_outData;
   PlanMap m_forwardPlans;
   PlanMap m_backwardPlans;
+  PlanMap m_forwardInPlacePlans;
+  PlanMap m_backwardInPlacePlans;
 
 };
 
@@ -0,0 +1,286 @@
+// FwBatchFFT.cxx
+#include "FwBatchFFT.h"
+#include "FftwPlanCache.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+//**********************************************************************
+// Class methods.
+//**********************************************************************
+
+template<typename F>
+FwBatchFFT<F>::FwBatchFFT(Index opt, Index nchaBatch)
+: m_flag(FftwPlanCache<F>::flag(opt)),
+  m_nchaBatch(nchaBatch) { }
+
+//**********************************************************************
+
+template<typename F>
+FwBatchFFT<F>::~FwBatchFFT() {
+  Traits::free(m_inData);
+  Traits::free(m_outData);
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FwBatchFFT<F>::Plan FwBatchFFT<F>::forwardPlan(Index nsam, Index ncha) {
+  PlanKey key(nsam, ncha);
+  typename PlanMap::const_iterator iplan = m_forwardPlans.find(key);
+  if ( iplan != m_forwardPlans.end() ) return iplan->second;
+  Plan plan = FftwPlanCache<F>::instance().forwardPlan(nsam, ncha, m_flag);
+  if ( plan != nullptr ) m_forwardPlans[key] = plan;
+  return plan;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename FwBatchFFT<F>::Plan FwBatchFFT<F>::backwardPlan(Index nsam, Index ncha) {
+  PlanKey key(nsam, ncha);
+  typename PlanMap::const_iterator iplan = m_backwardPlans.find(key);
+  if ( iplan != m_backwardPlans.end() ) return iplan->second;
+  Plan plan = FftwPlanCache<F>::instance().backwardPlan(nsam, ncha, m_flag);
+  if ( plan != nullptr ) m_backwardPlans[key] = plan;
+  return plan;
+}
+
+//**********************************************************************
+
+template<typename F>
+int FwBatchFFT<F>::
+fftForward(Index nsam, Index ncha, const float* psam, Norm norm,
+           ComplexVector& dfts, Index logLevel) {
+  Index ncmp = nComplex(nsam);
+  dfts.resize(Size(ncha)*ncmp);
+  if ( dfts.empty() ) return 0;
+  F nfac = globalFactor(norm, nsam);
+  auto src = [psam, nsam](Index icha) { return psam + Size(icha)*nsam; };
+  auto dst = [&dfts, ncmp, nfac](Index icha, const Complex* pdft) {
+    Complex* pout = dfts.data() + Size(icha)*ncmp;
+    for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) pout[ifrq] = nfac*pdft[ifrq];
+  };
+  return transformForward(nsam, ncha, src, dst, logLevel);
+}
+
+//**********************************************************************
+
+template<typename F>
+int FwBatchFFT<F>::
+fftForward(Index nsam, Index ncha, const float* psam, Norm norm,
+           DftVector& dfts, Index logLevel) {
+  dfts.clear();
+  dfts.resize(ncha, DFT(norm));
+  if ( nsam == 0 ) return 0;
+  auto src = [psam, nsam](Index icha) { return psam + Size(icha)*nsam; };
+  auto dst = [&dfts, nsam, norm](Index icha, const Complex* pdft) {
+    FloatVector amps;
+    FloatVector phas;
+    compact(nsam, pdft, norm, amps, phas);
+    dfts[icha].moveIn(amps, phas);
+  };
+  return transformForward(nsam, ncha, src, dst, logLevel);
+}
+
+//**********************************************************************
+
+template<typename F>
+int FwBatchFFT<F>::
+fftBackward(Index nsam, const ComplexVector& dfts, Norm norm,
+            FloatVector& sams, Index logLevel) {
+  const string myname = "FwBatchFFT::fftBackward: ";
+  Index ncmp = nComplex(nsam);
+  if ( ncmp == 0 ) {
+    sams.clear();
+    return dfts.empty() ? 0 : 1;
+  }
+  if ( dfts.size() % ncmp ) {
+    cout << myname << "DFT size " << dfts.size() << " is not a multiple of "
+         << ncmp << endl;
+    return 1;
+  }
+  Index ncha = dfts.size()/ncmp;
+  sams.resize(Size(ncha)*nsam);
+  double nfac = 1.0/(nsam*globalFactor(norm, nsam));
+  Index nbat = m_nchaBatch ? m_nchaBatch : ncha;
+  for ( Index icha0=0; icha0<ncha; icha0+=nbat ) {
+    Index nc = std::min(nbat, ncha - icha0);
+    Plan plan = backwardPlan(nsam, nc);
+    if ( plan == nullptr ) {
+      cout << myname << "Unable to create plan for " << nc << " x " << nsam << endl;
+      return 2;
+    }
+    reserve(nsam, nc);
+    const Complex* pin = dfts.data() + Size(icha0)*ncmp;
+    std::copy(pin, pin + Size(nc)*ncmp, reinterpret_cast<Complex*>(m_outData));
+    Traits::executeC2r(plan, m_outData, m_inData);
+    float* pout = sams.data() + Size(icha0)*nsam;
+    Size nval = Size(nc)*nsam;
+    for ( Size ival=0; ival<nval; ++ival ) pout[ival] = nfac*m_inData[ival];
+    if ( logLevel >= 2 ) {
+      cout << myname << "Transformed channels " << icha0 << "-" << icha0 + nc - 1
+           << " with " << nsam << " samples." << endl;
+    }
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+template<typename F>
+int FwBatchFFT<F>::
+fftForward(const AdcChannelDataMap& acds, Norm norm, ComplexVector& dfts,
+           Index& nsam, Index logLevel) {
+  const string myname = "FwBatchFFT::fftForward: ";
+  dfts.clear();
+  nsam = acds.size() ? acds.begin()->second.sampleCount() : 0;
+  std::vector<const AdcChannelData*> pacds;
+  pacds.reserve(acds.size());
+  for ( const auto& iacd : acds ) {
+    const AdcChannelData& acd = iacd.second;
+    if ( acd.sampleCount() != nsam ) {
+      cout << myname << "Channel " << acd.channel() << " has " << acd.sampleCount()
+           << " samples. Expected " << nsam << "." << endl;
+      return 1;
+    }
+    pacds.push_back(&acd);
+  }
+  Index ncha = pacds.size();
+  Index ncmp = nComplex(nsam);
+  dfts.resize(Size(ncha)*ncmp);
+  if ( dfts.empty() ) return 0;
+  F nfac = globalFactor(norm, nsam);
+  auto src = [&pacds](Index icha) { return pacds[icha]->sampleData(); };
+  auto dst = [&dfts, ncmp, nfac](Index icha, const Complex* pdft) {
+    Complex* pout = dfts.data() + Size(icha)*ncmp;
+    for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) pout[ifrq] = nfac*pdft[ifrq];
+  };
+  return transformForward(nsam, ncha, src, dst, logLevel);
+}
+
+//**********************************************************************
+
+template<typename F>
+int FwBatchFFT<F>::updateDft(AdcChannelDataMap& acds, Index logLevel) {
+  Norm norm(AdcChannelData::dftNormalization());
+  // Group the channels by sample count.
+  std::map<Index, std::vector<AdcChannelData*>> groups;
+  for ( auto& iacd : acds ) {
+    AdcChannelData& acd = iacd.second;
+    Index nsam = acd.sampleCount();
+    if ( nsam == 0 ) {
+      acd.dftmags.clear();
+      acd.dftphases.clear();
+      continue;
+    }
+    groups[nsam].push_back(&acd);
+  }
+  for ( auto& igrp : groups ) {
+    Index nsam = igrp.first;
+    std::vector<AdcChannelData*>& pacds = igrp.second;
+    auto src = [&pacds](Index icha) { return pacds[icha]->sampleData(); };
+    auto dst = [&pacds, nsam, norm](Index icha, const Complex* pdft) {
+      AdcChannelData& acd = *pacds[icha];
+      compact(nsam, pdft, norm, acd.dftmags, acd.dftphases);
+    };
+    int rstat = transformForward(nsam, pacds.size(), src, dst, logLevel);
+    if ( rstat ) return rstat;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+template<typename F>
+void FwBatchFFT<F>::
+compact(Index nsam, const Complex* pdft, Norm norm, FloatVector& amps, FloatVector& phas) {
+  Index namp = nComplex(nsam);
+  Index npha = (nsam + 1)/2;
+  amps.resize(namp);
+  phas.resize(npha);
+  double nfac = globalFactor(norm, nsam);
+  double afac = norm.isPower() ? nfac*sqrt(2.0) : nfac;
+  for ( Index ifrq=0; ifrq<npha; ++ifrq ) {
+    double xre = pdft[ifrq].real();
+    double xim = pdft[ifrq].imag();
+    // Terms other than zero and Nyquist are aliased.
+    double fac = ifrq ? afac : nfac;
+    amps[ifrq] = fac*sqrt(xre*xre + xim*xim);
+    phas[ifrq] = atan2(xim, xre);
+  }
+  // For an even # samples, the Nyquist term is real and we store the sign
+  // with the amplitude.
+  if ( namp > npha ) amps[npha] = nfac*pdft[npha].real();
+}
+
+//**********************************************************************
+
+template<typename F>
+template<class Source, class Sink>
+int FwBatchFFT<F>::
+transformForward(Index nsam, Index ncha, Source src, Sink dst, Index logLevel) {
+  const string myname = "FwBatchFFT::transformForward: ";
+  Index ncmp = nComplex(nsam);
+  Index nbat = m_nchaBatch ? m_nchaBatch : ncha;
+  for ( Index icha0=0; icha0<ncha; icha0+=nbat ) {
+    Index nc = std::min(nbat, ncha - icha0);
+    Plan plan = forwardPlan(nsam, nc);
+    if ( plan == nullptr ) {
+      cout << myname << "Unable to create plan for " << nc << " x " << nsam << endl;
+      return 2;
+    }
+    reserve(nsam, nc);
+    for ( Index jcha=0; jcha<nc; ++jcha ) {
+      const float* pin = src(icha0 + jcha);
+      F* pout = m_inData + Size(jcha)*nsam;
+      for ( Index isam=0; isam<nsam; ++isam ) pout[isam] = pin[isam];
+    }
+    Traits::executeR2c(plan, m_inData, m_outData);
+    const Complex* pdfts = reinterpret_cast<const Complex*>(m_outData);
+    for ( Index jcha=0; jcha<nc; ++jcha ) dst(icha0 + jcha, pdfts + Size(jcha)*ncmp);
+    if ( logLevel >= 2 ) {
+      cout << myname << "Transformed channels " << icha0 << "-" << icha0 + nc - 1
+           << " with " << nsam << " samples (" << Traits::name() << ")." << endl;
+    }
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+template<typename F>
+double FwBatchFFT<F>::globalFactor(Norm norm, Index nsam) {
+  if ( norm.isConsistent() ) return 1.0/sqrt(nsam);
+  if ( norm.isBin() ) return 1.0/nsam;
+  return 1.0;
+}
+
+//**********************************************************************
+
+template<typename F>
+void FwBatchFFT<F>::reserve(Index nsam, Index ncha) {
+  Size nin = Size(nsam)*ncha;
+  Size nout = Size(nComplex(nsam))*ncha;
+  if ( nin > m_inSize ) {
+    Traits::free(m_inData);
+    m_inData = Traits::allocReal(nin);
+    m_inSize = nin;
+  }
+  if ( nout > m_outSize ) {
+    Traits::free(m_outData);
+    m_outData = Traits::allocComplex(nout);
+    m_outSize = nout;
+  }
+}
+
+//**********************************************************************
+
+template class FwBatchFFT<double>;
+template class FwBatchFFT<float>;
+
+//**********************************************************************
@@ -0,0 +1,145 @@
+// FwBatchFFT.h
+//
+// Batched forward and backward DFT of many channels of real (time-domain)
+// data using FFTW.
+//
+// Where FwFFT transforms one channel per plan execution, this class builds
+// a single FFTW "many" plan for a block of ncha channels of nsam samples
+// each and transforms the whole block in one execution. The input is either
+// a contiguous channel-major block of floats (channel icha starts at
+// psam[icha*nsam]) or an AdcChannelDataMap.
+//
+// The template parameter selects the precision of the transform:
+//   FwBatchFFT<double> - fftw_... plans
+//   FwBatchFFT<float>  - fftwf_... plans, about twice as fast and with half
+//                        the memory; sufficient for noise spectra and filters.
+//
+// The DFT may be returned in complex form, i.e. ncha blocks of nsam/2 + 1
+// complex values, which avoids the amplitude/phase conversion, or as
+// CompactRealDftData<float> objects (as returned by FwFFT). The complex
+// values include the global normalization but not the term normalization
+// (i.e. they are those for term normalization unit).
+//
+// The map interface transforms channels with the same sample count together.
+// Method updateDft fills the dftmags and dftphases of each channel in the
+// normalization used by AdcChannelData.
+//
+// If nchaBatch is nonzero, at most that many channels are transformed in each
+// plan execution to limit the size of the work buffers.
+//
+// Plans for each (nsam, ncha) are taken from FftwPlanCache and executed on the
+// work buffers with the FFTW new-array interface so the buffers may grow. As
+// with FwFFT, an object should be used by only one thread at a time.
+
+#ifndef FwBatchFFT_H
+#define FwBatchFFT_H
+
+#include "dunecore/DuneCommon/Utility/CompactRealDftData.h"
+#include "dunecore/DuneCommon/Utility/FftwTraits.h"
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include <complex>
+#include <vector>
+#include <map>
+#include <utility>
+#include <cstddef>
+
+template<typename F>
+class FwBatchFFT {
+
+public:
+
+  using Index = unsigned int;
+  using Size = std::size_t;
+  using Float = F;
+  using Traits = FftwTraits<F>;
+  using Complex = std::complex<F>;      // same memory layout as fftw_complex
+  using ComplexVector = std::vector<Complex>;
+  using FloatVector = std::vector<float>;
+  using DFT = CompactRealDftData<float>;
+  using DftVector = std::vector<DFT>;
+  using Norm = RealDftNormalization;
+  using Plan = typename Traits::Plan;
+  using PlanKey = std::pair<Index, Index>;   // (nsam, ncha)
+  using PlanMap = std::map<PlanKey, Plan>;
+
+  // Ctor from optimization and batch size.
+  // opt = 0-2 (FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT)
+  // nchaBatch = maximum # channels in one plan execution (0 for no limit)
+  explicit FwBatchFFT(Index opt, Index nchaBatch =0);
+
+  // Dtor. Frees the work buffers. The plans are owned by FftwPlanCache.
+  ~FwBatchFFT();
+
+  // No copy.
+  FwBatchFFT(const FwBatchFFT&) =delete;
+  FwBatchFFT& operator=(const FwBatchFFT&) =delete;
+
+  // Return the plan for ncha channels of nsam samples.
+  // The plan is taken from the shared cache, where it is created if not already existing.
+  Plan forwardPlan(Index nsam, Index ncha);
+  Plan backwardPlan(Index nsam, Index ncha);
+
+  // Return the number of complex DFT values per channel.
+  static Index nComplex(Index nsam) { return nsam ? nsam/2 + 1 : 0; }
+
+  // Forward transform of a channel-major block to complex DFTs.
+  //   nsam - # samples in each channel
+  //   ncha - # channels
+  //   psam - address of the first sample of the first channel
+  //   norm - DFT normalization
+  //   dfts - output: ncha*nComplex(nsam) complex values, channel-major
+  int fftForward(Index nsam, Index ncha, const float* psam, Norm norm,
+                 ComplexVector& dfts, Index logLevel =0);
+
+  // Forward transform of a channel-major block to one DFT object per channel.
+  int fftForward(Index nsam, Index ncha, const float* psam, Norm norm,
+                 DftVector& dfts, Index logLevel =0);
+
+  // Backward transform of complex DFTs to a channel-major block.
+  // The DFTs must have the same global normalization used in the forward transform.
+  //   nsam - # samples in each channel
+  //   dfts - ncha*nComplex(nsam) complex values
+  //   sams - output: ncha*nsam samples
+  int fftBackward(Index nsam, const ComplexVector& dfts, Norm norm,
+                  FloatVector& sams, Index logLevel =0);
+
+  // Forward transform of the samples in a channel map to complex DFTs.
+  // All channels must have the same sample count, which is returned in nsam.
+  // The channel order in dfts is that of the map.
+  int fftForward(const AdcChannelDataMap& acds, Norm norm, ComplexVector& dfts,
+                 Index& nsam, Index logLevel =0);
+
+  // Fill dftmags and dftphases for each channel in a map.
+  // Channels without samples have their DFT cleared.
+  int updateDft(AdcChannelDataMap& acds, Index logLevel =0);
+
+private:
+
+  // Convert the unnormalized complex DFT for one channel to amplitudes and
+  // phases with normalization norm.
+  static void compact(Index nsam, const Complex* pdft, Norm norm,
+                      FloatVector& amps, FloatVector& phas);
+
+  // Forward transform ncha channels with the samples for channel icha
+  // at src(icha). The DFT for icha is passed to dst(icha, pdft).
+  template<class Source, class Sink>
+  int transformForward(Index nsam, Index ncha, Source src, Sink dst, Index logLevel);
+
+  // Factor applied to the transform for global normalization.
+  static double globalFactor(Norm norm, Index nsam);
+
+  // Ensure the work buffers have space for ncha channels of nsam samples.
+  void reserve(Index nsam, Index ncha);
+
+  Index m_flag;
+  Index m_nchaBatch;
+  F* m_inData =nullptr;
+  typename Traits::Complex* m_outData =nullptr;
+  Size m_inSize =0;
+  Size m_outSize =0;
+  PlanMap m_forwardPlans;
+  PlanMap m_backwardPlans;
+
+};
+
+#endif
@@ -0,0 +1,265 @@
+// FwCorrelator.cxx
+
+#include "FwCorrelator.h"
+#include "dunecore/DuneCommon/Utility/FftwPlanCache.h"
+#include "tbb/parallel_for.h"
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <iostream>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+using Index = FwCorrelator::Index;
+using Size = FwCorrelator::Size;
+using IndexVector = FwCorrelator::IndexVector;
+using FloatVector = FwCorrelator::FloatVector;
+using Complex = FwCorrelator::Complex;
+using ComplexVector = FwCorrelator::ComplexVector;
+using Batch = FwCorrelator::Batch;
+using Norm = RealDftNormalization;
+
+namespace {
+
+// Standard normalization: the backward transform of the product is the correlation.
+const Norm corNorm(11);
+
+}  // end unnamed namespace
+
+//**********************************************************************
+
+template<class Func>
+void FwCorrelator::run(Index nblk, Func func) const {
+  if ( m_parallel && nblk > 1 ) {
+    tbb::parallel_for(Index(0), nblk, func);
+  } else {
+    for ( Index iblk=0; iblk<nblk; ++iblk ) func(iblk);
+  }
+}
+
+//**********************************************************************
+
+FwCorrelator::
+FwCorrelator(Index nsam, Index maxLag, bool normalize, bool parallel, Index opt)
+: m_nsam(nsam),
+  m_maxLag(nsam ? std::min(maxLag, nsam - 1) : 0),
+  m_normalize(normalize),
+  m_parallel(parallel),
+  m_opt(opt),
+  m_nfft(nsam ? FftwPlanCache<float>::goodSize(nsam + m_maxLag) : 0) { }
+
+//**********************************************************************
+
+int FwCorrelator::setReference(const float* pref, Index nref) {
+  const string myname = "FwCorrelator::setReference: ";
+  m_refDft.clear();
+  m_refNorm = 0.0;
+  if ( pref == nullptr || nref == 0 || nref > m_nsam ) {
+    cout << myname << "Invalid reference length " << nref << " for sample count " << m_nsam << endl;
+    return 1;
+  }
+  Batch xf(m_opt);
+  FloatVector buf;
+  float norm = 0.0;
+  if ( transform(xf, 1, nref, pref, buf, m_refDft, &norm) ) {
+    m_refDft.clear();
+    return 2;
+  }
+  m_refNorm = norm;
+  return 0;
+}
+
+//**********************************************************************
+
+int FwCorrelator::correlate(Index ncha, const float* psam, FloatVector& cors) const {
+  const string myname = "FwCorrelator::correlate: ";
+  cors.clear();
+  if ( ! haveReference() ) {
+    cout << myname << "Reference is not set." << endl;
+    return 1;
+  }
+  if ( ncha == 0 ) return 0;
+  if ( psam == nullptr ) return 2;
+  Index nlag = nLag();
+  Index ncmp = Batch::nComplex(m_nfft);
+  cors.resize(Size(ncha)*nlag);
+  Index nblk = (ncha + blockSize() - 1)/blockSize();
+  std::vector<int> stats(nblk, 0);
+  run(nblk, [this, ncha, psam, &cors, &stats, nlag, ncmp](Index iblk) {
+    Index icha0 = iblk*blockSize();
+    Index nc = std::min(blockSize(), ncha - icha0);
+    Batch xf(m_opt);
+    FloatVector buf;
+    ComplexVector dfts;
+    FloatVector norms(nc);
+    if ( transform(xf, nc, m_nsam, psam + Size(icha0)*m_nsam, buf, dfts, norms.data()) ) {
+      stats[iblk] = 1;
+      return;
+    }
+    const Complex* pref = m_refDft.data();
+    for ( Index kcha=0; kcha<nc; ++kcha ) {
+      Complex* pdft = dfts.data() + Size(kcha)*ncmp;
+      for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) pdft[ifrq] *= std::conj(pref[ifrq]);
+    }
+    if ( xf.fftBackward(m_nfft, dfts, corNorm, buf) ) {
+      stats[iblk] = 2;
+      return;
+    }
+    for ( Index kcha=0; kcha<nc; ++kcha ) {
+      float den = m_refNorm*norms[kcha];
+      float scale = m_normalize ? (den > 0.0 ? 1.0/den : 0.0) : 1.0;
+      extract(buf.data() + Size(kcha)*m_nfft, scale, cors.data() + Size(icha0 + kcha)*nlag);
+    }
+  });
+  for ( int stat : stats ) {
+    if ( stat ) {
+      cout << myname << "Transform failed." << endl;
+      cors.clear();
+      return 3;
+    }
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+int FwCorrelator::
+correlatePairs(const IndexVector& chans, const float* psam, CorrelationMatrix& cmat) const {
+  const string myname = "FwCorrelator::correlatePairs: ";
+  Index ncha = chans.size();
+  cmat.reset(chans, m_maxLag);
+  if ( ncha == 0 ) return 0;
+  if ( psam == nullptr || m_nsam == 0 ) return 1;
+  Index nlag = nLag();
+  Index ncmp = Batch::nComplex(m_nfft);
+  // Evaluate the DFT of each channel once.
+  ComplexVector dfts(Size(ncha)*ncmp);
+  FloatVector norms(ncha);
+  Index nblk = (ncha + blockSize() - 1)/blockSize();
+  std::vector<int> stats(nblk, 0);
+  run(nblk, [this, ncha, psam, &dfts, &norms, &stats, ncmp](Index iblk) {
+    Index icha0 = iblk*blockSize();
+    Index nc = std::min(blockSize(), ncha - icha0);
+    Batch xf(m_opt);
+    FloatVector buf;
+    ComplexVector blkDfts;
+    if ( transform(xf, nc, m_nsam, psam + Size(icha0)*m_nsam, buf, blkDfts, &norms[icha0]) ) {
+      stats[iblk] = 1;
+      return;
+    }
+    std::copy(blkDfts.begin(), blkDfts.end(), dfts.begin() + Size(icha0)*ncmp);
+  });
+  for ( int stat : stats ) {
+    if ( stat ) {
+      cout << myname << "Forward transform failed." << endl;
+      return 2;
+    }
+  }
+  // Correlate each pair (icha <= jcha) from the shared DFTs.
+  std::vector<std::pair<Index, Index>> pairs;
+  pairs.reserve(Size(ncha)*(ncha + 1)/2);
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    for ( Index jcha=icha; jcha<ncha; ++jcha ) pairs.emplace_back(icha, jcha);
+  }
+  Index npair = pairs.size();
+  nblk = (npair + blockSize() - 1)/blockSize();
+  stats.assign(nblk, 0);
+  run(nblk, [this, npair, &pairs, &dfts, &norms, &cmat, &stats, nlag, ncmp](Index iblk) {
+    Index ipair0 = iblk*blockSize();
+    Index np = std::min(blockSize(), npair - ipair0);
+    ComplexVector prods(Size(np)*ncmp);
+    for ( Index kpair=0; kpair<np; ++kpair ) {
+      const Complex* pa = dfts.data() + Size(pairs[ipair0 + kpair].first)*ncmp;
+      const Complex* pb = dfts.data() + Size(pairs[ipair0 + kpair].second)*ncmp;
+      Complex* pout = prods.data() + Size(kpair)*ncmp;
+      for ( Index ifrq=0; ifrq<ncmp; ++ifrq ) pout[ifrq] = std::conj(pa[ifrq])*pb[ifrq];
+    }
+    Batch xf(m_opt);
+    FloatVector buf;
+    if ( xf.fftBackward(m_nfft, prods, corNorm, buf) ) {
+      stats[iblk] = 1;
+      return;
+    }
+    FloatVector cors(nlag);
+    for ( Index kpair=0; kpair<np; ++kpair ) {
+      Index icha = pairs[ipair0 + kpair].first;
+      Index jcha = pairs[ipair0 + kpair].second;
+      float den = norms[icha]*norms[jcha];
+      float scale = m_normalize ? (den > 0.0 ? 1.0/den : 0.0) : 1.0;
+      extract(buf.data() + Size(kpair)*m_nfft, scale, cors.data());
+      Index ipeak = 0;
+      for ( Index ilag=1; ilag<nlag; ++ilag ) {
+        if ( std::fabs(cors[ilag]) > std::fabs(cors[ipeak]) ) ipeak = ilag;
+      }
+      cmat.set(icha, jcha, cors[m_maxLag], cors[ipeak], int(ipeak) - int(m_maxLag));
+    }
+  });
+  for ( int stat : stats ) {
+    if ( stat ) {
+      cout << myname << "Backward transform failed." << endl;
+      return 3;
+    }
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+int FwCorrelator::correlatePairs(const AdcChannelDataMap& acds, CorrelationMatrix& cmat) const {
+  const string myname = "FwCorrelator::correlatePairs: ";
+  IndexVector chans;
+  FloatVector sams;
+  chans.reserve(acds.size());
+  sams.reserve(acds.size()*m_nsam);
+  for ( const auto& iacd : acds ) {
+    const AdcChannelData& acd = iacd.second;
+    if ( acd.sampleCount() != m_nsam ) {
+      cout << myname << "Channel " << iacd.first << " has " << acd.sampleCount()
+           << " samples instead of " << m_nsam << "." << endl;
+      cmat.reset(IndexVector(), m_maxLag);
+      return 11;
+    }
+    chans.push_back(iacd.first);
+    sams.insert(sams.end(), acd.sampleData(), acd.sampleData() + m_nsam);
+  }
+  return correlatePairs(chans, sams.data(), cmat);
+}
+
+//**********************************************************************
+
+int FwCorrelator::transform(Batch& xf, Index ncha, Index nin, const float* psam,
+                            FloatVector& buf, ComplexVector& dfts, float* pnorms) const {
+  buf.assign(Size(ncha)*m_nfft, 0.0);
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    const float* pin = psam + Size(icha)*nin;
+    float* pout = buf.data() + Size(icha)*m_nfft;
+    float mean = 0.0;
+    if ( m_normalize ) {
+      for ( Index isam=0; isam<nin; ++isam ) mean += pin[isam];
+      mean /= nin;
+    }
+    float sumsq = 0.0;
+    for ( Index isam=0; isam<nin; ++isam ) {
+      float val = pin[isam] - mean;
+      pout[isam] = val;
+      sumsq += val*val;
+    }
+    pnorms[icha] = std::sqrt(sumsq);
+  }
+  return xf.fftForward(m_nfft, ncha, buf.data(), corNorm, dfts);
+}
+
+//**********************************************************************
+
+void FwCorrelator::extract(const float* pcor, float scale, float* pout) const {
+  // Negative lags are at the end of the circular correlation.
+  Index nneg = m_maxLag;
+  const float* pneg = pcor + m_nfft - nneg;
+  for ( Index ilag=0; ilag<nneg; ++ilag ) pout[ilag] = scale*pneg[ilag];
+  for ( Index ilag=0; ilag<=m_maxLag; ++ilag ) pout[nneg + ilag] = scale*pcor[ilag];
+}
+
+//**********************************************************************
+
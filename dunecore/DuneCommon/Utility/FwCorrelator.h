@@ -0,0 +1,125 @@
+// FwCorrelator.h
+//
+// FFT-based cross-correlation of channels with a reference (template) or of
+// all pairs of channels in a group.
+//
+// The correlation of a with b at lag l is
+//   c(l) = sum_t a[t] b[t+l]
+// for -maxLag <= l <= maxLag. Channels of nsam samples are zero-padded to a
+// length fftSize() >= nsam + maxLag with small prime factors (see
+// FftwPlanCache::goodSize) so the circular correlation from the product
+// conj(A)B of the DFTs has no wrap-around. The cost per pair is that of one
+// backward transform, i.e. O(N log N) instead of the O(N maxLag) of a direct sum.
+//
+// If normalize is true, the mean of each channel (and the reference) is
+// subtracted and the correlations are divided by the product of the norms of
+// the two mean-subtracted inputs, so they are the Pearson coefficients at zero
+// lag and bounded by 1 in magnitude at any lag.
+//
+// The DFTs are evaluated with FwBatchFFT<float>. The spectrum of the reference
+// is evaluated once in setReference and shared by all subsequent calls. For
+// the pair correlation, the spectrum of each channel is evaluated once and
+// shared by all its pairs. Channels and pairs are processed in blocks of
+// blockSize() and, if parallel is true, the blocks are processed concurrently
+// with TBB, each with its own transform buffers. The plans are shared through
+// FftwPlanCache.
+//
+// Usage:
+//   FwCorrelator cor(nsam, maxLag);
+//   cor.setReference(pulse);
+//   cor.correlate(ncha, psam, cors);   // cors[icha*cor.nLag() + ilag]
+//   CorrelationMatrix cmat;
+//   cor.correlatePairs(acds, cmat);
+//   cmat.fill(res);
+
+#ifndef FwCorrelator_H
+#define FwCorrelator_H
+
+#include "dunecore/DuneCommon/Utility/FwBatchFFT.h"
+#include "dunecore/DuneCommon/Utility/CorrelationMatrix.h"
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include <complex>
+#include <vector>
+
+class FwCorrelator {
+
+public:
+
+  using Index = unsigned int;
+  using Size = std::size_t;
+  using IndexVector = std::vector<Index>;
+  using FloatVector = std::vector<float>;
+  using Complex = std::complex<float>;
+  using ComplexVector = std::vector<Complex>;
+  using Batch = FwBatchFFT<float>;
+
+  // Return the number of channels or pairs in each processing block.
+  static Index blockSize() { return 64; }
+
+  // Ctor.
+  //   nsam - # samples in each channel
+  //   maxLag - maximum lag magnitude, at most nsam - 1
+  //   normalize - if true, subtract means and normalize (see above)
+  //   parallel - if true, blocks are processed concurrently
+  //   opt - FFTW optimization 0-2 (FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT)
+  FwCorrelator(Index nsam, Index maxLag, bool normalize =true, bool parallel =true, Index opt =0);
+
+  // Return the configuration.
+  Index nSample() const { return m_nsam; }
+  Index maxLag() const { return m_maxLag; }
+  bool normalize() const { return m_normalize; }
+  bool parallel() const { return m_parallel; }
+
+  // Return the transform length.
+  Index fftSize() const { return m_nfft; }
+
+  // Return the number of lags, 2*maxLag + 1. Output index ilag is lag ilag - maxLag.
+  Index nLag() const { return 2*m_maxLag + 1; }
+
+  // Set the reference from nref <= nsam values. It is zero-padded.
+  // Returns 0 for success.
+  int setReference(const float* pref, Index nref);
+  int setReference(const FloatVector& ref) { return setReference(ref.data(), ref.size()); }
+  bool haveReference() const { return m_refDft.size(); }
+
+  // Correlate the reference with ncha channels in a channel-major block,
+  // i.e. channel icha starts at psam[icha*nsam], filling
+  //   cors[icha*nLag() + ilag] = c(ilag - maxLag)
+  // with the reference as a. Returns 0 for success.
+  int correlate(Index ncha, const float* psam, FloatVector& cors) const;
+
+  // Correlate all pairs of ncha = chans.size() channels in a channel-major block.
+  // Returns 0 for success.
+  int correlatePairs(const IndexVector& chans, const float* psam, CorrelationMatrix& cmat) const;
+
+  // Correlate all pairs of channels in a map. All channels must have nsam samples.
+  // Returns 0 for success.
+  int correlatePairs(const AdcChannelDataMap& acds, CorrelationMatrix& cmat) const;
+
+private:
+
+  // Copy ncha channels of nin <= nsam values, with channel icha starting at
+  // psam[icha*nin], into zero-padded rows of buf, subtracting the means if
+  // normalizing, and evaluate their DFTs and norms.
+  int transform(Batch& xf, Index ncha, Index nin, const float* psam,
+                FloatVector& buf, ComplexVector& dfts, float* pnorms) const;
+
+  // Extract the lags from the backward transform of one product.
+  void extract(const float* pcor, float scale, float* pout) const;
+
+  // Run func(iblk) for iblk < nblk, concurrently if m_parallel is true.
+  template<class Func>
+  void run(Index nblk, Func func) const;
+
+  Index m_nsam;
+  Index m_maxLag;
+  bool m_normalize;
+  bool m_parallel;
+  Index m_opt;
+  Index m_nfft;
+  ComplexVector m_refDft;
+  float m_refNorm =0.0;
+
+};
+
+#endif
@@ -1,5 +1,6 @@
 // FwFFT.cxx
 #include "FwFFT.h"
+#include "FftwPlanCache.h"
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -21,15 +22,13 @@ using std::fixed;
 
 FwFFT::FwFFT(Index nsamMax, Index opt)
 : m_nsamMax(nsamMax),
-  m_flag(opt==2 ? FFTW_PATIENT : opt==1 ? FFTW_MEASURE : FFTW_ESTIMATE),
+  m_flag(FftwPlanCache<Float>::flag(opt)),
   m_inData((Float*) fftw_malloc(m_nsamMax*sizeof(Float))),
   m_outData((Complex*) fftw_malloc(m_nsamMax*sizeof(Complex))) { }
 
 //**********************************************************************
 
 FwFFT::~FwFFT() {
-  for ( auto& iplan : m_forwardPlans ) fftw_destroy_plan(iplan.second);
-  for ( auto& iplan : m_backwardPlans ) fftw_destroy_plan(iplan.second);
   fftw_free(m_inData);
   fftw_free(m_outData);
 }
@@ -44,7 +43,7 @@ FwFFT::Plan& FwFFT::forwardPlan(Index nsam) {
     return badplan;
   }
   if ( m_forwardPlans.count(nsam) == 0 ) {
-    m_forwardPlans[nsam] = fftw_plan_dft_r2c_1d(nsam, m_inData, m_outData, m_flag);
+    m_forwardPlans[nsam] = FftwPlanCache<Float>::instance().forwardPlan(nsam, 1, m_flag);
   }
   return m_forwardPlans[nsam];
 }
@@ -59,7 +58,7 @@ FwFFT::Plan& FwFFT::backwardPlan(Index nsam) {
     return badplan;
   }
   if ( m_backwardPlans.count(nsam) == 0 ) {
-    m_backwardPlans[nsam] = fftw_plan_dft_c2r_1d(nsam, m_outData, m_inData, m_flag);
+    m_backwardPlans[nsam] = FftwPlanCache<Float>::instance().backwardPlan(nsam, 1, m_flag);
   }
   return m_backwardPlans[nsam];
 }
@@ -78,7 +77,7 @@ fftForward(Index nsam, const float* psam, DFT& dft, Index logLevel) {
   if ( nsam == 0 ) return 0;
   for ( Index isam=0; isam<nsam; ++isam ) m_inData[isam] = psam[isam];
   Plan& plan = forwardPlan(nsam);
-  fftw_execute(plan);
+  fftw_execute_dft_r2c(plan, m_inData, m_outData);
   double xre = 0.0;
   double xim = 0.0;
   Index namp = dft.nAmplitude();
@@ -147,7 +146,7 @@ fftInverse(const DFT& dft, FloatVector& sams, Index logLevel) {
     m_outData[ifrq][1] = xim;
   }
   Plan& plan = backwardPlan(nsam);
-  fftw_execute(plan);
+  fftw_execute_dft_c2r(plan, m_outData, m_inData);
   float nfac = 1.0/nsam;
   sams.resize(nsam);
   for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = nfac*m_inData[isam];
@@ -155,3 +154,63 @@ fftInverse(const DFT& dft, FloatVector& sams, Index logLevel) {
 }
 
 //**********************************************************************
+
+int FwFFT::
+fftForward(Index nsam, const float* psam, CDFT& dft, Index logLevel) {
+  const string myname = "FwFFT::fftForward: ";
+  if ( nsam > m_nsamMax ) {
+    cout << myname << "Sample count is too large. Maximum is " << m_nsamMax << endl;
+    return 2;
+  }
+  dft.reset(nsam);
+  if ( ! dft.isValid() ) return 1;
+  for ( Index isam=0; isam<nsam; ++isam ) m_inData[isam] = psam[isam];
+  Plan& plan = forwardPlan(nsam);
+  fftw_execute_dft_r2c(plan, m_inData, m_outData);
+  double nfac = CDFT::globalFactor(dft.normalization(), nsam);
+  CDFT::Complex* pdft = dft.data();
+  for ( Index ifrq=0; ifrq<dft.nCompact(); ++ifrq ) {
+    pdft[ifrq] = CDFT::Complex(nfac*m_outData[ifrq][0], nfac*m_outData[ifrq][1]);
+    if ( logLevel >= 3 ) {
+      cout << myname << setw(4) << ifrq << ": ("
+           << setw(10) << fixed << pdft[ifrq].real() << ", "
+           << setw(10) << fixed << pdft[ifrq].imag() << ")" << endl;
+    }
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+int FwFFT::
+fftForward(const FloatVector& sams, CDFT& dft, Index logLevel) {
+  return fftForward(sams.size(), &sams[0], dft, logLevel);
+}
+
+//**********************************************************************
+
+int FwFFT::
+fftInverse(const CDFT& dft, FloatVector& sams, Index logLevel) {
+  const string myname = "FwFFT::fftInverse: ";
+  if ( ! dft.isValid() ) return 1;
+  Index nsam = dft.nSample();
+  if ( nsam > m_nsamMax ) {
+    cout << myname << "Sample count is too large. Maximum is " << m_nsamMax << endl;
+    return 4;
+  }
+  // Convert to standard normalization.
+  double nfac = 1.0/CDFT::globalFactor(dft.normalization(), nsam);
+  const CDFT::Complex* pdft = dft.data();
+  for ( Index ifrq=0; ifrq<dft.nCompact(); ++ifrq ) {
+    m_outData[ifrq][0] = nfac*pdft[ifrq].real();
+    m_outData[ifrq][1] = nfac*pdft[ifrq].imag();
+  }
+  Plan& plan = backwardPlan(nsam);
+  fftw_execute_dft_c2r(plan, m_outData, m_inData);
+  float sfac = 1.0/nsam;
+  sams.resize(nsam);
+  for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = sfac*m_inData[isam];
+  return 0;
+}
+
+//**********************************************************************
@@ -13,11 +13,17 @@
 //
 // The concrete type for the returned data is
 //   CompactRealDftData<float>
+// or, to skip the conversion to amplitude and phase,
+//   ComplexRealDftData<float>
+//
+// The FFTW plans are obtained from FftwPlanCache and so are shared with other
+// instances. Each instance has its own data arrays.
 
 #ifndef FwFFT_H
 #define FwFFT_H
 
 #include "dunecore/DuneCommon/Utility/CompactRealDftData.h"
+#include "dunecore/DuneCommon/Utility/ComplexRealDftData.h"
 #include "fftw3.h"
 #include <map>
 
@@ -29,6 +35,7 @@ public:
   using Float = double;
   using Complex = fftw_complex;
   using DFT = CompactRealDftData<float>;
+  using CDFT = ComplexRealDftData<float>;
   using FloatVector = std::vector<float>;
   using Plan = fftw_plan;
   using PlanMap = std::map<Index, Plan>;
@@ -38,11 +45,11 @@ public:
   //       Larger nubers take longer to build plans but are faster for each transform.
   FwFFT(Index nsamMax, Index opt);
 
-  // Dtor. Frees the data caches and destroys the plans.
+  // Dtor. Frees the data caches. The plans are owned by FftwPlanCache.
   ~FwFFT();
 
   // Return the plan for a data size.
-  // The plan is cretaed if not already existing.
+  // The plan is taken from the shared cache, where it is created if not already existing.
   Plan& forwardPlan(Index nsam);
   Plan& backwardPlan(Index nsam);
 
@@ -62,6 +69,11 @@ public:
   // The real and imag freq component are also recorded in xres, xims
   int fftInverse(const DFT& dft, FloatVector& sams, Index logLevel =0);
 
+  // Same transforms with the DFT held as complex values.
+  int fftForward(Index nsam, const float* psam, CDFT& dft, Index logLevel =0);
+  int fftForward(const FloatVector& sams, CDFT& dft, Index logLevel =0);
+  int fftInverse(const CDFT& dft, FloatVector& sams, Index logLevel =0);
+
 private:
 
   Index m_nsamMax;
@@ -0,0 +1,196 @@
+// FwStreamConvolver.cxx
+#include "FwStreamConvolver.h"
+#include "FftwPlanCache.h"
+#include <iostream>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+using Index = FwStreamConvolver::Index;
+using Size = FwStreamConvolver::Size;
+using Complex = FwStreamConvolver::Complex;
+using AlignedDoubleVector = FwStreamConvolver::AlignedDoubleVector;
+using AlignedComplexVector = FwStreamConvolver::AlignedComplexVector;
+
+namespace {
+
+fftw_complex* fftwData(AlignedComplexVector& vals) {
+  return reinterpret_cast<fftw_complex*>(vals.data());
+}
+
+}  // end unnamed namespace
+
+//**********************************************************************
+// Stream methods.
+//**********************************************************************
+
+FwStreamConvolver::Stream::Stream(KernelPtr pker) : m_pker(pker) {
+  if ( ! isValid() ) return;
+  m_buf.reserve(m_pker->nfft);
+  m_rea.resize(m_pker->nfft);
+  m_cmp.resize(m_pker->nfft/2 + 1);
+  reset();
+}
+
+//**********************************************************************
+
+void FwStreamConvolver::Stream::reset() {
+  m_nin = 0;
+  m_nz = 0;
+  m_nout = 0;
+  m_zout.clear();
+  m_buf.clear();
+  // History for the first block is zero.
+  if ( isValid() ) m_buf.resize(m_pker->nker - 1, 0.0);
+}
+
+//**********************************************************************
+
+void FwStreamConvolver::Stream::block(Size nlim) {
+  const Kernel& ker = *m_pker;
+  Index nfft = ker.nfft;
+  Index nhis = ker.nker - 1;
+  Index nblk = ker.blockSize();
+  FftwPlanCache<double>& plans = FftwPlanCache<double>::instance();
+  std::copy(m_buf.begin(), m_buf.end(), m_rea.begin());
+  fftw_execute_dft_r2c(plans.forwardPlan(nfft, 1, ker.flag), m_rea.data(), fftwData(m_cmp));
+  for ( Size ifrq=0; ifrq<m_cmp.size(); ++ifrq ) m_cmp[ifrq] *= ker.spectrum[ifrq];
+  fftw_execute_dft_c2r(plans.backwardPlan(nfft, 1, ker.flag), fftwData(m_cmp), m_rea.data());
+  // The first nhis values are wrapped around and discarded. The others are
+  // the full convolution for samples m_nz, m_nz+1, ...
+  for ( Index iblk=0; iblk<nblk; ++iblk, ++m_nz ) {
+    if ( m_nz < ker.koff ) continue;
+    if ( m_nout + m_zout.size() >= nlim ) break;
+    m_zout.push_back(m_rea[nhis + iblk]);
+  }
+  // Keep the history for the next block.
+  m_buf.erase(m_buf.begin(), m_buf.begin() + nblk);
+}
+
+//**********************************************************************
+// Convolver methods.
+//**********************************************************************
+
+Index FwStreamConvolver::defaultFftSize(Index nker) {
+  Index nfft = 64;
+  while ( nfft < 4*nker ) nfft *= 2;
+  return nfft;
+}
+
+//**********************************************************************
+
+int FwStreamConvolver::
+deconvolutionKernel(const FloatVector& response, const FloatVector& filter,
+                    Index nker, FloatVector& kernel, Index& koff) {
+  const string myname = "FwStreamConvolver::deconvolutionKernel: ";
+  kernel.clear();
+  koff = 0;
+  if ( filter.size() < 2 ) {
+    cout << myname << "Filter is too short." << endl;
+    return 1;
+  }
+  Index nfil = 2*(filter.size() - 1);
+  if ( response.size() > nfil || nker > nfil || nker == 0 ) {
+    cout << myname << "Response size " << response.size() << " and kernel size " << nker
+         << " must not exceed filter sample count " << nfil << endl;
+    return 2;
+  }
+  FftwPlanCache<double>& plans = FftwPlanCache<double>::instance();
+  AlignedDoubleVector rea(nfil, 0.0);
+  AlignedComplexVector cmp(nfil/2 + 1);
+  std::copy(response.begin(), response.end(), rea.begin());
+  fftw_execute_dft_r2c(plans.forwardPlan(nfil, 1, FFTW_ESTIMATE), rea.data(), fftwData(cmp));
+  double rmax = 0.0;
+  for ( const Complex& val : cmp ) rmax = std::max(rmax, std::abs(val));
+  double rmin = 1.e-10*rmax;
+  for ( Size ifrq=0; ifrq<cmp.size(); ++ifrq ) {
+    double mag = std::abs(cmp[ifrq]);
+    cmp[ifrq] = mag > rmin ? double(filter[ifrq])/(cmp[ifrq]*double(nfil)) : 0.0;
+  }
+  fftw_execute_dft_c2r(plans.backwardPlan(nfil, 1, FFTW_ESTIMATE), fftwData(cmp), rea.data());
+  // Truncate to nker samples centered on zero lag.
+  koff = nker/2;
+  kernel.resize(nker);
+  for ( Index iker=0; iker<nker; ++iker ) kernel[iker] = rea[(iker + nfil - koff) % nfil];
+  return 0;
+}
+
+//**********************************************************************
+
+FwStreamConvolver::FwStreamConvolver(const FloatVector& response, Index nfft, Index opt)
+: m_response(response),
+  m_nfft(nfft),
+  m_flag(FftwPlanCache<double>::flag(opt)) {
+  m_pcon = makeKernel(m_response, 0);
+}
+
+//**********************************************************************
+
+int FwStreamConvolver::setFilter(const FloatVector& filter, Index nker) {
+  FloatVector kernel;
+  Index koff = 0;
+  int rstat = deconvolutionKernel(m_response, filter, nker, kernel, koff);
+  if ( rstat ) return rstat;
+  return setDeconvolutionKernel(kernel, koff);
+}
+
+//**********************************************************************
+
+int FwStreamConvolver::setDeconvolutionKernel(const FloatVector& kernel, Index koff) {
+  m_pdec = makeKernel(kernel, koff);
+  return m_pdec == nullptr;
+}
+
+//**********************************************************************
+
+int FwStreamConvolver::Convolute(FloatVector& sigs) const { return apply(m_pcon, sigs); }
+int FwStreamConvolver::Convolute(DoubleVector& sigs) const { return apply(m_pcon, sigs); }
+int FwStreamConvolver::Deconvolute(FloatVector& sigs) const { return apply(m_pdec, sigs); }
+int FwStreamConvolver::Deconvolute(DoubleVector& sigs) const { return apply(m_pdec, sigs); }
+
+//**********************************************************************
+
+FwStreamConvolver::KernelPtr
+FwStreamConvolver::makeKernel(const FloatVector& kernel, Index koff) const {
+  const string myname = "FwStreamConvolver::makeKernel: ";
+  Index nker = kernel.size();
+  if ( nker == 0 || koff >= nker ) {
+    cout << myname << "Invalid kernel size " << nker << " or offset " << koff << endl;
+    return nullptr;
+  }
+  Index nfft = m_nfft ? m_nfft : defaultFftSize(nker);
+  if ( nfft < nker ) {
+    cout << myname << "FFT size " << nfft << " is smaller than kernel size " << nker << endl;
+    return nullptr;
+  }
+  std::shared_ptr<Kernel> pker(new Kernel);
+  pker->nfft = nfft;
+  pker->nker = nker;
+  pker->koff = koff;
+  pker->flag = m_flag;
+  AlignedDoubleVector rea(nfft, 0.0);
+  std::copy(kernel.begin(), kernel.end(), rea.begin());
+  pker->spectrum.resize(nfft/2 + 1);
+  FftwPlanCache<double>& plans = FftwPlanCache<double>::instance();
+  fftw_execute_dft_r2c(plans.forwardPlan(nfft, 1, m_flag), rea.data(), fftwData(pker->spectrum));
+  // Include the inverse transform normalization.
+  for ( Complex& val : pker->spectrum ) val /= double(nfft);
+  return pker;
+}
+
+//**********************************************************************
+
+template<typename T>
+int FwStreamConvolver::apply(KernelPtr pker, std::vector<T>& sigs) {
+  if ( pker == nullptr ) return 1;
+  Stream str(pker);
+  std::vector<T> out;
+  out.reserve(sigs.size());
+  if ( str.process(sigs.data(), sigs.size(), out) ) return 2;
+  if ( str.finish(out) ) return 3;
+  sigs.swap(out);
+  return 0;
+}
+
+//**********************************************************************
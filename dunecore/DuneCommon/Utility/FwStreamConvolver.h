@@ -0,0 +1,199 @@
+// FwStreamConvolver.h
+//
+// Block-wise (overlap-save) convolution and deconvolution of long or
+// continuous real data streams with a fixed kernel using FFTW.
+//
+// The kernel spectrum is calculated once for an FFT length nfft that is
+// independent of the data length. Data are processed in blocks of
+// nfft - nker + 1 samples, so memory and transform sizes are bounded even
+// for readouts of hundreds of thousands of ticks, and data may be supplied
+// incrementally.
+//
+// Kernel element koff is aligned with the output sample, i.e. the output is
+//   y[i] = SUM_k ker[k] x[i + koff - k]
+// with x = 0 outside the data. The output has the same length as the input.
+// Note this is a linear convolution: unlike a single FFT of the whole
+// waveform, there is no wrap-around at the ends.
+//
+// The convolution kernel is the response function (koff = 0). The
+// deconvolution kernel is built from the response and a filter spectrum:
+// it is the inverse DFT of filter/response, truncated to nker samples
+// centered on zero (koff = nker/2). A different kernel may be set directly.
+//
+// Usage:
+//   FwStreamConvolver con(response);
+//   con.setFilter(filter, 201);
+//   con.Convolute(sigs);          // whole waveform, in place
+//   con.Deconvolute(sigs);
+//   // Streaming:
+//   FwStreamConvolver::Stream str = con.deconvolutionStream();
+//   for ( each chunk ) str.process(pchunk, nchunk, out);   // appends to out
+//   str.finish(out);
+//
+// The convolver may be shared between threads. Each Stream holds its own work
+// space and should be used by one thread at a time.
+
+#ifndef FwStreamConvolver_H
+#define FwStreamConvolver_H
+
+#include "dunecore/DuneInterface/Data/AlignedAllocator.h"
+#include <vector>
+#include <complex>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+class FwStreamConvolver {
+
+public:
+
+  using Index = unsigned int;
+  using Size = std::size_t;
+  using FloatVector = std::vector<float>;
+  using DoubleVector = std::vector<double>;
+  using Complex = std::complex<double>;
+  using AlignedDoubleVector = std::vector<double, AlignedAllocator<double>>;
+  using AlignedComplexVector = std::vector<Complex, AlignedAllocator<Complex>>;
+
+  // Kernel and its spectrum.
+  struct Kernel {
+    Index nfft =0;                   // FFT length
+    Index nker =0;                   // Kernel length
+    Index koff =0;                   // Index of the kernel element at zero lag
+    Index flag =0;                   // FFTW planner flag
+    AlignedComplexVector spectrum;   // DFT of the kernel divided by nfft
+    Index blockSize() const { return nfft - nker + 1; }
+  };
+  using KernelPtr = std::shared_ptr<const Kernel>;
+
+  // Processing of one data stream.
+  class Stream {
+  public:
+    explicit Stream(KernelPtr pker);
+    // Add nin samples. Samples of output available so far are appended to out.
+    template<typename T>
+    int process(const T* pin, Size nin, std::vector<T>& out);
+    // Flush the remaining output and reset for a new stream.
+    template<typename T>
+    int finish(std::vector<T>& out);
+    // Number of samples read and written.
+    Size inputCount() const { return m_nin; }
+    Size outputCount() const { return m_nout; }
+    // Clear all data.
+    void reset();
+    bool isValid() const { return m_pker != nullptr; }
+  private:
+    // Transform the block in m_buf and append output to m_zout.
+    // Output is limited to nlim samples.
+    void block(Size nlim);
+    template<typename T>
+    void drain(std::vector<T>& out);
+    KernelPtr m_pker;
+    AlignedDoubleVector m_buf;      // Input history and pending input
+    AlignedDoubleVector m_rea;
+    AlignedComplexVector m_cmp;
+    DoubleVector m_zout;
+    Size m_nin =0;
+    Size m_nz =0;                   // # full convolution samples calculated
+    Size m_nout =0;
+  };
+
+  // Return the default FFT length for a kernel length.
+  static Index defaultFftSize(Index nker);
+
+  // Build a deconvolution kernel.
+  //   response - response function
+  //   filter - filter spectrum for nfil = 2*(filter.size() - 1) samples
+  //   nker - kernel length
+  //   kernel - output kernel
+  //   koff - output: position of zero lag in the kernel
+  // Returns 0 for success.
+  static int deconvolutionKernel(const FloatVector& response, const FloatVector& filter,
+                                 Index nker, FloatVector& kernel, Index& koff);
+
+  // Ctor from the response function, FFT length (0 for default) and
+  // planner optimization 0-2 (FFTW_ESTIMATE, FFTW_MEASURE, FFTW_PATIENT).
+  explicit FwStreamConvolver(const FloatVector& response, Index nfft =0, Index opt =0);
+
+  // Set the deconvolution kernel from the response and a filter spectrum.
+  int setFilter(const FloatVector& filter, Index nker);
+
+  // Set the deconvolution kernel directly.
+  int setDeconvolutionKernel(const FloatVector& kernel, Index koff);
+
+  // Return the kernels. Null if not defined.
+  KernelPtr convolutionKernel() const { return m_pcon; }
+  KernelPtr deconvolutionKernel() const { return m_pdec; }
+
+  // Return streams for convolution and deconvolution.
+  Stream convolutionStream() const { return Stream(m_pcon); }
+  Stream deconvolutionStream() const { return Stream(m_pdec); }
+
+  // Convolute or deconvolute a full waveform in place.
+  // Returns 0 for success.
+  int Convolute(FloatVector& sigs) const;
+  int Convolute(DoubleVector& sigs) const;
+  int Deconvolute(FloatVector& sigs) const;
+  int Deconvolute(DoubleVector& sigs) const;
+
+private:
+
+  // Build a kernel.
+  KernelPtr makeKernel(const FloatVector& kernel, Index koff) const;
+
+  // Apply a kernel to a full waveform.
+  template<typename T>
+  static int apply(KernelPtr pker, std::vector<T>& sigs);
+
+  FloatVector m_response;
+  Index m_nfft;
+  Index m_flag;
+  KernelPtr m_pcon;
+  KernelPtr m_pdec;
+
+};
+
+//**********************************************************************
+
+template<typename T>
+int FwStreamConvolver::Stream::process(const T* pin, Size nin, std::vector<T>& out) {
+  if ( ! isValid() ) return 1;
+  Size nfft = m_pker->nfft;
+  Size iin = 0;
+  while ( iin < nin ) {
+    Size ncopy = std::min(nfft - m_buf.size(), nin - iin);
+    m_buf.insert(m_buf.end(), pin + iin, pin + iin + ncopy);
+    iin += ncopy;
+    m_nin += ncopy;
+    if ( m_buf.size() == nfft ) block(m_nin);
+  }
+  drain(out);
+  return 0;
+}
+
+//**********************************************************************
+
+template<typename T>
+int FwStreamConvolver::Stream::finish(std::vector<T>& out) {
+  if ( ! isValid() ) return 1;
+  while ( m_nout + m_zout.size() < m_nin ) {
+    m_buf.resize(m_pker->nfft, 0.0);
+    block(m_nin);
+  }
+  drain(out);
+  reset();
+  return 0;
+}
+
+//**********************************************************************
+
+template<typename T>
+void FwStreamConvolver::Stream::drain(std::vector<T>& out) {
+  out.insert(out.end(), m_zout.begin(), m_zout.end());
+  m_nout += m_zout.size();
+  m_zout.clear();
+}
+
+//**********************************************************************
+
+#endif
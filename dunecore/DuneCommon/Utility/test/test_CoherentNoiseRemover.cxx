@@ -0,0 +1,148 @@
+// test_CoherentNoiseRemover.cxx
+//
+// Test CoherentNoiseRemover.
+
+#include "dunecore/DuneCommon/Utility/CoherentNoiseRemover.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using CNR = CoherentNoiseRemover;
+using Index = CNR::Index;
+using Data = CNR::Data;
+using FloatVector = CNR::FloatVector;
+using MaskVector = CNR::MaskVector;
+
+//**********************************************************************
+
+bool near(float x1, float x2, float tol =1.e-4) {
+  return fabs(x1 - x2) < tol*(1.0 + fabs(x1) + fabs(x2));
+}
+
+// Coherent noise for tick itck.
+float noise(Index itck) { return 3.0*sin(0.05*itck) + 0.5*((itck*7)%5); }
+
+// Incoherent part for channel icha and tick itck. Zero median and mean over
+// channels for each tick if the channel count is odd.
+float offset(Index icha, Index ncha, Index itck) {
+  return (float(icha) - 0.5*(ncha - 1))*(1.0 + 0.001*itck);
+}
+
+//**********************************************************************
+
+int test_CoherentNoiseRemover(Index ncha, Index ntck, Index blockSize, bool parallel) {
+  const string myname = "test_CoherentNoiseRemover: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+  cout << myname << line << endl;
+  cout << myname << "Channels: " << ncha << ", ticks: " << ntck << ", block size: " << blockSize
+       << ", parallel: " << parallel << endl;
+
+  // Build data with a signal in channel 0 for ticks [10, 30).
+  Data dat({ncha, ntck});
+  MaskVector mask(ncha*ntck, 0);
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      dat(icha, itck) = noise(itck) + offset(icha, ncha, itck);
+    }
+  }
+  for ( Index itck=10; itck<30 && itck<ntck; ++itck ) {
+    dat(0, itck) += 1000.0;
+    mask[itck] = 1;
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Check the median." << endl;
+  {
+    CNR cnr(CNR::Median, 3, blockSize, parallel);
+    assert( cnr.method() == CNR::Median );
+    assert( cnr.minCount() == 3 );
+    FloatVector cors;
+    assert( cnr.evaluate(dat, MaskVector(), cors) == 0 );
+    assert( cors.size() == ntck );
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      // With the signal unmasked, the median is moved to the next channel up.
+      float exp = noise(itck) + (itck >= 10 && itck < 30 ? offset(ncha/2 + 1, ncha, itck) : 0.0);
+      assert( near(cors[itck], exp) );
+    }
+    Data dat2 = dat;
+    assert( cnr.remove(dat2, mask, &cors) == 0 );
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      // With the signal masked, there is an even number of channels.
+      float exp = noise(itck);
+      if ( itck >= 10 && itck < 30 ) exp += 0.5*offset(ncha/2 + 1, ncha, itck);
+      assert( near(cors[itck], exp) );
+      for ( Index icha=0; icha<ncha; ++icha ) {
+        assert( near(dat2(icha, itck), dat(icha, itck) - exp) );
+      }
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Check the mean." << endl;
+  {
+    CNR cnr(CNR::Mean, 1, blockSize, parallel);
+    FloatVector cors;
+    assert( cnr.evaluate(dat, mask, cors) == 0 );
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      double sum = 0.0;
+      Index count = 0;
+      for ( Index icha=0; icha<ncha; ++icha ) {
+        if ( mask[icha*ntck + itck] ) continue;
+        sum += dat(icha, itck);
+        ++count;
+      }
+      assert( near(cors[itck], sum/count, 1.e-3) );
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Check the minimum count." << endl;
+  {
+    CNR cnr(CNR::Median, ncha, blockSize, parallel);
+    FloatVector cors;
+    assert( cnr.evaluate(dat, mask, cors) == 0 );
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      if ( itck >= 10 && itck < 30 ) assert( cors[itck] == 0.0 );
+      else assert( near(cors[itck], noise(itck)) );
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Check errors." << endl;
+  {
+    CNR cnr(CNR::Mean);
+    FloatVector cors;
+    assert( cnr.evaluate(dat, MaskVector(3, 0), cors) == 2 );
+    assert( cnr.evaluate(Data(), MaskVector(), cors) == 1 );
+    assert( cors.size() == 0 );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  if ( test_CoherentNoiseRemover(7, 100, 256, false) ) return 1;
+  if ( test_CoherentNoiseRemover(7, 1000, 64, true) ) return 1;
+  if ( test_CoherentNoiseRemover(31, 4500, 100, true) ) return 1;
+  return 0;
+}
+
+//**********************************************************************
@@ -0,0 +1,158 @@
+// test_ComplexRealDftData.cxx
+//
+// Test ComplexRealDftData and its use in FwFFT.
+
+#include "dunecore/DuneCommon/Utility/ComplexRealDftData.h"
+#include "dunecore/DuneCommon/Utility/CompactRealDftData.h"
+#include "dunecore/DuneCommon/Utility/FwFFT.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Cdft = ComplexRealDftData<float>;
+using Dft = CompactRealDftData<float>;
+using Index = Cdft::Index;
+using FloatVector = Cdft::FloatVector;
+using Norm = Cdft::Norm;
+
+//**********************************************************************
+
+bool near(float x1, float x2, float tol =1.e-4) {
+  return fabs(x1 - x2) < tol*(1.0 + fabs(x1) + fabs(x2));
+}
+
+//**********************************************************************
+
+int test_ComplexRealDftData(Index nsam, Index inorm) {
+  const string myname = "test_ComplexRealDftData: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+  Norm norm(inorm);
+  cout << myname << line << endl;
+  cout << myname << "Sample count: " << nsam << ", normalization: " << inorm << endl;
+
+  cout << myname << line << endl;
+  cout << myname << "Check empty DFT." << endl;
+  Cdft empty(norm);
+  assert( ! empty.isValid() );
+  assert( empty.nCompact() == 0 );
+  Cdft::ComplexVector badvals(3);
+  Cdft bad(norm, 20, badvals);
+  assert( bad.size() == 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Transform data." << endl;
+  FloatVector sams(nsam);
+  FloatVector sams2(nsam);
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    sams[isam] = 20.0*exp(-0.1*(isam - 5.0)*(isam - 5.0)) - 2.0 + 0.3*isam;
+    sams2[isam] = isam < 3 ? 1.0 - 0.3*isam : 0.0;
+  }
+  FwFFT xf(100, 0);
+  Dft dft(norm);
+  Cdft cdft(norm);
+  assert( xf.fftForward(sams, dft) == 0 );
+  assert( xf.fftForward(sams, cdft) == 0 );
+  assert( cdft.isValid() );
+  assert( cdft.nSample() == nsam );
+  assert( cdft.nCompact() == dft.nCompact() );
+
+  cout << myname << line << endl;
+  cout << myname << "Compare with the amplitude-phase representation." << endl;
+  for ( Index ifrq=0; ifrq<nsam; ++ifrq ) {
+    assert( near(cdft.amplitude(ifrq), dft.amplitude(ifrq)) );
+    assert( near(cdft.real(ifrq), dft.real(ifrq)) );
+    assert( near(cdft.imag(ifrq), dft.amplitude(ifrq)*sin(dft.phase(ifrq))) );
+    if ( fabs(dft.amplitude(ifrq)) > 1.e-3 ) {
+      assert( fabs(sin(cdft.phase(ifrq) - dft.phase(ifrq))) < 1.e-4 );
+    }
+  }
+  assert( near(cdft.power(), dft.power()) );
+  FloatVector amps;
+  FloatVector phas;
+  assert( cdft.copyOut(amps, phas) == 0 );
+  assert( amps.size() == dft.nAmplitude() );
+  assert( phas.size() == dft.nPhase() );
+  for ( Index ifrq=0; ifrq<amps.size(); ++ifrq ) assert( near(amps[ifrq], dft.compactAmplitude(ifrq)) );
+  Cdft cdft2(norm, dft);
+  for ( Index ifrq=0; ifrq<cdft.nCompact(); ++ifrq ) {
+    assert( near(cdft2.compactValue(ifrq).real(), cdft.compactValue(ifrq).real()) );
+    assert( near(cdft2.compactValue(ifrq).imag(), cdft.compactValue(ifrq).imag()) );
+  }
+  // Conversion to another normalization.
+  Cdft cdft3(Norm(RealDftNormalization::Standard, RealDftNormalization::Unit), dft);
+  for ( Index ifrq=0; ifrq<nsam; ++ifrq ) {
+    assert( near(cdft3.real(ifrq), dft.convAmplitude(ifrq)*cos(dft.phase(ifrq))) );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Inverse transform." << endl;
+  FloatVector samsOut;
+  assert( xf.fftInverse(cdft, samsOut) == 0 );
+  assert( samsOut.size() == nsam );
+  for ( Index isam=0; isam<nsam; ++isam ) assert( near(samsOut[isam], sams[isam]) );
+
+  cout << myname << line << endl;
+  cout << myname << "Convolve and deconvolve." << endl;
+  Cdft cres(norm);
+  assert( xf.fftForward(sams2, cres) == 0 );
+  Cdft cconv(cdft);
+  assert( cconv.multiply(cres) == 0 );
+  assert( xf.fftInverse(cconv, samsOut) == 0 );
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    float sum = 0.0;
+    for ( Index jsam=0; jsam<nsam; ++jsam ) sum += sams[jsam]*sams2[(nsam + isam - jsam)%nsam];
+    assert( near(samsOut[isam], sum) );
+  }
+  assert( cconv.divide(cres) == 0 );
+  assert( xf.fftInverse(cconv, samsOut) == 0 );
+  for ( Index isam=0; isam<nsam; ++isam ) assert( near(samsOut[isam], sams[isam], 1.e-3) );
+  // Circular correlation.
+  Cdft ccor(cdft);
+  assert( ccor.multiplyConjugate(cres) == 0 );
+  assert( xf.fftInverse(ccor, samsOut) == 0 );
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    float sum = 0.0;
+    for ( Index jsam=0; jsam<nsam; ++jsam ) sum += sams[(jsam + isam)%nsam]*sams2[jsam];
+    assert( near(samsOut[isam], sum) );
+  }
+  // Real filter.
+  Cdft cfil(cdft);
+  FloatVector facs(cfil.nCompact(), 0.5);
+  assert( cfil.multiply(facs) == 0 );
+  assert( xf.fftInverse(cfil, samsOut) == 0 );
+  for ( Index isam=0; isam<nsam; ++isam ) assert( near(samsOut[isam], 0.5*sams[isam]) );
+  assert( cfil.multiply(FloatVector(2)) == 1 );
+  Cdft cother(norm, nsam + 1);
+  assert( cfil.multiply(cother) == 1 );
+  assert( cfil.divide(cother) == 1 );
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  for ( Index nsam : {20, 21} ) {
+    for ( Index inorm : {11, 12, 13, 21, 22, 23} ) {
+      if ( test_ComplexRealDftData(nsam, inorm) ) return 1;
+    }
+  }
+  return 0;
+}
+
+//**********************************************************************
@@ -0,0 +1,227 @@
+// test_DftPowerAccumulator.cxx
+//
+// Test DftPowerAccumulator.
+
+#include "dunecore/DuneCommon/Utility/DftPowerAccumulator.h"
+#include "dunecore/DuneCommon/Utility/FwBatchFFT.h"
+#include "dunecore/DuneCommon/Utility/FwFFT.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Acc = DftPowerAccumulator;
+using Index = Acc::Index;
+using IndexVector = Acc::IndexVector;
+using FloatVector = Acc::FloatVector;
+using Norm = Acc::Norm;
+
+//**********************************************************************
+
+bool near(float x1, float x2, float tol =1.e-4) {
+  return fabs(x1 - x2) < tol*(1.0 + fabs(x1) + fabs(x2));
+}
+
+// Pseudo-random samples for channel icha and event ievt.
+FloatVector samples(Index nsam, Index icha, Index ievt) {
+  FloatVector sams(nsam);
+  unsigned int seed = 1000003*(icha + 1) + 7919*(ievt + 1);
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    seed = 1664525*seed + 1013904223;
+    sams[isam] = (seed >> 8)/float(1 << 24) - 0.5 + (icha + 1)*sin(0.3*isam);
+  }
+  return sams;
+}
+
+//**********************************************************************
+
+int test_DftPowerAccumulator(Index nsam) {
+  const string myname = "test_DftPowerAccumulator: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+  Norm norm(22);
+  Index ncha = 5;
+  Index nevt = 6;
+  IndexVector chans;
+  for ( Index icha=0; icha<ncha; ++icha ) chans.push_back(100 + icha);
+
+  cout << myname << line << endl;
+  cout << myname << "Sample count: " << nsam << endl;
+  Acc acc(norm, nsam);
+  assert( acc.nSample() == nsam );
+  assert( acc.nBin() == nsam/2 + 1 );
+  assert( acc.nChannel() == 0 );
+  assert( acc.mean(100) == nullptr );
+
+  cout << myname << line << endl;
+  cout << myname << "Accumulate batched DFTs and keep the powers for reference." << endl;
+  FwBatchFFT<float> xf(0);
+  FwBatchFFT<float>::ComplexVector dfts;
+  Index nbin = acc.nBin();
+  vector<vector<FloatVector>> refs(ncha, vector<FloatVector>(nevt));
+  for ( Index ievt=0; ievt<nevt; ++ievt ) {
+    FloatVector block;
+    for ( Index icha=0; icha<ncha; ++icha ) {
+      FloatVector sams = samples(nsam, icha, ievt);
+      block.insert(block.end(), sams.begin(), sams.end());
+    }
+    assert( xf.fftForward(nsam, ncha, block.data(), norm, dfts) == 0 );
+    assert( acc.add(chans, dfts.data()) == 0 );
+    // Check the power sums to the sample power.
+    for ( Index icha=0; icha<ncha; ++icha ) {
+      FloatVector& pwr = refs[icha][ievt];
+      pwr.resize(nbin);
+      float sum = 0.0;
+      for ( Index ibin=0; ibin<nbin; ++ibin ) {
+        pwr[ibin] = (ibin == 0 || 2*ibin == nsam ? 1.0 : 2.0)*std::norm(dfts[icha*nbin + ibin]);
+        sum += pwr[ibin];
+      }
+      float sum2 = 0.0;
+      for ( Index isam=0; isam<nsam; ++isam ) sum2 += block[icha*nsam + isam]*block[icha*nsam + isam];
+      assert( near(sum, sum2) );
+    }
+  }
+  assert( acc.nChannel() == ncha );
+  assert( acc.channels() == chans );
+
+  cout << myname << line << endl;
+  cout << myname << "Check means and variances." << endl;
+  FloatVector means;
+  FloatVector vars;
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    assert( acc.count(chans[icha]) == nevt );
+    assert( acc.stats(chans[icha], means, vars) == 0 );
+    for ( Index ibin=0; ibin<nbin; ++ibin ) {
+      double sum = 0.0;
+      double sumsq = 0.0;
+      for ( Index ievt=0; ievt<nevt; ++ievt ) sum += refs[icha][ievt][ibin];
+      double mea = sum/nevt;
+      for ( Index ievt=0; ievt<nevt; ++ievt ) sumsq += pow(refs[icha][ievt][ibin] - mea, 2);
+      double var = sumsq/(nevt - 1);
+      assert( near(means[ibin], mea) );
+      assert( near(acc.mean(chans[icha])[ibin], mea) );
+      assert( near(vars[ibin], var, 1.e-3) );
+    }
+  }
+  assert( acc.stats(99, means, vars) != 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Compare with CompactRealDftData and AdcChannelData input." << endl;
+  {
+    Acc acc1(norm, nsam);
+    Acc acc2(norm, nsam);
+    AdcChannelDataMap acds;
+    FwFFT xf1(nsam, 0);
+    for ( Index ievt=0; ievt<nevt; ++ievt ) {
+      for ( Index icha=0; icha<ncha; ++icha ) {
+        FloatVector sams = samples(nsam, icha, ievt);
+        FwFFT::DFT dft(Norm(12));
+        assert( xf1.fftForward(sams, dft) == 0 );
+        assert( acc1.add(chans[icha], dft) == 0 );
+        AdcChannelData& acd = acds[chans[icha]];
+        acd.setChannelInfo(chans[icha]);
+        FwFFT::DFT dft22(norm);
+        assert( xf1.fftForward(sams, dft22) == 0 );
+        acd.dftmags.resize(nbin);
+        for ( Index ibin=0; ibin<nbin; ++ibin ) acd.dftmags[ibin] = dft22.compactAmplitude(ibin);
+      }
+      assert( acc2.add(acds) == 0 );
+    }
+    for ( Index icha=0; icha<ncha; ++icha ) {
+      for ( Index ibin=0; ibin<nbin; ++ibin ) {
+        assert( near(acc1.mean(chans[icha])[ibin], acc.mean(chans[icha])[ibin], 1.e-3) );
+        assert( near(acc2.mean(chans[icha])[ibin], acc.mean(chans[icha])[ibin], 1.e-3) );
+      }
+    }
+    FwFFT::DFT dftStd(Norm(11));
+    assert( xf1.fftForward(samples(nsam, 0, 0), dftStd) == 0 );
+    assert( acc1.add(100, dftStd) == 3 );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Merge." << endl;
+  Acc acca(norm, nsam);
+  Acc accb(norm, nsam);
+  for ( Index ievt=0; ievt<nevt; ++ievt ) {
+    Acc& acch = ievt < 2 ? acca : accb;
+    for ( Index icha=0; icha<ncha; ++icha ) acch.addPower(chans[icha], refs[icha][ievt].data());
+  }
+  assert( acca.merge(accb) == 0 );
+  FloatVector means2;
+  FloatVector vars2;
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    assert( acca.count(chans[icha]) == nevt );
+    assert( acc.stats(chans[icha], means, vars) == 0 );
+    assert( acca.stats(chans[icha], means2, vars2) == 0 );
+    for ( Index ibin=0; ibin<nbin; ++ibin ) {
+      assert( near(means2[ibin], means[ibin]) );
+      assert( near(vars2[ibin], vars[ibin], 1.e-3) );
+    }
+  }
+  assert( acca.merge(Acc(norm, nsam + 2)) != 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Groups." << endl;
+  acc.addGroup("even", {100, 102, 104});
+  acc.addGroup("none", {99});
+  Index grpCount = 0;
+  assert( acc.groupStats("even", grpCount, means, vars) == 0 );
+  assert( grpCount == 3*nevt );
+  for ( Index ibin=0; ibin<nbin; ++ibin ) {
+    double sum = 0.0;
+    for ( Index icha : {0, 2, 4} ) {
+      for ( Index ievt=0; ievt<nevt; ++ievt ) sum += refs[icha][ievt][ibin];
+    }
+    assert( near(means[ibin], sum/grpCount) );
+  }
+  assert( acc.groupStats("none", grpCount, means, vars) == 2 );
+  assert( acc.groupStats("nosuch", grpCount, means, vars) == 1 );
+  assert( acc.groupNames().size() == 2 );
+
+  cout << myname << line << endl;
+  cout << myname << "Write and read." << endl;
+  string fnam = "test_DftPowerAccumulator.dftpwr";
+  assert( acc.write(fnam) == 0 );
+  Acc accr(Norm(11), 10);
+  assert( accr.read(fnam) == 0 );
+  assert( accr.nSample() == nsam );
+  assert( accr.normalization().globalNormalization() == norm.globalNormalization() );
+  assert( accr.channels() == chans );
+  assert( accr.groupNames() == acc.groupNames() );
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    assert( accr.count(chans[icha]) == nevt );
+    assert( accr.stats(chans[icha], means2, vars2) == 0 );
+    assert( acc.stats(chans[icha], means, vars) == 0 );
+    assert( means2 == means );
+    assert( vars2 == vars );
+  }
+  std::remove(fnam.c_str());
+  assert( accr.read("nosuchdir/nosuchfile") != 0 );
+  accr.print(cout, myname);
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  if ( test_DftPowerAccumulator(64) ) return 1;
+  if ( test_DftPowerAccumulator(101) ) return 1;
+  return 0;
+}
+
+//**********************************************************************
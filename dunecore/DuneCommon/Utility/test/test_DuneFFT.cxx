@@ -13,6 +13,7 @@
 #include <vector>
 #include <iomanip>
 #include <cmath>
+#include <chrono>
 
 #undef NDEBUG
 #include <cassert>
@@ -32,7 +33,7 @@ using DFT = DuneFFT::DFT;
 
 //**********************************************************************
 
-int test_DuneFFT(Index ignorm, Index itnorm, int loglev, Index len) {
+int test_DuneFFT(Index ignorm, Index itnorm, int loglev, Index len, string sbak) {
   const string myname = "test_DuneFFT: ";
 #ifdef NDEBUG
   cout << myname << "NDEBUG must be off." << endl;
@@ -42,6 +43,9 @@ int test_DuneFFT(Index ignorm, Index itnorm, int loglev, Index len) {
 
   RealDftNormalization norm(ignorm, itnorm);
   cout << line << endl;
+  assert( DuneFFT::setBackend(sbak) == 0 );
+  assert( DuneFFT::backend().name() == sbak );
+  cout << myname << "     Backend: " << sbak << endl;
   cout << myname << " Global norm: " << ignorm << endl;
   cout << myname << "   Term norm: " << itnorm << endl;
 
@@ -133,6 +137,38 @@ int test_DuneFFT(Index ignorm, Index itnorm, int loglev, Index len) {
 
 //**********************************************************************
 
+// Time the forward and inverse transforms for each backend.
+int test_DuneFFT_timing(Index nsam, Index nrep) {
+  const string myname = "test_DuneFFT_timing: ";
+  string line = "-----------------------------";
+  using Clock = std::chrono::steady_clock;
+  cout << myname << line << endl;
+  cout << myname << "Timing " << nrep << " transforms of " << nsam << " samples." << endl;
+  FloatVector sams(nsam);
+  for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = sin(0.01*isam) + 0.001*(isam%7);
+  vector<double> times;
+  for ( string sbak : {"FFTW", "ROOT"} ) {
+    assert( DuneFFT::setBackend(sbak) == 0 );
+    DFT dft(RealDftNormalization(22));
+    FloatVector sams2;
+    Clock::time_point t0 = Clock::now();
+    for ( Index irep=0; irep<nrep; ++irep ) {
+      assert( DuneFFT::fftForward(sams, dft) == 0 );
+      assert( DuneFFT::fftInverse(dft, sams2) == 0 );
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    times.push_back(sec);
+    cout << myname << setw(6) << sbak << ": " << 1.e6*sec/nrep << " us/transform pair" << endl;
+  }
+  cout << myname << "Speedup: " << times[1]/times[0] << endl;
+  assert( DuneFFT::setBackend("FFTW") == 0 );
+  assert( DuneFFT::setBackend("NoSuchBackend") != 0 );
+  assert( DuneFFT::backend().name() == "FFTW" );
+  return 0;
+}
+
+//**********************************************************************
+
 int main(int argc, char* argv[]) {
   Index ignorm = 1;
   Index itnorm = 1;
@@ -158,7 +194,10 @@ int main(int argc, char* argv[]) {
     string sarg(argv[4]);
     len = std::stoi(sarg);
   }
-  return test_DuneFFT(ignorm, itnorm, loglev, len);
+  for ( string sbak : {"FFTW", "ROOT"} ) {
+    if ( test_DuneFFT(ignorm, itnorm, loglev, len, sbak) ) return 1;
+  }
+  return test_DuneFFT_timing(len > 0 ? len : 1000, 100);
 }
 
 //**********************************************************************
@@ -0,0 +1,135 @@
+// test_FftwPlanCache.cxx
+//
+// Test FftwPlanCache.
+
+#include "dunecore/DuneCommon/Utility/FftwPlanCache.h"
+#include "dunecore/DuneCommon/Utility/FwFFT.h"
+#include "dunecore/DuneCommon/Utility/Fw2dFFT.h"
+#include "tbb/parallel_for.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Index = unsigned int;
+using Cache = FftwPlanCache<double>;
+
+//**********************************************************************
+
+int test_FftwPlanCache() {
+  const string myname = "test_FftwPlanCache: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+
+  cout << myname << line << endl;
+  cout << myname << "Fetch plans." << endl;
+  Cache& cache = Cache::instance();
+  assert( &Cache::instance() == &cache );
+  unsigned flag = Cache::flag(0);
+  assert( flag == FFTW_ESTIMATE );
+  assert( Cache::flag(1) == FFTW_MEASURE );
+  assert( Cache::flag(2) == FFTW_PATIENT );
+  Index nplan0 = cache.size();
+  Cache::Plan pf = cache.forwardPlan(32, 1, flag);
+  assert( pf != nullptr );
+  assert( cache.size() == nplan0 + 1 );
+  assert( cache.forwardPlan(32, 1, flag) == pf );
+  assert( cache.size() == nplan0 + 1 );
+  Cache::Plan pb = cache.backwardPlan(32, 1, flag);
+  assert( pb != nullptr );
+  assert( pb != pf );
+  assert( cache.forwardPlan(32, 4, flag) != pf );
+  assert( cache.forward2dPlan({4, 8}, false, flag) != cache.forward2dPlan({4, 8}, true, flag) );
+  assert( cache.size() == nplan0 + 5 );
+  assert( cache.forwardPlan(0, 1, flag) == nullptr );
+  assert( cache.forward2dPlan({0, 8}, false, flag) == nullptr );
+  assert( cache.size() == nplan0 + 5 );
+  assert( cache.forward2dPlan({4, 8}, true, flag, 2) != cache.forward2dPlan({4, 8}, true, flag) );
+  assert( cache.size() == nplan0 + 6 );
+  Cache::PlanStats stats = cache.planStats();
+  assert( stats.count == cache.size() );
+  assert( stats.time >= stats.maxTime );
+
+  cout << myname << line << endl;
+  cout << myname << "Check good sizes." << endl;
+  assert( Cache::isGoodSize(1) );
+  assert( Cache::isGoodSize(4410) );
+  assert( ! Cache::isGoodSize(0) );
+  assert( ! Cache::isGoodSize(4492) );
+  assert( Cache::goodSize(4492) == 4500 );
+  assert( Cache::goodSize(6000) == 6000 );
+  assert( Cache::goodSize(11) == 12 );
+  assert( Cache::goodSize(0) == 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Check FwFFT instances share plans." << endl;
+  {
+    FwFFT xf1(100, 0);
+    FwFFT xf2(100, 0);
+    assert( xf1.forwardPlan(32) == pf );
+    assert( xf2.forwardPlan(32) == pf );
+    assert( xf2.backwardPlan(32) == pb );
+  }
+  assert( cache.size() == nplan0 + 6 );
+  {
+    Fw2dFFT xf2d(1000, 0);
+    assert( xf2d.forwardInPlacePlan({4, 8}) == cache.forward2dPlan({4, 8}, true, flag) );
+  }
+  assert( cache.size() == nplan0 + 6 );
+
+  cout << myname << line << endl;
+  cout << myname << "Transform concurrently." << endl;
+  Index nsam = 64;
+  Index nthr = 16;
+  vector<float> errs(nthr, -1.0);
+  tbb::parallel_for(Index(0), nthr, [&errs, nsam](Index ithr) {
+    FwFFT xf(nsam, 0);
+    FwFFT::FloatVector sams(nsam);
+    for ( Index isam=0; isam<nsam; ++isam ) sams[isam] = sin(0.1*(ithr+1)*isam);
+    FwFFT::DFT dft(RealDftNormalization(22));
+    FwFFT::FloatVector sams2;
+    for ( Index irep=0; irep<20; ++irep ) {
+      assert( xf.fftForward(sams, dft) == 0 );
+      assert( xf.fftInverse(dft, sams2) == 0 );
+    }
+    float err = 0.0;
+    for ( Index isam=0; isam<nsam; ++isam ) err = std::max(err, float(fabs(sams2[isam] - sams[isam])));
+    errs[ithr] = err;
+  });
+  for ( float err : errs ) {
+    assert( err >= 0.0 );
+    assert( err < 1.e-5 );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Export and import wisdom." << endl;
+  string fnam = "test_FftwPlanCache.wisdom";
+  assert( cache.exportWisdom(fnam) == 0 );
+  assert( cache.importWisdom(fnam) == 0 );
+  assert( FftwPlanCache<float>::instance().importWisdom("nosuchdir/nosuchfile") != 0 );
+  std::remove(fnam.c_str());
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_FftwPlanCache();
+}
+
+//**********************************************************************
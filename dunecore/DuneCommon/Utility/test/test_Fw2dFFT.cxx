@@ -6,6 +6,7 @@
 // Test Fw2dFFT.
 
 #include "dunecore/DuneCommon/Utility/Fw2dFFT.h"
+#include "dunecore/DuneInterface/Data/Tpc2dRoi.h"
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -187,6 +188,108 @@ int test_Fw2dFFT(Index ignorm, Index itnorm, int loglev) {
   assert( bstat == 0 );
   assert( printData(dat, dat2) );
 
+  cout << myname << line << endl;
+  cout << myname << "Transform in place." << endl;
+  Tpc2dRoi roi(n0, n1, 100, 1000);
+  roi.data().copyDataIn(sams);
+  Tpc2dRoi::Buffer& buf = roi.loadBuffer();
+  assert( buf.rowStride() == 2*(n1/2 + 1) );
+  assert( ! buf.isDft() );
+  assert( xf.fftForward(buf, norm, loglev) == 0 );
+  assert( buf.isDft() );
+  assert( buf.complexSize() == dft.size() );
+  for ( Index idat=0; idat<dft.size(); ++idat ) {
+    assert( std::abs(buf.complexData()[idat] - dft.data()[idat]) < 1.e-4 );
+  }
+  assert( roi.unloadBuffer() == 2 );
+  assert( xf.fftBackward(buf, norm, loglev) == 0 );
+  roi.data().scale(0.0);
+  assert( roi.unloadBuffer() == 0 );
+  assert( roi.buffer() == nullptr );
+  assert( printData(dat, roi.data()) );
+  assert( Tpc2dRoiBufferPool::threadPool().bufferCount() == 1 );
+  roi.loadBuffer();
+  assert( Tpc2dRoiBufferPool::threadPool().bufferCount() == 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Transform in place with single precision." << endl;
+  Tpc2dRoiFloatBuffer fbuf;
+  fbuf.copyIn(dat);
+  assert( fbuf.rowStride() == 2*(n1/2 + 1) );
+  assert( xf.fftForward(fbuf, norm, loglev) == 0 );
+  assert( fbuf.isDft() );
+  assert( xf.fftForward(fbuf, norm, loglev) == 1 );
+  for ( Index idat=0; idat<dft.size(); ++idat ) {
+    Complex val(fbuf.complexData()[idat].real(), fbuf.complexData()[idat].imag());
+    assert( std::abs(val - dft.data()[idat]) < 1.e-3*(1.0 + std::abs(val)) );
+  }
+  assert( xf.fftBackward(fbuf, norm, loglev) == 0 );
+  Data dat3;
+  assert( fbuf.copyOut(dat3) == 0 );
+  assert( printData(dat, dat3) );
+
+  cout << myname << line << endl;
+  cout << myname << "Filter in place." << endl;
+  // Unit filter leaves the data unchanged.
+  fbuf.copyIn(dat);
+  Fw2dFFT::FloatComplexVector ffil(fbuf.complexSize(), 1.0);
+  assert( xf.fftFilter(fbuf, ffil, loglev) == 0 );
+  assert( ! fbuf.isDft() );
+  assert( fbuf.copyOut(dat3) == 0 );
+  assert( printData(dat, dat3) );
+  // Filter with the DFT of a delta function at (1, 2) shifts the data.
+  Tpc2dRoiBuffer dbuf;
+  dbuf.copyIn(dat);
+  Fw2dFFT::ComplexVector dfil(dbuf.complexSize());
+  Index ncmp1 = dbuf.complexRowSize();
+  for ( Index ifrq0=0; ifrq0<n0; ++ifrq0 ) {
+    for ( Index ifrq1=0; ifrq1<ncmp1; ++ifrq1 ) {
+      double arg = -2.0*M_PI*(double(ifrq0)/n0 + 2.0*ifrq1/n1);
+      dfil[ifrq0*ncmp1 + ifrq1] = Complex(cos(arg), sin(arg));
+    }
+  }
+  assert( xf.fftFilter(dbuf, dfil, loglev) == 0 );
+  for ( Index irow=0; irow<n0; ++irow ) {
+    for ( Index icol=0; icol<n1; ++icol ) {
+      float val = dat.value({(irow + n0 - 1)%n0, (icol + n1 - 2)%n1});
+      assert( fabs(dbuf.row(irow)[icol] - val) < 1.e-4 );
+    }
+  }
+  assert( xf.fftFilter(dbuf, Fw2dFFT::ComplexVector(3), loglev) == 3 );
+
+  cout << myname << line << endl;
+  cout << myname << "Multi-threaded plans." << endl;
+  Fw2dFFT xfthr(0, 0, 4);
+  assert( xfthr.threadCount(nsams) == 1 );
+  assert( xfthr.threadCount({256, 6000}) == 4 );
+  fbuf.copyIn(dat);
+  assert( xfthr.fftForward(fbuf, norm, loglev) == 0 );
+  assert( xfthr.fftBackward(fbuf, norm, loglev) == 0 );
+  assert( fbuf.copyOut(dat3) == 0 );
+  assert( printData(dat, dat3) );
+  {
+    IndexArray nsamsBig = {256, 300};
+    assert( xfthr.threadCount(nsamsBig) == 4 );
+    Index nbig = nsamsBig[0]*nsamsBig[1];
+    assert( nbig >= Fw2dFFT::threadMinSize() );
+    vector<float> bigsams(nbig);
+    for ( Index isam=0; isam<nbig; ++isam ) bigsams[isam] = sin(0.01*isam) + 0.001*(isam%97);
+    Data datBig(nsamsBig, bigsams);
+    Tpc2dRoiFloatBuffer bigbuf;
+    bigbuf.copyIn(datBig);
+    assert( xfthr.fftForward(bigbuf, norm, loglev) == 0 );
+    assert( xfthr.fftBackward(bigbuf, norm, loglev) == 0 );
+    Data datBig2;
+    assert( bigbuf.copyOut(datBig2) == 0 );
+    assert( datBig2.nSamples() == nsamsBig );
+    IndexArray isams;
+    for ( isams[0]=0; isams[0]<nsamsBig[0]; ++isams[0] ) {
+      for ( isams[1]=0; isams[1]<nsamsBig[1]; ++isams[1] ) {
+        assert( fabs(datBig2.value(isams) - datBig.value(isams)) < 1.e-3 );
+      }
+    }
+  }
+
 /*
   cout << myname << line << endl;
   cout << myname << "Check power." << endl;
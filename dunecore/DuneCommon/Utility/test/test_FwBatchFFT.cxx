@@ -0,0 +1,147 @@
+// test_FwBatchFFT.cxx
+//
+// Test FwBatchFFT.
+
+#include "dunecore/DuneCommon/Utility/FwBatchFFT.h"
+#include "dunecore/DuneCommon/Utility/FwFFT.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Index = unsigned int;
+using FloatVector = vector<float>;
+
+//**********************************************************************
+
+template<typename F>
+int test_FwBatchFFT(Index nsam, Index ncha, Index nbat, Index inorm, float tol) {
+  const string myname = "test_FwBatchFFT: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+  using BFFT = FwBatchFFT<F>;
+  using DFT = typename BFFT::DFT;
+  using Norm = typename BFFT::Norm;
+
+  cout << myname << line << endl;
+  cout << myname << "Precision: " << FftwTraits<F>::name() << endl;
+  cout << myname << "Samples: " << nsam << ", channels: " << ncha
+       << ", batch: " << nbat << ", norm: " << inorm << endl;
+  Norm norm(inorm);
+  assert( norm.isValid() );
+
+  cout << myname << line << endl;
+  cout << myname << "Create data." << endl;
+  FloatVector sams(nsam*ncha);
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    for ( Index isam=0; isam<nsam; ++isam ) {
+      sams[icha*nsam + isam] = 10.0*sin(0.3*(icha+1)*isam) + 0.1*icha - 0.02*isam;
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Transform to DFT objects and compare with FwFFT." << endl;
+  BFFT xf(0, nbat);
+  typename BFFT::DftVector dfts;
+  assert( xf.fftForward(nsam, ncha, sams.data(), norm, dfts) == 0 );
+  assert( dfts.size() == ncha );
+  FwFFT xf1(nsam, 0);
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    DFT dft1(norm);
+    assert( xf1.fftForward(nsam, &sams[icha*nsam], dft1) == 0 );
+    const DFT& dft = dfts[icha];
+    assert( dft.nSample() == nsam );
+    assert( dft.nAmplitude() == dft1.nAmplitude() );
+    assert( dft.nPhase() == dft1.nPhase() );
+    for ( Index ifrq=0; ifrq<dft.nAmplitude(); ++ifrq ) {
+      float amp = dft.compactAmplitude(ifrq);
+      float amp1 = dft1.compactAmplitude(ifrq);
+      assert( fabs(amp - amp1) < tol*(1.0 + fabs(amp1)) );
+      if ( ifrq < dft.nPhase() && fabs(amp1) > 1.e-3 ) {
+        float dpha = dft.compactPhase(ifrq) - dft1.compactPhase(ifrq);
+        assert( fabs(sin(dpha)) < 10*tol );
+      }
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Transform to complex and back." << endl;
+  typename BFFT::ComplexVector cdfts;
+  assert( xf.fftForward(nsam, ncha, sams.data(), norm, cdfts) == 0 );
+  Index ncmp = BFFT::nComplex(nsam);
+  assert( cdfts.size() == ncha*ncmp );
+  // Zero-frequency term is the sum with global normalization.
+  float sum0 = 0.0;
+  for ( Index isam=0; isam<nsam; ++isam ) sum0 += sams[isam];
+  float fac0 = norm.isConsistent() ? 1.0/sqrt(nsam) : norm.isBin() ? 1.0/nsam : 1.0;
+  assert( fabs(cdfts[0].real() - fac0*sum0) < tol*(1.0 + fabs(sum0)) );
+  FloatVector sams2;
+  assert( xf.fftBackward(nsam, cdfts, norm, sams2) == 0 );
+  assert( sams2.size() == sams.size() );
+  for ( Index ival=0; ival<sams.size(); ++ival ) {
+    assert( fabs(sams2[ival] - sams[ival]) < tol*(1.0 + fabs(sams[ival])) );
+  }
+  assert( xf.fftBackward(nsam, typename BFFT::ComplexVector(ncmp + 1), norm, sams2) == 1 );
+
+  cout << myname << line << endl;
+  cout << myname << "Transform channel map." << endl;
+  AdcChannelDataMap acds;
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    AdcChannelData& acd = acds[100 + icha];
+    acd.setChannelInfo(100 + icha);
+    acd.samples.assign(sams.begin() + icha*nsam, sams.begin() + (icha+1)*nsam);
+  }
+  // Add an empty channel with a stale DFT.
+  acds[99].setChannelInfo(99);
+  acds[99].dftmags.resize(10, 1.0);
+  assert( xf.updateDft(acds) == 0 );
+  assert( acds[99].dftmags.empty() );
+  Norm accnorm(AdcChannelData::dftNormalization());
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    const AdcChannelData& acd = acds[100 + icha];
+    DFT dft1(accnorm);
+    assert( xf1.fftForward(nsam, &sams[icha*nsam], dft1) == 0 );
+    assert( acd.dftmags.size() == dft1.nAmplitude() );
+    assert( acd.dftphases.size() == dft1.nPhase() );
+    for ( Index ifrq=0; ifrq<dft1.nAmplitude(); ++ifrq ) {
+      float amp1 = dft1.compactAmplitude(ifrq);
+      assert( fabs(acd.dftmags[ifrq] - amp1) < tol*(1.0 + fabs(amp1)) );
+    }
+  }
+  // Complex transform requires a common sample count.
+  Index nsamOut = 0;
+  assert( xf.fftForward(acds, norm, cdfts, nsamOut) == 1 );
+  acds.erase(99);
+  assert( xf.fftForward(acds, norm, cdfts, nsamOut) == 0 );
+  assert( nsamOut == nsam );
+  assert( cdfts.size() == ncha*ncmp );
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  for ( Index inorm : {11, 12, 13, 21, 22, 23} ) {
+    assert( test_FwBatchFFT<double>(20, 5, 0, inorm, 1.e-5) == 0 );
+  }
+  assert( test_FwBatchFFT<double>(21, 7, 3, 22, 1.e-5) == 0 );
+  assert( test_FwBatchFFT<float>(64, 10, 0, 22, 1.e-4) == 0 );
+  assert( test_FwBatchFFT<float>(63, 10, 4, 12, 1.e-4) == 0 );
+  return 0;
+}
+
+//**********************************************************************
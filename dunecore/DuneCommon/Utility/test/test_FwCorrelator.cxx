@@ -0,0 +1,215 @@
+// test_FwCorrelator.cxx
+//
+// Test FwCorrelator and CorrelationMatrix.
+
+#include "dunecore/DuneCommon/Utility/FwCorrelator.h"
+#include "dunecore/DuneCommon/Utility/FftwPlanCache.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Index = FwCorrelator::Index;
+using IndexVector = FwCorrelator::IndexVector;
+using FloatVector = FwCorrelator::FloatVector;
+
+//**********************************************************************
+
+bool near(float x1, float x2, float tol =1.e-3) {
+  return fabs(x1 - x2) < tol*(1.0 + fabs(x1) + fabs(x2));
+}
+
+// Pseudo-random samples for channel icha with a shared waveform delayed by icha ticks.
+FloatVector samples(Index nsam, Index icha) {
+  FloatVector sams(nsam);
+  unsigned int seed = 1000003*(icha + 1);
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    seed = 1664525*seed + 1013904223;
+    float noise = (seed >> 8)/float(1 << 24) - 0.5;
+    sams[isam] = 0.2*noise + 2.0*sin(0.07*(float(isam) - icha)) + 1.0;
+  }
+  return sams;
+}
+
+// Direct evaluation of sum_t a[t] b[t+lag] after optional mean subtraction and
+// normalization.
+float direct(const FloatVector& a0, const FloatVector& b0, int lag, bool norm) {
+  FloatVector a = a0;
+  FloatVector b = b0;
+  if ( norm ) {
+    for ( FloatVector* pv : {&a, &b} ) {
+      double mean = 0.0;
+      for ( float val : *pv ) mean += val;
+      mean /= pv->size();
+      for ( float& val : *pv ) val -= mean;
+    }
+  }
+  double sum = 0.0;
+  for ( int it=0; it<int(a.size()); ++it ) {
+    int jt = it + lag;
+    if ( jt >= 0 && jt < int(b.size()) ) sum += a[it]*b[jt];
+  }
+  if ( norm ) {
+    double suma = 0.0;
+    double sumb = 0.0;
+    for ( float val : a ) suma += val*val;
+    for ( float val : b ) sumb += val*val;
+    sum /= sqrt(suma*sumb);
+  }
+  return sum;
+}
+
+//**********************************************************************
+
+int test_FwCorrelator(Index nsam, Index ncha, Index maxLag, bool norm, bool parallel) {
+  const string myname = "test_FwCorrelator: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+  cout << myname << line << endl;
+  cout << myname << "Samples: " << nsam << ", channels: " << ncha << ", max lag: " << maxLag
+       << ", normalize: " << norm << ", parallel: " << parallel << endl;
+  FwCorrelator cor(nsam, maxLag, norm, parallel);
+  assert( cor.nSample() == nsam );
+  assert( cor.maxLag() == maxLag );
+  assert( cor.nLag() == 2*maxLag + 1 );
+  assert( cor.fftSize() >= nsam + maxLag );
+  assert( FftwPlanCache<float>::isGoodSize(cor.fftSize()) );
+  cout << myname << "FFT size: " << cor.fftSize() << endl;
+  vector<FloatVector> chsams(ncha);
+  FloatVector block;
+  IndexVector chans;
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    chsams[icha] = samples(nsam, icha);
+    block.insert(block.end(), chsams[icha].begin(), chsams[icha].end());
+    chans.push_back(200 + icha);
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Correlate with a reference." << endl;
+  FloatVector cors;
+  assert( cor.correlate(ncha, block.data(), cors) == 1 );
+  Index nref = nsam/4;
+  FloatVector ref(chsams[0].begin(), chsams[0].begin() + nref);
+  assert( cor.setReference(ref) == 0 );
+  assert( cor.haveReference() );
+  assert( cor.correlate(ncha, block.data(), cors) == 0 );
+  assert( cors.size() == ncha*cor.nLag() );
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    for ( Index ilag=0; ilag<cor.nLag(); ++ilag ) {
+      int lag = int(ilag) - int(maxLag);
+      float exp = direct(ref, chsams[icha], lag, false);
+      if ( norm ) {
+        // The reference and channel are mean-subtracted separately.
+        FloatVector refz = ref;
+        FloatVector samz = chsams[icha];
+        double mref = 0.0;
+        double msam = 0.0;
+        for ( float val : refz ) mref += val;
+        for ( float val : samz ) msam += val;
+        mref /= nref;
+        msam /= nsam;
+        double sumr = 0.0;
+        double sums = 0.0;
+        for ( float& val : refz ) { val -= mref; sumr += val*val; }
+        for ( float& val : samz ) { val -= msam; sums += val*val; }
+        exp = direct(refz, samz, lag, false)/sqrt(sumr*sums);
+      }
+      assert( near(cors[icha*cor.nLag() + ilag], exp) );
+    }
+  }
+  assert( cor.setReference(FloatVector(nsam + 1, 1.0)) != 0 );
+  assert( ! cor.haveReference() );
+
+  cout << myname << line << endl;
+  cout << myname << "Correlate pairs." << endl;
+  CorrelationMatrix cmat;
+  assert( cor.correlatePairs(chans, block.data(), cmat) == 0 );
+  assert( cmat.size() == ncha );
+  assert( cmat.channels() == chans );
+  for ( Index icha=0; icha<ncha; ++icha ) {
+    for ( Index jcha=0; jcha<ncha; ++jcha ) {
+      float exp0 = direct(chsams[icha], chsams[jcha], 0, norm);
+      assert( near(cmat.zeroLag(icha, jcha), exp0) );
+      int peakLag = cmat.peakLag(icha, jcha);
+      assert( std::abs(peakLag) <= int(maxLag) );
+      assert( cmat.peakLag(jcha, icha) == -peakLag );
+      assert( near(cmat.peak(icha, jcha), direct(chsams[icha], chsams[jcha], peakLag, norm)) );
+      for ( int lag=-int(maxLag); lag<=int(maxLag); ++lag ) {
+        assert( fabs(direct(chsams[icha], chsams[jcha], lag, norm)) <= fabs(cmat.peak(icha, jcha)) + 1.e-3 );
+      }
+    }
+    if ( norm ) assert( near(cmat.zeroLag(icha, icha), 1.0) );
+  }
+  if ( ncha <= 8 ) cmat.print(cout, myname);
+
+  cout << myname << line << endl;
+  cout << myname << "Correlate pairs from a channel map." << endl;
+  {
+    AdcChannelDataMap acds;
+    for ( Index icha=0; icha<ncha; ++icha ) {
+      AdcChannelData& acd = acds[chans[icha]];
+      acd.setChannelInfo(chans[icha]);
+      acd.samples = chsams[icha];
+    }
+    CorrelationMatrix cmat2;
+    assert( cor.correlatePairs(acds, cmat2) == 0 );
+    assert( cmat2.zeroLags() == cmat.zeroLags() );
+    assert( cmat2.peakLags() == cmat.peakLags() );
+    cout << myname << "Correlate pairs from referenced samples." << endl;
+    AdcChannelDataMap vacds;
+    for ( auto& iacd : acds ) {
+      vacds[iacd.first] = std::move(iacd.second.addSampleView("ref", 0, nsam));
+      assert( vacds[iacd.first].hasSampleRef() );
+    }
+    CorrelationMatrix cmat3;
+    assert( cor.correlatePairs(vacds, cmat3) == 0 );
+    assert( cmat3.zeroLags() == cmat.zeroLags() );
+    assert( cmat3.peakLags() == cmat.peakLags() );
+    acds[chans[0]].samples.push_back(0.0);
+    assert( cor.correlatePairs(acds, cmat2) != 0 );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Write to and read from a DataMap." << endl;
+  {
+    DataMap res;
+    cmat.fill(res);
+    cmat.fill(res, "other");
+    assert( res.haveFloatVector("corrZeroLag") );
+    assert( res.getInt("otherMaxLag") == int(maxLag) );
+    CorrelationMatrix cmat2;
+    assert( cmat2.read(res) == 0 );
+    assert( cmat2.channels() == chans );
+    assert( cmat2.maxLag() == maxLag );
+    assert( cmat2.zeroLags() == cmat.zeroLags() );
+    assert( cmat2.peaks() == cmat.peaks() );
+    assert( cmat2.peakLags() == cmat.peakLags() );
+    assert( cmat2.read(res, "nosuch") != 0 );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  if ( test_FwCorrelator(100, 5, 10, false, false) ) return 1;
+  if ( test_FwCorrelator(100, 5, 10, true, true) ) return 1;
+  if ( test_FwCorrelator(500, 20, 40, true, true) ) return 1;
+  return 0;
+}
+
+//**********************************************************************
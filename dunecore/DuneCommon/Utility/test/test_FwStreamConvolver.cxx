@@ -0,0 +1,111 @@
+// test_FwStreamConvolver.cxx
+//
+// Test FwStreamConvolver.
+
+#include "dunecore/DuneCommon/Utility/FwStreamConvolver.h"
+#include <string>
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Index = FwStreamConvolver::Index;
+using FloatVector = FwStreamConvolver::FloatVector;
+using DoubleVector = FwStreamConvolver::DoubleVector;
+
+//**********************************************************************
+
+int test_FwStreamConvolver(Index nsam, Index nfft) {
+  const string myname = "test_FwStreamConvolver: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+
+  cout << myname << line << endl;
+  cout << myname << "Sample count: " << nsam << ", FFT size: " << nfft << endl;
+  FloatVector sams(nsam);
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    sams[isam] = 10.0*sin(0.05*isam) + (isam%17 == 3 ? 20.0 : 0.0) - 0.001*isam;
+  }
+  FloatVector response = {1.0, 0.5, 0.25, 0.1};
+  Index nres = response.size();
+
+  cout << myname << line << endl;
+  cout << myname << "Create convolver." << endl;
+  FwStreamConvolver con(response, nfft);
+  assert( con.convolutionKernel() != nullptr );
+  assert( con.deconvolutionKernel() == nullptr );
+  Index nfftUsed = con.convolutionKernel()->nfft;
+  cout << myname << "Block size: " << con.convolutionKernel()->blockSize() << endl;
+  assert( nfftUsed == (nfft ? nfft : FwStreamConvolver::defaultFftSize(nres)) );
+
+  cout << myname << line << endl;
+  cout << myname << "Convolute full waveform." << endl;
+  FloatVector csams = sams;
+  assert( con.Convolute(csams) == 0 );
+  assert( csams.size() == nsam );
+  for ( Index isam=0; isam<nsam; ++isam ) {
+    double sum = 0.0;
+    for ( Index ires=0; ires<nres && ires<=isam; ++ires ) sum += response[ires]*sams[isam - ires];
+    assert( fabs(csams[isam] - sum) < 1.e-4*(1.0 + fabs(sum)) );
+  }
+  DoubleVector dsams(sams.begin(), sams.end());
+  assert( con.Convolute(dsams) == 0 );
+  for ( Index isam=0; isam<nsam; ++isam ) assert( fabs(dsams[isam] - csams[isam]) < 1.e-4 );
+
+  cout << myname << line << endl;
+  cout << myname << "Convolute in chunks." << endl;
+  FwStreamConvolver::Stream str = con.convolutionStream();
+  FloatVector ssams;
+  Index ichk = 0;
+  for ( Index isam=0; isam<nsam; ichk = (ichk + 37) % 101 ) {
+    Index nchk = std::min(ichk, nsam - isam);
+    assert( str.process(&sams[isam], nchk, ssams) == 0 );
+    isam += nchk;
+    assert( str.inputCount() == isam );
+    assert( ssams.size() <= isam );
+  }
+  assert( str.finish(ssams) == 0 );
+  assert( ssams.size() == nsam );
+  for ( Index isam=0; isam<nsam; ++isam ) assert( ssams[isam] == csams[isam] );
+  assert( str.inputCount() == 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Deconvolute." << endl;
+  FwStreamConvolver::Stream bad = con.deconvolutionStream();
+  assert( ! bad.isValid() );
+  assert( con.Deconvolute(csams) == 1 );
+  FloatVector filter(513, 1.0);
+  assert( con.setFilter(filter, 101) == 0 );
+  assert( con.deconvolutionKernel() != nullptr );
+  assert( con.deconvolutionKernel()->koff == 50 );
+  FloatVector dcsams = csams;
+  assert( con.Deconvolute(dcsams) == 0 );
+  assert( dcsams.size() == nsam );
+  for ( Index isam=0; isam<nsam; ++isam ) assert( fabs(dcsams[isam] - sams[isam]) < 1.e-3 );
+  assert( con.setFilter(FloatVector(2, 1.0), 101) != 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  if ( test_FwStreamConvolver(1000, 0) ) return 1;
+  if ( test_FwStreamConvolver(5000, 128) ) return 1;
+  if ( test_FwStreamConvolver(7, 256) ) return 1;
+  return 0;
+}
+
+//**********************************************************************
@@ -0,0 +1,132 @@
+// AdcAttribute.h
+//
+// Pre-parsed attribute name for fast attribute access in AdcChannelData.
+//
+// An AdcAttribute is constructed from an attribute name such as "pedestal",
+// "../channel" or the name of a metadata field. The leading "../" (any number
+// of times) is counted to give the number of parent levels and the remaining
+// name is classified as one of the AdcChannelData built-in attributes (run,
+// channel, pedestal, ...) or as metadata. Tools should construct their
+// attributes when they are configured and then use the AdcAttribute accessors
+// in AdcChannelData, e.g.
+//   m_pedAtt = AdcAttribute("pedestal");
+//   ...
+//   float ped = acd.getAttribute(m_pedAtt);
+// so that the per-channel access is a switch on the built-in key and, for
+// metadata, a search of the key-sorted metadata index with the field key,
+// a 64-bit hash of the name computed here.
+//
+// The built-in names are held in a table that is filled once and only read
+// afterwards, so attributes may be constructed and used concurrently and no
+// names are accumulated at run time.
+
+#ifndef AdcAttribute_H
+#define AdcAttribute_H
+
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+class AdcAttribute {
+
+public:
+
+  using Key = unsigned int;
+  using Name = std::string;
+  using FieldKey = std::uint64_t;
+
+  // Keys for the built-in AdcChannelData attributes.
+  // Key MetadataField is used for all other names.
+  enum Builtin : Key {
+    Run, SubRun, Event, Trigger, TriggerClock, ChannelClock, ChannelClockOffset,
+    Channel, FembID, FembChannel, Pedestal, PedestalRms, SampleNoise,
+    DigitIndex, WireIndex, Raw, Samples, Flags, Signal, Rois, DftMags, DftPhases,
+    Digit, Wire, Metadata,
+    MetadataField
+  };
+
+  // Return the key for a name without leading "../": MetadataField if the
+  // name is not that of a built-in attribute.
+  static Key builtinKey(const Name& nam) {
+    const std::unordered_map<Name, Key>& keys = builtinKeys();
+    std::unordered_map<Name, Key>::const_iterator ikey = keys.find(nam);
+    return ikey == keys.end() ? Key(MetadataField) : ikey->second;
+  }
+
+  // Return the name for a built-in key.
+  static const Name& builtinName(Key k) {
+    static const Name names[] = {
+      "run", "subRun", "event", "trigger", "triggerClock",
+      "channelClock", "channelClockOffset", "channel",
+      "fembID", "fembChannel", "pedestal", "pedestalRms",
+      "sampleNoise", "digitIndex", "wireIndex", "raw",
+      "samples", "flags", "signal", "rois", "dftmags",
+      "dftphases", "digit", "wire", "metadata", ""
+    };
+    return names[k < MetadataField ? k : Key(MetadataField)];
+  }
+
+  // Return the field key for a name without leading "../" (FNV-1a hash).
+  static FieldKey fieldKey(const Name& nam) {
+    FieldKey h = 14695981039346656037ull;
+    for ( unsigned char c : nam ) {
+      h ^= c;
+      h *= 1099511628211ull;
+    }
+    return h;
+  }
+
+  // Ctor from a built-in key and parent level.
+  AdcAttribute(Builtin k, Key lev =0)
+  : m_key(k), m_level(lev), m_name(builtinName(k)), m_fieldKey(fieldKey(m_name)) { }
+
+  // Ctor from a name.
+  explicit AdcAttribute(const Name& nam) {
+    Name::size_type ipos = 0;
+    while ( nam.compare(ipos, 3, "../") == 0 ) {
+      ++m_level;
+      ipos += 3;
+    }
+    m_name = nam.substr(ipos);
+    m_key = builtinKey(m_name);
+    m_fieldKey = fieldKey(m_name);
+  }
+
+  // Return the key, the number of parent levels and the name without "../".
+  Key key() const { return m_key; }
+  Key level() const { return m_level; }
+  const Name& name() const { return m_name; }
+
+  // Return the key used to look up the name in the metadata index.
+  FieldKey fieldKey() const { return m_fieldKey; }
+
+  // Return if this is a built-in attribute or a metadata field.
+  bool isBuiltin() const { return m_key < MetadataField; }
+  bool isMetadata() const { return m_key == MetadataField; }
+
+  // Return the full name including "../".
+  Name fullName() const {
+    Name pre;
+    for ( Key ilev=0; ilev<m_level; ++ilev ) pre += "../";
+    return pre + m_name;
+  }
+
+private:
+
+  static const std::unordered_map<Name, Key>& builtinKeys() {
+    static const std::unordered_map<Name, Key> keys = [] {
+      std::unordered_map<Name, Key> out;
+      for ( Key k=0; k<MetadataField; ++k ) out[builtinName(k)] = k;
+      return out;
+    }();
+    return keys;
+  }
+
+  Key m_key =MetadataField;
+  Key m_level =0;
+  Name m_name;
+  FieldKey m_fieldKey =0;
+
+};
+
+#endif
@@ -0,0 +1,352 @@
+// AdcBitMask.h
+//
+// Word-packed per-tick mask, e.g. for signal or filter flags.
+//
+// This is an alternative to AdcFilterVector (std::vector<bool>) and the
+// ROI vector AdcRoiVector. Bits are held in 64-bit words so that counting
+// and iteration proceed a word at a time (popcount and count-trailing-zeros)
+// and run-length conversion to and from ROIs skips whole words of set or
+// unset ticks.
+//
+// The mask can be built directly from a sample array with a threshold. The
+// comparison loop is written without branches so the compiler can vectorize
+// it.
+//
+// Bits beyond size() in the last word are always zero.
+//
+// Usage:
+//   AdcBitMask sig(acd.samples, 10.0, true);   // |sample| > 10
+//   sig.dilate(5, 10);                          // extend 5 before, 10 after
+//   acd.setSignal(sig);                         // fill signal and rois
+
+#ifndef AdcBitMask_H
+#define AdcBitMask_H
+
+#include "dunecore/DuneInterface/Data/AdcTypes.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+class AdcBitMask {
+
+public:
+
+  using Index = AdcIndex;
+  using Word = std::uint64_t;
+  using WordVector = std::vector<Word>;
+
+  static constexpr Index wordBits() { return 64; }
+  static Index badIndex() { return -1; }
+
+  // Number of words needed for nbit bits.
+  static Index wordCount(Index nbit) { return (nbit + wordBits() - 1)/wordBits(); }
+
+  // Ctor for nbit bits all set to val.
+  explicit AdcBitMask(Index nbit =0, bool val =false) { resize(nbit, val); }
+
+  // Ctor from a filter vector.
+  explicit AdcBitMask(const AdcFilterVector& filt);
+
+  // Ctor from ROIs. ROI ticks beyond nbit are ignored.
+  AdcBitMask(const AdcRoiVector& rois, Index nbit);
+
+  // Ctor from samples: bit is set where sample > thresh or, if useAbs is
+  // true, where |sample| > thresh.
+  AdcBitMask(const AdcSignalVector& sams, AdcSignal thresh, bool useAbs =false) {
+    setFromThreshold(sams.data(), sams.size(), thresh, useAbs);
+  }
+
+  // Ctor from flags: bit is set where flag != AdcGood.
+  explicit AdcBitMask(const AdcFlagVector& flags);
+
+  // Size.
+  Index size() const { return m_nbit; }
+  bool empty() const { return m_nbit == 0; }
+  void resize(Index nbit, bool val =false);
+  void clear() { m_nbit = 0; m_words.clear(); }
+
+  // Raw words.
+  const WordVector& words() const { return m_words; }
+
+  // Single-bit access.
+  bool test(Index ibit) const { return (m_words[ibit/wordBits()] >> (ibit%wordBits())) & 1; }
+  bool operator[](Index ibit) const { return test(ibit); }
+  void set(Index ibit) { m_words[ibit/wordBits()] |= Word(1) << (ibit%wordBits()); }
+  void reset(Index ibit) { m_words[ibit/wordBits()] &= ~(Word(1) << (ibit%wordBits())); }
+  void set(Index ibit, bool val) { if ( val ) set(ibit); else reset(ibit); }
+
+  // Set or reset the bits in [ibeg, iend).
+  void setRange(Index ibeg, Index iend, bool val =true);
+
+  // Number of set bits.
+  Index count() const;
+
+  // Return if any or all bits are set.
+  bool any() const;
+  bool all() const { return count() == m_nbit; }
+
+  // Return the first set bit at or after ibit or badIndex() if none.
+  Index findNext(Index ibit =0) const;
+
+  // Return the first unset bit at or after ibit or size() if none.
+  Index findNextUnset(Index ibit =0) const;
+
+  // Call fun(ibit) for each set bit in increasing order.
+  template<class F>
+  void forEachSet(F fun) const;
+
+  // Set bits from a sample array.
+  void setFromThreshold(const AdcSignal* psam, Index nsam, AdcSignal thresh, bool useAbs =false);
+
+  // Extend each set range by nbef bits before and naft bits after.
+  void dilate(Index nbef, Index naft);
+
+  // Bitwise operations. Sizes must match.
+  AdcBitMask& operator&=(const AdcBitMask& rhs);
+  AdcBitMask& operator|=(const AdcBitMask& rhs);
+  AdcBitMask& operator^=(const AdcBitMask& rhs);
+  AdcBitMask& flip();
+
+  bool operator==(const AdcBitMask& rhs) const {
+    return m_nbit == rhs.m_nbit && m_words == rhs.m_words;
+  }
+  bool operator!=(const AdcBitMask& rhs) const { return !(*this == rhs); }
+
+  // Conversions.
+  // ROIs are inclusive tick ranges as in AdcChannelData::rois.
+  AdcFilterVector toFilter() const;
+  void toFilter(AdcFilterVector& filt) const;
+  AdcRoiVector toRois() const;
+  void toRois(AdcRoiVector& rois) const;
+
+private:
+
+  static Word popcount(Word w) { return __builtin_popcountll(w); }
+  static Index ctz(Word w) { return __builtin_ctzll(w); }
+
+  // Mask for the used bits of the last word.
+  Word lastMask() const {
+    Index nrem = m_nbit%wordBits();
+    return nrem ? (Word(1) << nrem) - 1 : ~Word(0);
+  }
+  void trim() { if ( m_words.size() ) m_words.back() &= lastMask(); }
+
+  Index m_nbit =0;
+  WordVector m_words;
+
+};
+
+//**********************************************************************
+
+inline AdcBitMask::AdcBitMask(const AdcFilterVector& filt) {
+  resize(filt.size());
+  for ( Index ibit=0; ibit<m_nbit; ++ibit ) {
+    if ( filt[ibit] ) set(ibit);
+  }
+}
+
+//**********************************************************************
+
+inline AdcBitMask::AdcBitMask(const AdcRoiVector& rois, Index nbit) {
+  resize(nbit);
+  for ( const AdcRoi& roi : rois ) {
+    if ( roi.first >= nbit || roi.second < roi.first ) continue;
+    Index iend = roi.second < nbit ? roi.second + 1 : nbit;
+    setRange(roi.first, iend);
+  }
+}
+
+//**********************************************************************
+
+inline AdcBitMask::AdcBitMask(const AdcFlagVector& flags) {
+  resize(flags.size());
+  Index nwrd = m_words.size();
+  for ( Index iwrd=0; iwrd<nwrd; ++iwrd ) {
+    Index ibeg = iwrd*wordBits();
+    Index nbit = m_nbit - ibeg < wordBits() ? m_nbit - ibeg : wordBits();
+    const AdcFlag* pflg = flags.data() + ibeg;
+    Word w = 0;
+    for ( Index ibit=0; ibit<nbit; ++ibit ) w |= Word(pflg[ibit] != AdcGood) << ibit;
+    m_words[iwrd] = w;
+  }
+}
+
+//**********************************************************************
+
+inline void AdcBitMask::resize(Index nbit, bool val) {
+  Index nold = m_nbit;
+  m_nbit = nbit;
+  if ( val && nbit > nold && nold%wordBits() ) {
+    m_words.back() |= ~Word(0) << (nold%wordBits());
+  }
+  m_words.resize(wordCount(nbit), val ? ~Word(0) : Word(0));
+  trim();
+}
+
+//**********************************************************************
+
+inline void AdcBitMask::setRange(Index ibeg, Index iend, bool val) {
+  if ( iend > m_nbit ) iend = m_nbit;
+  if ( ibeg >= iend ) return;
+  Index iwbeg = ibeg/wordBits();
+  Index iwend = (iend - 1)/wordBits();
+  Word mbeg = ~Word(0) << (ibeg%wordBits());
+  Word mend = ~Word(0) >> (wordBits() - 1 - (iend - 1)%wordBits());
+  for ( Index iwrd=iwbeg; iwrd<=iwend; ++iwrd ) {
+    Word msk = ~Word(0);
+    if ( iwrd == iwbeg ) msk &= mbeg;
+    if ( iwrd == iwend ) msk &= mend;
+    if ( val ) m_words[iwrd] |= msk;
+    else m_words[iwrd] &= ~msk;
+  }
+}
+
+//**********************************************************************
+
+inline AdcBitMask::Index AdcBitMask::count() const {
+  Index nset = 0;
+  for ( Word w : m_words ) nset += popcount(w);
+  return nset;
+}
+
+//**********************************************************************
+
+inline bool AdcBitMask::any() const {
+  for ( Word w : m_words ) if ( w ) return true;
+  return false;
+}
+
+//**********************************************************************
+
+inline AdcBitMask::Index AdcBitMask::findNext(Index ibit) const {
+  if ( ibit >= m_nbit ) return badIndex();
+  Index iwrd = ibit/wordBits();
+  Word w = m_words[iwrd] & (~Word(0) << (ibit%wordBits()));
+  while ( true ) {
+    if ( w ) return iwrd*wordBits() + ctz(w);
+    if ( ++iwrd >= m_words.size() ) return badIndex();
+    w = m_words[iwrd];
+  }
+}
+
+//**********************************************************************
+
+inline AdcBitMask::Index AdcBitMask::findNextUnset(Index ibit) const {
+  if ( ibit >= m_nbit ) return m_nbit;
+  Index iwrd = ibit/wordBits();
+  Word w = ~m_words[iwrd] & (~Word(0) << (ibit%wordBits()));
+  while ( true ) {
+    if ( w ) {
+      Index iuns = iwrd*wordBits() + ctz(w);
+      return iuns < m_nbit ? iuns : m_nbit;
+    }
+    if ( ++iwrd >= m_words.size() ) return m_nbit;
+    w = ~m_words[iwrd];
+  }
+}
+
+//**********************************************************************
+
+template<class F>
+void AdcBitMask::forEachSet(F fun) const {
+  Index nwrd = m_words.size();
+  for ( Index iwrd=0; iwrd<nwrd; ++iwrd ) {
+    Word w = m_words[iwrd];
+    while ( w ) {
+      fun(iwrd*wordBits() + ctz(w));
+      w &= w - 1;
+    }
+  }
+}
+
+//**********************************************************************
+
+inline void
+AdcBitMask::setFromThreshold(const AdcSignal* psam, Index nsam, AdcSignal thresh, bool useAbs) {
+  resize(0);
+  resize(nsam);
+  Index nwrd = m_words.size();
+  for ( Index iwrd=0; iwrd<nwrd; ++iwrd ) {
+    Index ibeg = iwrd*wordBits();
+    Index nbit = nsam - ibeg < wordBits() ? nsam - ibeg : wordBits();
+    const AdcSignal* pwsam = psam + ibeg;
+    Word w = 0;
+    if ( useAbs ) {
+      for ( Index ibit=0; ibit<nbit; ++ibit ) w |= Word(std::fabs(pwsam[ibit]) > thresh) << ibit;
+    } else {
+      for ( Index ibit=0; ibit<nbit; ++ibit ) w |= Word(pwsam[ibit] > thresh) << ibit;
+    }
+    m_words[iwrd] = w;
+  }
+}
+
+//**********************************************************************
+
+inline void AdcBitMask::dilate(Index nbef, Index naft) {
+  if ( nbef == 0 && naft == 0 ) return;
+  AdcRoiVector rois = toRois();
+  for ( const AdcRoi& roi : rois ) {
+    Index ibeg = roi.first > nbef ? roi.first - nbef : 0;
+    Index iend = roi.second + 1 + naft;
+    if ( iend < roi.second ) iend = m_nbit;
+    setRange(ibeg, iend);
+  }
+}
+
+//**********************************************************************
+
+inline AdcBitMask& AdcBitMask::operator&=(const AdcBitMask& rhs) {
+  for ( Index iwrd=0; iwrd<m_words.size(); ++iwrd ) m_words[iwrd] &= rhs.m_words[iwrd];
+  return *this;
+}
+
+inline AdcBitMask& AdcBitMask::operator|=(const AdcBitMask& rhs) {
+  for ( Index iwrd=0; iwrd<m_words.size(); ++iwrd ) m_words[iwrd] |= rhs.m_words[iwrd];
+  return *this;
+}
+
+inline AdcBitMask& AdcBitMask::operator^=(const AdcBitMask& rhs) {
+  for ( Index iwrd=0; iwrd<m_words.size(); ++iwrd ) m_words[iwrd] ^= rhs.m_words[iwrd];
+  return *this;
+}
+
+inline AdcBitMask& AdcBitMask::flip() {
+  for ( Word& w : m_words ) w = ~w;
+  trim();
+  return *this;
+}
+
+//**********************************************************************
+
+inline void AdcBitMask::toFilter(AdcFilterVector& filt) const {
+  filt.assign(m_nbit, false);
+  forEachSet([&filt](Index ibit) { filt[ibit] = true; });
+}
+
+inline AdcFilterVector AdcBitMask::toFilter() const {
+  AdcFilterVector filt;
+  toFilter(filt);
+  return filt;
+}
+
+//**********************************************************************
+
+inline void AdcBitMask::toRois(AdcRoiVector& rois) const {
+  rois.clear();
+  Index ibeg = findNext(0);
+  while ( ibeg != badIndex() ) {
+    Index iend = findNextUnset(ibeg);
+    rois.push_back(AdcRoi(ibeg, iend - 1));
+    ibeg = findNext(iend);
+  }
+}
+
+inline AdcRoiVector AdcBitMask::toRois() const {
+  AdcRoiVector rois;
+  toRois(rois);
+  return rois;
+}
+
+//**********************************************************************
+
+#endif
@@ -0,0 +1,153 @@
+// AdcBufferPool.h
+//
+// Recycling pool for the per-tick vectors held in AdcChannelData
+// (raw, samples, flags, dftmags, dftphases).
+//
+// Buffers are returned to the pool instead of being freed and are handed
+// out again to later channels or events. Buffers are kept by capacity and a
+// request is served with the smallest pooled buffer that is large enough so
+// that, for the typical case where all channels have the same tick count,
+// memory is allocated for the first event only.
+//
+// Each thread has its own pool (threadPool()) so no locking is needed.
+// A buffer may be acquired on one thread and released on another.
+//
+// Usage:
+//   AdcBufferPool& pool = AdcBufferPool::threadPool();
+//   pool.acquire(acd, nsam);     // reserve raw, samples and flags
+//   ...
+//   pool.release(acd);           // return the buffers at event end
+//
+// TpcData::createAdcData(chans, nsam) acquires the channel buffers from the
+// thread pool and TpcData releases the ADC data it uniquely owns to the pool
+// when it is cleared or deleted.
+
+#ifndef AdcBufferPool_H
+#define AdcBufferPool_H
+
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include <map>
+#include <tuple>
+#include <cstddef>
+
+class AdcBufferPool {
+
+public:
+
+  using Size = std::size_t;
+
+  // Return the pool for the current thread.
+  static AdcBufferPool& threadPool() {
+    thread_local AdcBufferPool pool;
+    return pool;
+  }
+
+  // Set the maximum number of buffers of each element type held in the pool.
+  // Buffers released beyond this are freed.
+  void setMaxBuffers(Size nmax) { m_maxBuffers = nmax; }
+  Size maxBuffers() const { return m_maxBuffers; }
+
+  // Return the number of buffers of element type T in the pool.
+  template<typename T>
+  Size bufferCount() const { return store<T>().count; }
+
+  // Replace vec with an empty pooled buffer of capacity at least ncap.
+  // The original content of vec is released to the pool.
+  // Returns true if a pooled buffer was used.
+  template<typename T>
+  bool acquire(std::vector<T>& vec, Size ncap);
+
+  // Move the storage of vec into the pool. vec is left empty.
+  template<typename T>
+  void release(std::vector<T>& vec);
+
+  // Reserve raw, samples and flags for a channel.
+  void acquire(AdcChannelData& acd, Size nsam) {
+    acquire(acd.raw, nsam);
+    acquire(acd.samples, nsam);
+    acquire(acd.flags, nsam);
+  }
+
+  // Release the per-tick vectors of a channel and of its views.
+  void release(AdcChannelData& acd) {
+    release(acd.raw);
+    release(acd.samples);
+    release(acd.flags);
+    release(acd.dftmags);
+    release(acd.dftphases);
+    for ( AdcSignalVector& sams : acd.binSamples ) release(sams);
+    acd.binSamples.clear();
+    for ( const AdcChannelData::Name& vnam : acd.viewNames() ) {
+      for ( AdcChannelData& vacd : acd.updateView(vnam) ) release(vacd);
+    }
+  }
+
+  // Release all channels in a map.
+  void release(AdcChannelDataMap& acds) {
+    for ( AdcChannelDataMap::value_type& iacd : acds ) release(iacd.second);
+  }
+
+  // Free all pooled buffers.
+  void clear() {
+    store<AdcCount>() = Store<AdcCount>();
+    store<AdcSignal>() = Store<AdcSignal>();
+  }
+
+private:
+
+  // Buffers for one element type indexed by capacity.
+  template<typename T>
+  struct Store {
+    std::map<Size, std::vector<std::vector<T>>> bufs;
+    Size count =0;
+  };
+
+  // AdcFlag and AdcCount are the same type and share a store.
+  using Stores = std::tuple<Store<AdcCount>, Store<AdcSignal>>;
+
+  template<typename T> Store<T>& store() { return std::get<Store<T>>(m_stores); }
+  template<typename T> const Store<T>& store() const { return std::get<Store<T>>(m_stores); }
+
+  Stores m_stores;
+  Size m_maxBuffers =100000;
+
+};
+
+//**********************************************************************
+
+template<typename T>
+bool AdcBufferPool::acquire(std::vector<T>& vec, Size ncap) {
+  release(vec);
+  Store<T>& sto = store<T>();
+  auto ibuf = sto.bufs.lower_bound(ncap);
+  if ( ibuf == sto.bufs.end() ) {
+    vec.reserve(ncap);
+    return false;
+  }
+  vec.swap(ibuf->second.back());
+  ibuf->second.pop_back();
+  if ( ibuf->second.empty() ) sto.bufs.erase(ibuf);
+  --sto.count;
+  return true;
+}
+
+//**********************************************************************
+
+template<typename T>
+void AdcBufferPool::release(std::vector<T>& vec) {
+  Size ncap = vec.capacity();
+  if ( ncap == 0 ) return;
+  Store<T>& sto = store<T>();
+  if ( sto.count >= m_maxBuffers ) {
+    std::vector<T>().swap(vec);
+    return;
+  }
+  vec.clear();
+  sto.bufs[ncap].push_back(std::move(vec));
+  vec = std::vector<T>();
+  ++sto.count;
+}
+
+//**********************************************************************
+
+#endif
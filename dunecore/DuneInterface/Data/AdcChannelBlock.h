@@ -0,0 +1,394 @@
+// AdcChannelBlock.h
+//
+// Struct-of-arrays container for the ADC data of a block of channels,
+// e.g. a plane or an APA.
+//
+// Each per-tick field (raw, samples, flags) is held in a single contiguous
+// channel-major 2D array with the same number of ticks (the stride) for
+// every channel. The number of valid ticks for each channel is recorded
+// separately for each field (zero if the channel does not have that field)
+// and the remainder of each row is zero. Export restores each field to its
+// own length. The per-channel scalars
+// (pedestal, pedestalRms, sampleNoise, tick0, channelClock and channel info)
+// are held in columns and the event info and sample unit are shared by the
+// block.
+//
+// Whole-block algorithms can stream through the arrays:
+//   AdcSignal* psam = block.samples(icha);   // row for channel index icha
+//   for ( Index isam=0; isam<block.nSample(icha); ++isam ) psam[isam] -= ...;
+//
+// Existing AdcChannelData tools can be run on a view of a channel. The view
+// references the block samples row instead of copying it (see the sample
+// reference in AdcChannelData) so tools that read samples through
+// sampleData() allocate nothing per channel:
+//   AdcChannelData acd;
+//   block.viewChannel(icha, acd);
+//   tool.view(acd);
+// A tool that modifies the samples gets a copy through mutableSamples() and
+// the result is copied back with importView:
+//   tool.update(acd);
+//   block.importView(icha, acd);
+// Copying the channel out,
+// including raw and flags, is done with exportChannel:
+//   block.exportChannel(icha, acd);
+//   tool.update(acd);
+//   block.importChannel(icha, acd);
+// The whole block can also be converted to or from AdcChannelDataMap.
+//
+// Channels are held in increasing channel order as in AdcChannelDataMap.
+//
+// The raw, samples and flags arrays are allocated when first filled so a
+// block holding only samples does not pay for raw and flags. When an array is
+// allocated through a mutable accessor, the lengths for that field are set to
+// the largest length of the other fields for each channel.
+
+#ifndef AdcChannelBlock_H
+#define AdcChannelBlock_H
+
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include <algorithm>
+
+class AdcChannelBlock {
+
+public:
+
+  using Index = AdcIndex;
+  using Channel = AdcChannel;
+  using Name = AdcChannelData::Name;
+  using EventInfoPtr = AdcChannelData::EventInfoPtr;
+  using ChannelInfoPtr = AdcChannelData::ChannelInfoPtr;
+  using IndexVector = std::vector<Index>;
+  using IntVector = std::vector<AdcInt>;
+  using LongIndexVector = std::vector<AdcLongIndex>;
+  using ChannelInfoVector = std::vector<ChannelInfoPtr>;
+
+  static Index badIndex() { return AdcChannelData::badIndex(); }
+
+  // Default ctor: empty block.
+  AdcChannelBlock() =default;
+
+  // Ctor from channels and the tick count for each channel.
+  // The channels are sorted and duplicates removed.
+  AdcChannelBlock(const AdcChannelVector& chans, Index stride);
+
+  // Ctor from a channel data map.
+  // The stride is the largest of the raw, samples and flags sizes.
+  explicit AdcChannelBlock(const AdcChannelDataMap& acds);
+
+  // Return the number of channels and the ticks per channel.
+  Index nChannel() const { return m_chans.size(); }
+  Index stride() const { return m_stride; }
+
+  // Return the channels.
+  const AdcChannelVector& channels() const { return m_chans; }
+  Channel channel(Index icha) const { return m_chans[icha]; }
+
+  // Return the index for a channel or badIndex() if the channel is not present.
+  Index channelIndex(Channel chan) const;
+
+  // Number of valid ticks in each field for a channel.
+  Index nRaw(Index icha) const { return m_nraws[icha]; }
+  Index nSample(Index icha) const { return m_nsams[icha]; }
+  Index nFlag(Index icha) const { return m_nflags[icha]; }
+  void setNRaw(Index icha, Index nval) { m_nraws[icha] = std::min(nval, m_stride); }
+  void setNSample(Index icha, Index nval) { m_nsams[icha] = std::min(nval, m_stride); }
+  void setNFlag(Index icha, Index nval) { m_nflags[icha] = std::min(nval, m_stride); }
+
+  // Return if the per-tick arrays are allocated.
+  bool hasRaw() const { return m_raw.size(); }
+  bool hasSamples() const { return m_samples.size(); }
+  bool hasFlags() const { return m_flags.size(); }
+
+  // Return the row for a channel in the per-tick arrays.
+  // The mutable accessors allocate the array if needed.
+  const AdcCount* raw(Index icha) const { return row(m_raw, icha); }
+  const AdcSignal* samples(Index icha) const { return row(m_samples, icha); }
+  const AdcFlag* flags(Index icha) const { return row(m_flags, icha); }
+  AdcCount* raw(Index icha) { return row(allocate(m_raw, m_nraws), icha); }
+  AdcSignal* samples(Index icha) { return row(allocate(m_samples, m_nsams), icha); }
+  AdcFlag* flags(Index icha) { return row(allocate(m_flags, m_nflags), icha); }
+
+  // Return the full per-tick arrays (channel-major, nChannel()*stride() values).
+  const AdcCountVector& rawData() const { return m_raw; }
+  const AdcSignalVector& samplesData() const { return m_samples; }
+  const AdcFlagVector& flagsData() const { return m_flags; }
+  AdcCountVector& rawData() { return allocate(m_raw, m_nraws); }
+  AdcSignalVector& samplesData() { return allocate(m_samples, m_nsams); }
+  AdcFlagVector& flagsData() { return allocate(m_flags, m_nflags); }
+
+  // Per-channel scalar columns.
+  AdcSignalVector& pedestals() { return m_peds; }
+  AdcSignalVector& pedestalRmss() { return m_pedRmss; }
+  AdcSignalVector& sampleNoises() { return m_noises; }
+  IntVector& tick0s() { return m_tick0s; }
+  LongIndexVector& channelClocks() { return m_clocks; }
+  ChannelInfoVector& channelInfos() { return m_chanInfos; }
+  const AdcSignalVector& pedestals() const { return m_peds; }
+  const AdcSignalVector& pedestalRmss() const { return m_pedRmss; }
+  const AdcSignalVector& sampleNoises() const { return m_noises; }
+  const IntVector& tick0s() const { return m_tick0s; }
+  const LongIndexVector& channelClocks() const { return m_clocks; }
+  const ChannelInfoVector& channelInfos() const { return m_chanInfos; }
+
+  // Shared event info and sample unit.
+  EventInfoPtr eventInfo() const { return m_peventInfo; }
+  void setEventInfo(EventInfoPtr pevi) { m_peventInfo = pevi; }
+  const Name& sampleUnit() const { return m_sampleUnit; }
+  void setSampleUnit(Name unit) { m_sampleUnit = unit; }
+
+  // Make acd a view of channel icha: its samples reference the block row and
+  // the scalar fields are copied as in exportChannel. Raw and flags are not
+  // copied. The view is valid until the block samples are reallocated.
+  // Other fields in acd are left unchanged.
+  void viewChannel(Index icha, AdcChannelData& acd) const;
+
+  // Copy channel icha into an AdcChannelData object.
+  // Raw, samples and flags are copied with their own lengths if allocated
+  // in the block.
+  // Other fields in acd are left unchanged.
+  void exportChannel(Index icha, AdcChannelData& acd) const;
+
+  // Copy the block fields from an AdcChannelData object into channel icha.
+  // Rows of fields absent in acd are zeroed and given length zero.
+  // Samples still referencing the row of icha are not copied.
+  // Per-tick data beyond the stride is dropped.
+  // Returns the number of ticks dropped.
+  Index importChannel(Index icha, const AdcChannelData& acd);
+
+  // Copy back a view made with viewChannel: as importChannel but raw and
+  // flags in the block are left unchanged.
+  Index importView(Index icha, const AdcChannelData& acd);
+
+  // Convert to a channel data map.
+  AdcChannelDataMap toChannelDataMap() const;
+
+  // Copy the block fields back into the matching entries of a map.
+  // Returns the number of block channels not found in the map.
+  Index exportTo(AdcChannelDataMap& acds) const;
+
+private:
+
+  template<typename T>
+  const T* row(const std::vector<T>& vals, Index icha) const {
+    return vals.size() ? vals.data() + std::size_t(icha)*m_stride : nullptr;
+  }
+
+  template<typename T>
+  T* row(std::vector<T>& vals, Index icha) {
+    return vals.data() + std::size_t(icha)*m_stride;
+  }
+
+  // Allocate an array if needed, setting its lengths from the other fields.
+  template<typename T>
+  std::vector<T>& allocate(std::vector<T>& vals, IndexVector& lens) {
+    if ( vals.empty() ) {
+      vals.resize(std::size_t(nChannel())*m_stride, 0);
+      for ( Index icha=0; icha<nChannel(); ++icha ) {
+        lens[icha] = std::max({m_nraws[icha], m_nsams[icha], m_nflags[icha]});
+      }
+    }
+    return vals;
+  }
+
+  // Size the per-channel columns.
+  void resizeColumns();
+
+  // Copy the per-channel scalars, event info and sample unit to acd.
+  void copyScalars(Index icha, AdcChannelData& acd) const;
+
+  // Import samples and scalars and, if doAll, raw and flags.
+  Index importFields(Index icha, const AdcChannelData& acd, bool doAll);
+
+  AdcChannelVector m_chans;
+  Index m_stride =0;
+  IndexVector m_nraws;
+  IndexVector m_nsams;
+  IndexVector m_nflags;
+  AdcCountVector m_raw;
+  AdcSignalVector m_samples;
+  AdcFlagVector m_flags;
+  AdcSignalVector m_peds;
+  AdcSignalVector m_pedRmss;
+  AdcSignalVector m_noises;
+  IntVector m_tick0s;
+  LongIndexVector m_clocks;
+  ChannelInfoVector m_chanInfos;
+  EventInfoPtr m_peventInfo;
+  Name m_sampleUnit;
+
+};
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::AdcChannelBlock(const AdcChannelVector& chans, Index stride)
+: m_chans(chans), m_stride(stride) {
+  std::sort(m_chans.begin(), m_chans.end());
+  m_chans.erase(std::unique(m_chans.begin(), m_chans.end()), m_chans.end());
+  resizeColumns();
+}
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::AdcChannelBlock(const AdcChannelDataMap& acds) {
+  m_chans.reserve(acds.size());
+  for ( const AdcChannelDataMap::value_type& iacd : acds ) {
+    const AdcChannelData& acd = iacd.second;
+    m_chans.push_back(iacd.first);
+    m_stride = std::max<Index>(m_stride, acd.raw.size());
+    m_stride = std::max<Index>(m_stride, acd.sampleCount());
+    m_stride = std::max<Index>(m_stride, acd.flags.size());
+  }
+  resizeColumns();
+  Index icha = 0;
+  for ( const AdcChannelDataMap::value_type& iacd : acds ) {
+    if ( icha == 0 ) {
+      m_peventInfo = iacd.second.getEventInfoPtr();
+      m_sampleUnit = iacd.second.sampleUnit;
+    }
+    importChannel(icha++, iacd.second);
+  }
+}
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::Index AdcChannelBlock::channelIndex(Channel chan) const {
+  AdcChannelVector::const_iterator ichan = std::lower_bound(m_chans.begin(), m_chans.end(), chan);
+  if ( ichan == m_chans.end() || *ichan != chan ) return badIndex();
+  return ichan - m_chans.begin();
+}
+
+//**********************************************************************
+
+inline
+void AdcChannelBlock::viewChannel(Index icha, AdcChannelData& acd) const {
+  if ( hasSamples() ) acd.setSampleRef(samples(icha), m_nsams[icha]);
+  else acd.clearSampleRef();
+  copyScalars(icha, acd);
+}
+
+//**********************************************************************
+
+inline
+void AdcChannelBlock::exportChannel(Index icha, AdcChannelData& acd) const {
+  if ( hasRaw() ) acd.raw.assign(raw(icha), raw(icha) + m_nraws[icha]);
+  if ( hasSamples() ) {
+    acd.clearSampleRef();
+    acd.samples.assign(samples(icha), samples(icha) + m_nsams[icha]);
+  }
+  if ( hasFlags() ) acd.flags.assign(flags(icha), flags(icha) + m_nflags[icha]);
+  copyScalars(icha, acd);
+}
+
+//**********************************************************************
+
+inline
+void AdcChannelBlock::copyScalars(Index icha, AdcChannelData& acd) const {
+  acd.pedestal = m_peds[icha];
+  acd.pedestalRms = m_pedRmss[icha];
+  acd.sampleNoise = m_noises[icha];
+  acd.tick0 = m_tick0s[icha];
+  acd.channelClock = m_clocks[icha];
+  acd.sampleUnit = m_sampleUnit;
+  if ( m_peventInfo ) acd.setEventInfo(m_peventInfo);
+  if ( m_chanInfos[icha] ) {
+    acd.setChannelInfo(m_chanInfos[icha]);
+  } else if ( ! acd.hasChannelInfo() ) {
+    acd.setChannelInfo(m_chans[icha]);
+  }
+}
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::Index AdcChannelBlock::importChannel(Index icha, const AdcChannelData& acd) {
+  return importFields(icha, acd, true);
+}
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::Index AdcChannelBlock::importView(Index icha, const AdcChannelData& acd) {
+  return importFields(icha, acd, false);
+}
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::Index
+AdcChannelBlock::importFields(Index icha, const AdcChannelData& acd, bool doAll) {
+  Index ndrop = 0;
+  auto copyIn = [this, icha, &ndrop](const auto* pval, Index nval, auto& arr, IndexVector& lens) {
+    Index ncpy = std::min<Index>(nval, m_stride);
+    lens[icha] = ncpy;
+    if ( arr.empty() ) {
+      if ( ncpy == 0 ) return;
+      arr.resize(std::size_t(nChannel())*m_stride, 0);
+    }
+    auto* prow = row(arr, icha);
+    if ( static_cast<const void*>(pval) != static_cast<const void*>(prow) ) {
+      std::copy(pval, pval + ncpy, prow);
+    }
+    std::fill(prow + ncpy, prow + m_stride, 0);
+    ndrop = std::max<Index>(ndrop, nval - ncpy);
+  };
+  if ( doAll ) copyIn(acd.raw.data(), acd.raw.size(), m_raw, m_nraws);
+  copyIn(acd.sampleData(), acd.sampleCount(), m_samples, m_nsams);
+  if ( doAll ) copyIn(acd.flags.data(), acd.flags.size(), m_flags, m_nflags);
+  m_peds[icha] = acd.pedestal;
+  m_pedRmss[icha] = acd.pedestalRms;
+  m_noises[icha] = acd.sampleNoise;
+  m_tick0s[icha] = acd.tick0;
+  m_clocks[icha] = acd.channelClock;
+  m_chanInfos[icha] = acd.getChannelInfoPtr();
+  return ndrop;
+}
+
+//**********************************************************************
+
+inline
+AdcChannelDataMap AdcChannelBlock::toChannelDataMap() const {
+  AdcChannelDataMap acds;
+  for ( Index icha=0; icha<nChannel(); ++icha ) {
+    exportChannel(icha, acds.emplace_hint(acds.end(), m_chans[icha], AdcChannelData())->second);
+  }
+  return acds;
+}
+
+//**********************************************************************
+
+inline
+AdcChannelBlock::Index AdcChannelBlock::exportTo(AdcChannelDataMap& acds) const {
+  Index nmiss = 0;
+  for ( Index icha=0; icha<nChannel(); ++icha ) {
+    AdcChannelDataMap::iterator iacd = acds.find(m_chans[icha]);
+    if ( iacd == acds.end() ) {
+      ++nmiss;
+      continue;
+    }
+    exportChannel(icha, iacd->second);
+  }
+  return nmiss;
+}
+
+//**********************************************************************
+
+inline
+void AdcChannelBlock::resizeColumns() {
+  Index ncha = nChannel();
+  m_nraws.assign(ncha, 0);
+  m_nsams.assign(ncha, 0);
+  m_nflags.assign(ncha, 0);
+  m_peds.assign(ncha, AdcChannelData::badSignal());
+  m_pedRmss.assign(ncha, 0.0);
+  m_noises.assign(ncha, 0.0);
+  m_tick0s.assign(ncha, 0);
+  m_clocks.assign(ncha, 0);
+  m_chanInfos.assign(ncha, ChannelInfoPtr());
+}
+
+//**********************************************************************
+
+#endif
@@ -37,7 +37,11 @@
 //          rois - Array of ROIs indicating ticks of interest (e.g. have signals)
 //       dftmags - Array of magnitudes for the DFT of the samples.
 //     dftphases - Array of phases for the DFT of the samples.
-//      metadata - Extra attributes
+//      metadata - Extra attributes. A transient key-sorted copy (the metadata index)
+//                 is used for lookups with AdcAttribute. It is kept in sync by
+//                 setMetadata; code writing the map directly should call
+//                 indexMetadata() afterwards. Until then lookups use the map if
+//                 an entry was added or removed.
 //
 //         digit - Corresponding raw digit
 //          wire - Corresponding wire
@@ -49,6 +53,11 @@
 //    viewParent - Pointer to the data object holding this as a view. Creator of the view
 //                 object is responsible for filling this field.
 //
+// Held indirectly:
+//     sampleRef - Non-owning reference to a tick range in the samples of another
+//                 channel data object (usually the view parent) or in external
+//                 storage such as a row of an AdcChannelBlock.
+//
 // User can compare values against the defaults below to know if a value has been set.
 // For arrays, check if the size in nonzero.
 //
@@ -65,6 +74,22 @@
 // A view path is a vector of names {vn0, vn1, ...} with string representation
 // "vn0/vn1/..." that specifies the path to a collection of AdcChannelData objects
 // at any depth in the view hiearchy.
+// Views that select a tick range of their parent need not copy the samples.
+// An entry made with addSampleView references the parent samples and only
+// copies them when the entry's samples are modified through mutableSamples().
+// References are also made by AdcChannelBlock::viewChannel. Copies of the data,
+// e.g. those made by the default AdcChannelTool::view, do not reference the
+// original.
+// Code reading samples that may be referenced should use sampleData() and
+// sampleCount() rather than the samples vector. If samples are assigned
+// directly to a referencing entry, those samples take precedence and the
+// reference is ignored. The source samples must not be resized or modified
+// while they are referenced. The reference is not
+// persisted: call mutableSamples() before writing an entry whose samples
+// should be kept.
+// Example:
+//   for ( AdcIndex ibeg=0; ibeg<nsam; ibeg+=1000 ) mydata.addSampleView("trun1000", ibeg, 1000);
+//
 // Example view access:
 //   string myview = "constituents/trun1000";
 //   AdcIndex nvie = mydata.viewCount(myview);
@@ -80,10 +105,13 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <algorithm>
 #include <iostream>
 #include "dunecore/DuneInterface/Data/AdcTypes.h"
 #include "dunecore/DuneInterface/Data/DuneEventInfo.h"
 #include "dunecore/DuneInterface/Data/DuneChannelInfo.h"
+#include "dunecore/DuneInterface/Data/AdcAttribute.h"
+#include "dunecore/DuneInterface/Data/AdcBitMask.h"
 
 namespace raw {
   class RawDigit;
@@ -99,6 +127,13 @@ public:
   using Name = std::string;
   using NameVector = std::vector<Name>;
   using FloatMap = std::map<Name, float>;
+  using FieldKey = AdcAttribute::FieldKey;
+  struct MetadataEntry {
+    FieldKey key;
+    float value;
+    bool operator<(FieldKey rhs) const { return key < rhs; }
+  };
+  using MetadataIndex = std::vector<MetadataEntry>;
   using View = std::vector<AdcChannelData>;
   using ViewMap = std::map<Name, View>;
   using EventInfo = DuneEventInfo;
@@ -154,6 +189,21 @@ private:
   // Constituents and alternate views.
   ViewMap m_views;
 
+  // Referenced samples.
+  const AdcSignal* m_sampleRef =nullptr;
+  AdcIndex m_sampleCount =0;
+
+  // Metadata index sorted by field key and flag that is false if two
+  // names have the same key.
+  MetadataIndex m_metadataIndex;
+  bool m_metadataIndexOk =true;
+
+  // Return an attribute of this object ignoring the attribute level.
+  float localAttribute(const AdcAttribute& att, float def) const;
+
+  // Return the local metadata value for an attribute or null if absent.
+  const float* localMetadata(const AdcAttribute& att) const;
+
 public:
 
   // Set event info.
@@ -228,101 +278,100 @@ public:
   AdcChannelData(AdcChannelData&&) =default;
   AdcChannelData& operator=(AdcChannelData&&) =default;
 
+  // Return if this object reads its samples through a reference and drop
+  // the reference. Samples held here take precedence over a reference.
+  bool hasSampleRef() const { return m_sampleRef != nullptr && samples.empty(); }
+  void clearSampleRef() { m_sampleRef = nullptr; m_sampleCount = 0; }
+
+  // Reference the samples in range [ibeg, ibeg+nsam) of another object
+  // instead of holding them. The range is truncated to the source size.
+  // The samples vector held here is released.
+  void setSampleRef(const AdcChannelData& src, AdcIndex ibeg =0, AdcIndex nsam =badIndex());
+
+  // Reference nsam samples held elsewhere, e.g. a row of an AdcChannelBlock.
+  // The samples vector held here is released.
+  void setSampleRef(const AdcSignal* psam, AdcIndex nsam);
+
+  // Read the samples: referenced if there is a reference, otherwise those held.
+  AdcIndex sampleCount() const { return hasSampleRef() ? m_sampleCount : samples.size(); }
+  const AdcSignal* sampleData() const {
+    return hasSampleRef() ? m_sampleRef : samples.data();
+  }
+  AdcSignal sample(AdcIndex isam) const { return sampleData()[isam]; }
+
+  // Return the samples for modification.
+  // Referenced samples are first copied into the samples vector.
+  AdcSignalVector& mutableSamples();
+
+  // Add an entry to view vnam referencing samples [ibeg, ibeg+nsam) of this object.
+  // Event and channel info, pedestal and sample unit are copied and tick0
+  // is offset by ibeg. The new entry is returned.
+  AdcChannelData& addSampleView(Name vnam, AdcIndex ibeg, AdcIndex nsam);
+
+  // Return the object holding an attribute, i.e. this object or the parent
+  // at the attribute level. Null if that parent does not exist.
+  const AdcChannelData* attributeHolder(const AdcAttribute& att) const {
+    const AdcChannelData* pacd = this;
+    for ( Index ilev=0; ilev<att.level() && pacd != nullptr; ++ilev ) pacd = pacd->viewParent;
+    return pacd;
+  }
+
+  // Return if the metadata index matches the metadata map.
+  bool hasMetadataIndex() const {
+    return m_metadataIndexOk && m_metadataIndex.size() == metadata.size();
+  }
+
+  // Rebuild the metadata index from the map.
+  void indexMetadata();
+
   // Check if a metadata field is defined.
+  bool hasMetadata(const AdcAttribute& att) const {
+    const AdcChannelData* pacd = attributeHolder(att);
+    if ( pacd == nullptr ) return false;
+    return pacd->localMetadata(att) != nullptr;
+  }
   bool hasMetadata(Name mname) const {
-    if ( mname.substr(0,3) == "../" ) {
-      if ( viewParent == nullptr ) return false;
-      return viewParent->hasMetadata(mname.substr(3));
-    }
-    return metadata.find(mname) != metadata.end();
+    return hasMetadata(AdcAttribute(mname));
   }
 
   // Fetch metadata.
+  float getMetadata(const AdcAttribute& att, float def =0.0) const {
+    const AdcChannelData* pacd = attributeHolder(att);
+    if ( pacd == nullptr ) return def;
+    const float* pval = pacd->localMetadata(att);
+    return pval == nullptr ? def : *pval;
+  }
   float getMetadata(Name mname, float def =0.0) const {
-    if ( mname.substr(0,3) == "../" ) {
-      if ( viewParent == nullptr ) return def;
-      return viewParent->getMetadata(mname.substr(3));
-    }
-    FloatMap::const_iterator imtd = metadata.find(mname);
-    if ( imtd == metadata.end() ) return def;
-    return imtd->second;
+    return getMetadata(AdcAttribute(mname), def);
   }
 
-  // Set metadata.
+  // Set metadata in the map and index of the attribute holder.
+  void setMetadata(const AdcAttribute& att, float val);
   void setMetadata(Name mname, float val) {
-    metadata[mname] = val;
+    setMetadata(AdcAttribute(mname), val);
   }
 
   // Check if an attribute is defined.
-  bool hasAttribute(Name mname, float def =0.0) const {
-    if ( mname.substr(0,3) == "../" ) {
-      if ( viewParent == nullptr ) return false;
-      return viewParent->hasAttribute(mname.substr(3));
-    }
-    if ( mname == "run" ) return true;
-    if ( mname == "subRun" ) return true;
-    if ( mname == "event" ) return true;;
-    if ( mname == "trigger" ) return true;;
-    if ( mname == "triggerClock" ) return true;
-    if ( mname == "channelClock" ) return true;
-    if ( mname == "channelClockOffset" ) return true;
-    if ( mname == "channel" ) return true;
-    if ( mname == "fembID" ) return true;
-    if ( mname == "fembChannel" ) return true;
-    if ( mname == "pedestal" ) return true;
-    if ( mname == "pedestalRms" ) return true;
-    if ( mname == "sampleNoise" ) return true;
-    if ( mname == "digitIndex" ) return true;
-    if ( mname == "wireIndex" ) return true;
-    if ( mname == "raw" ) return true;
-    if ( mname == "samples" ) return true;
-    if ( mname == "flags" ) return true;
-    if ( mname == "signal" ) return true;
-    if ( mname == "rois" ) return true;
-    if ( mname == "dftmags" ) return true;
-    if ( mname == "dftphases" ) return true;
-    if ( mname == "digit" ) return true;
-    if ( mname == "wire" ) return true;
-    if ( mname == "metadata" ) return metadata.size();
-    return hasMetadata(mname);
+  // Tools may construct the AdcAttribute once, e.g. at configuration.
+  bool hasAttribute(const AdcAttribute& att) const {
+    const AdcChannelData* pacd = attributeHolder(att);
+    if ( pacd == nullptr ) return false;
+    if ( att.key() == AdcAttribute::Metadata ) return pacd->metadata.size();
+    if ( att.isBuiltin() ) return true;
+    return pacd->localMetadata(att) != nullptr;
+  }
+  bool hasAttribute(Name mname, float =0.0) const {
+    return hasAttribute(AdcAttribute(mname));
   }
 
   // Fetch any property including metadata.
+  float getAttribute(const AdcAttribute& att, float def =0.0) const {
+    const AdcChannelData* pacd = attributeHolder(att);
+    if ( pacd == nullptr ) return def;
+    return pacd->localAttribute(att, def);
+  }
   float getAttribute(Name mname, float def =0.0) const {
-    if ( mname.substr(0,3) == "../" ) {
-      if ( viewParent == nullptr ) return def;
-      return viewParent->getAttribute(mname.substr(3));
-    }
-    // For basic types, return the value.
-    if ( mname == "run" ) return run();
-    if ( mname == "subRun" ) return subRun();
-    if ( mname == "event" ) return event();
-    if ( mname == "trigger" ) return trigger();
-    if ( mname == "triggerClock" ) return triggerClock();  // lose precision here
-    if ( mname == "channelClock" ) return channelClock;  // lose precision here
-    if ( mname == "channelClockOffset" ) return channelClock - triggerClock();
-    if ( mname == "channel" ) return channel();
-    if ( mname == "fembID" ) return fembID();
-    if ( mname == "fembChannel" ) return fembChannel();
-    if ( mname == "pedestal" ) return pedestal;
-    if ( mname == "pedestalRms" ) return pedestalRms;
-    if ( mname == "sampleNoise" ) return sampleNoise;
-    if ( mname == "digitIndex" ) return digitIndex;
-    if ( mname == "wireIndex" ) return wireIndex;
-    // For vectors, return the size.
-    if ( mname == "raw" ) return raw.size();
-    if ( mname == "samples" ) return samples.size();
-    if ( mname == "flags" ) return flags.size();
-    if ( mname == "signal" ) return signal.size();
-    if ( mname == "rois" ) return rois.size();
-    if ( mname == "dftmags" ) return dftmags.size();
-    if ( mname == "dftphases" ) return dftphases.size();
-    // For pointer, return false for null.
-    if ( mname == "digit" ) return digit != nullptr;
-    if ( mname == "wire" ) return wire != nullptr;
-    if ( mname == "metadata" ) return metadata.size();
-    // Otherwise return the metatdata field.
-    return getMetadata(mname, def);
+    return getAttribute(AdcAttribute(mname), def);
   }
 
   // Clear the data.
@@ -331,6 +380,19 @@ public:
   // Fill rois from signal.
   void roisFromSignal();
 
+  // Bit-mask representations of signal, rois and flags.
+  // The rois mask has the length of samples.
+  // The flags mask is set for ticks with flag other than AdcGood.
+  AdcBitMask signalMask() const { return AdcBitMask(signal); }
+  AdcBitMask roiMask() const { return AdcBitMask(rois, samples.size()); }
+  AdcBitMask flagMask() const { return AdcBitMask(flags); }
+
+  // Fill signal and rois from a bit mask.
+  void setSignal(const AdcBitMask& mask) {
+    mask.toFilter(signal);
+    mask.toRois(rois);
+  }
+
   // Return normalization specifier for the DFT held here.
   // See RealDftNormalization.h
   static AdcIndex dftNormalization() { return 22; }
@@ -404,8 +466,150 @@ inline void AdcChannelData::clear() {
   digitIndex = badIndex();
   wireIndex = badIndex();
   metadata.clear();
+  m_metadataIndex.clear();
+  m_metadataIndexOk = true;
   m_peventInfo.reset();
   m_pchanInfo.reset();
+  clearSampleRef();
+}
+
+//**********************************************************************
+
+inline
+void AdcChannelData::setSampleRef(const AdcChannelData& src, AdcIndex ibeg, AdcIndex nsam) {
+  AdcIndex nsrc = src.sampleCount();
+  if ( ibeg > nsrc ) ibeg = nsrc;
+  if ( nsam > nsrc - ibeg ) nsam = nsrc - ibeg;
+  setSampleRef(src.sampleData() + ibeg, nsam);
+}
+
+//**********************************************************************
+
+inline
+void AdcChannelData::setSampleRef(const AdcSignal* psam, AdcIndex nsam) {
+  AdcSignalVector().swap(samples);
+  m_sampleRef = psam;
+  m_sampleCount = nsam;
+}
+
+//**********************************************************************
+
+inline
+AdcSignalVector& AdcChannelData::mutableSamples() {
+  if ( hasSampleRef() ) {
+    const AdcSignal* psam = sampleData();
+    samples.assign(psam, psam + m_sampleCount);
+  }
+  clearSampleRef();
+  return samples;
+}
+
+//**********************************************************************
+
+inline
+AdcChannelData& AdcChannelData::addSampleView(Name vnam, AdcIndex ibeg, AdcIndex nsam) {
+  View& vw = updateView(vnam);
+  vw.emplace_back(*this);
+  AdcChannelData& acd = vw.back();
+  acd.viewParent = this;
+  acd.tick0 = tick0 + AdcInt(ibeg);
+  acd.pedestal = pedestal;
+  acd.pedestalRms = pedestalRms;
+  acd.sampleUnit = sampleUnit;
+  acd.sampleNoise = sampleNoise;
+  acd.setSampleRef(*this, ibeg, nsam);
+  return acd;
+}
+
+//**********************************************************************
+
+inline float AdcChannelData::localAttribute(const AdcAttribute& att, float def) const {
+  switch ( att.key() ) {
+  // For basic types, return the value.
+  case AdcAttribute::Run: return run();
+  case AdcAttribute::SubRun: return subRun();
+  case AdcAttribute::Event: return event();
+  case AdcAttribute::Trigger: return trigger();
+  case AdcAttribute::TriggerClock: return triggerClock();  // lose precision here
+  case AdcAttribute::ChannelClock: return channelClock;  // lose precision here
+  case AdcAttribute::ChannelClockOffset: return channelClock - triggerClock();
+  case AdcAttribute::Channel: return channel();
+  case AdcAttribute::FembID: return fembID();
+  case AdcAttribute::FembChannel: return fembChannel();
+  case AdcAttribute::Pedestal: return pedestal;
+  case AdcAttribute::PedestalRms: return pedestalRms;
+  case AdcAttribute::SampleNoise: return sampleNoise;
+  case AdcAttribute::DigitIndex: return digitIndex;
+  case AdcAttribute::WireIndex: return wireIndex;
+  // For vectors, return the size.
+  case AdcAttribute::Raw: return raw.size();
+  case AdcAttribute::Samples: return sampleCount();
+  case AdcAttribute::Flags: return flags.size();
+  case AdcAttribute::Signal: return signal.size();
+  case AdcAttribute::Rois: return rois.size();
+  case AdcAttribute::DftMags: return dftmags.size();
+  case AdcAttribute::DftPhases: return dftphases.size();
+  // For pointer, return false for null.
+  case AdcAttribute::Digit: return digit != nullptr;
+  case AdcAttribute::Wire: return wire != nullptr;
+  case AdcAttribute::Metadata: return metadata.size();
+  }
+  // Otherwise return the metatdata field.
+  const float* pval = localMetadata(att);
+  return pval == nullptr ? def : *pval;
+}
+
+//**********************************************************************
+
+inline const float* AdcChannelData::localMetadata(const AdcAttribute& att) const {
+  if ( hasMetadataIndex() ) {
+    MetadataIndex::const_iterator ient =
+      std::lower_bound(m_metadataIndex.begin(), m_metadataIndex.end(), att.fieldKey());
+    if ( ient == m_metadataIndex.end() || ient->key != att.fieldKey() ) return nullptr;
+    return &ient->value;
+  }
+  FloatMap::const_iterator imtd = metadata.find(att.name());
+  if ( imtd == metadata.end() ) return nullptr;
+  return &imtd->second;
+}
+
+//**********************************************************************
+
+inline void AdcChannelData::indexMetadata() {
+  m_metadataIndex.clear();
+  m_metadataIndex.reserve(metadata.size());
+  for ( const FloatMap::value_type& ent : metadata ) {
+    m_metadataIndex.push_back({AdcAttribute::fieldKey(ent.first), ent.second});
+  }
+  std::sort(m_metadataIndex.begin(), m_metadataIndex.end(),
+            [](const MetadataEntry& lhs, const MetadataEntry& rhs) { return lhs.key < rhs.key; });
+  m_metadataIndexOk = true;
+  for ( Index ient=1; ient<m_metadataIndex.size(); ++ient ) {
+    if ( m_metadataIndex[ient].key == m_metadataIndex[ient-1].key ) m_metadataIndexOk = false;
+  }
+}
+
+//**********************************************************************
+
+inline void AdcChannelData::setMetadata(const AdcAttribute& att, float val) {
+  AdcChannelData* pacd = this;
+  for ( Index ilev=0; ilev<att.level() && pacd != nullptr; ++ilev ) pacd = pacd->viewParent;
+  if ( pacd == nullptr ) return;
+  bool wasIndexed = pacd->hasMetadataIndex();
+  std::pair<FloatMap::iterator, bool> res = pacd->metadata.emplace(att.name(), val);
+  if ( ! res.second ) res.first->second = val;
+  if ( ! wasIndexed ) {
+    pacd->indexMetadata();
+    return;
+  }
+  MetadataIndex& index = pacd->m_metadataIndex;
+  MetadataIndex::iterator ient = std::lower_bound(index.begin(), index.end(), att.fieldKey());
+  if ( ient != index.end() && ient->key == att.fieldKey() ) {
+    if ( res.second ) pacd->m_metadataIndexOk = false;  // Two names with one key.
+    else ient->value = val;
+  } else if ( res.second ) {
+    index.insert(ient, {att.fieldKey(), val});
+  }
 }
 
 //**********************************************************************
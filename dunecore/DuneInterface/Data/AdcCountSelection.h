@@ -11,6 +11,7 @@
 // to be retained.
 
 #include "dunecore/DuneInterface/Data/AdcTypes.h"
+#include "dunecore/DuneInterface/Data/AdcBitMask.h"
 
 struct AdcCountSelection {
 
@@ -27,6 +28,12 @@ struct AdcCountSelection {
   AdcCountSelection(const AdcCountVector& a_counts, Channel a_channel, AdcPedestal a_pedestal)
   : counts(a_counts), channel(a_channel), pedestal(a_pedestal), filter(counts.size(), true) { }
 
+  // Return the filter as a bit mask.
+  AdcBitMask filterMask() const { return AdcBitMask(filter); }
+
+  // Set the filter from a bit mask.
+  void setFilter(const AdcBitMask& mask) { mask.toFilter(filter); }
+
 };
 
 typedef std::vector<AdcCountSelection> AdcCountSelectionVector;
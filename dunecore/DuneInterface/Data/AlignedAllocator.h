@@ -0,0 +1,49 @@
+// AlignedAllocator.h
+//
+// Standard-library allocator returning memory aligned to A bytes (default 64,
+// i.e. a cache line and a full AVX-512 register).
+//
+// Usage:
+//   std::vector<float, AlignedAllocator<float>> vals(1000);
+//   // vals.data() is 64-byte aligned.
+
+#ifndef AlignedAllocator_H
+#define AlignedAllocator_H
+
+#include <cstddef>
+#include <new>
+
+template<typename T, std::size_t A =64>
+class AlignedAllocator {
+
+public:
+
+  using value_type = T;
+
+  static constexpr std::size_t alignment() { return A; }
+
+  template<typename U>
+  struct rebind { using other = AlignedAllocator<U, A>; };
+
+  AlignedAllocator() noexcept =default;
+
+  template<typename U>
+  AlignedAllocator(const AlignedAllocator<U, A>&) noexcept { }
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(A)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t(A));
+  }
+
+};
+
+template<typename T, typename U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+
+template<typename T, typename U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+#endif
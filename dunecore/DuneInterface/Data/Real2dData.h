@@ -7,13 +7,25 @@
 //
 // It is templated so DFT elements can be stored at different levels of
 // floating point precision.
+//
+// The data is stored in row-major order in 64-byte aligned memory. Row
+// pointers (row(irow)) and the unchecked accessor (irow, icol) give direct
+// access for loops over the data. Whole-array operations (add, scale,
+// threshold, transpose, row/column sums and medians, padding) are provided
+// as methods written over contiguous aligned arrays so the compiler can
+// vectorize them.
 
 #ifndef Real2dData_H
 #define Real2dData_H
 
 #include "dunecore/DuneInterface/Data/RealDftNormalization.h"
+#include "dunecore/DuneInterface/Data/AlignedAllocator.h"
 #include <complex>
 #include <array>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
 
 //**********************************************************************
 
@@ -29,7 +41,8 @@ class Real2dData {
 public:
 
   using Float = F;
-  using DataVector = std::vector<F>;
+  using DataVector = std::vector<F, AlignedAllocator<F>>;
+  using StdVector = std::vector<F>;
   using Index = unsigned int;
   using IndexArray = std::array<Index,2>;
   using Norm = RealDftNormalization;
@@ -60,6 +73,10 @@ public:
   : Real2dData(nsams) {
     copyDataIn(data);
   }
+  Real2dData(const IndexArray& nsams, const StdVector& data)
+  : Real2dData(nsams) {
+    copyDataIn(data);
+  }
 
   // Virtual dtor so we can inherit.
   virtual ~Real2dData() =default;
@@ -114,7 +131,20 @@ public:
   }
 
   // Return the data (row major order).
-  const std::vector<F>& data() const { return m_data; }
+  const DataVector& data() const { return m_data; }
+
+  // Return a pointer to the data. The address is 64-byte aligned.
+  const F* dataPointer() const { return m_data.data(); }
+  F* dataPointer() { return m_data.data(); }
+
+  // Return a pointer to the first element of a row, i.e. the values for
+  // fixed index 0. The row length is size(1). No range check.
+  const F* row(Index irow) const { return m_data.data() + std::size_t(irow)*m_nsams[1]; }
+  F* row(Index irow) { return m_data.data() + std::size_t(irow)*m_nsams[1]; }
+
+  // Unchecked element access.
+  const F& operator()(Index irow, Index icol) const { return row(irow)[icol]; }
+  F& operator()(Index irow, Index icol) { return row(irow)[icol]; }
 
   // Copy the data in from a vector.
   // Return 0 for success.
@@ -124,6 +154,12 @@ public:
     m_data = data;
     return 0;
   }
+  int copyDataIn(const StdVector& data) {
+    if ( ! isValid() ) return 1;
+    if ( data.size() != m_data.size() ) return 2;
+    m_data.assign(data.begin(), data.end());
+    return 0;
+  }
 
   // Copy the data in from an array of any type.
   // Return 0 for success.
@@ -205,18 +241,87 @@ public:
   // Return the total power.
   F power() const {
     F pwr = 0.0;
-    IndexArray idats;
-    for ( idats[0]=0; idats[0]<size(0); ++idats[0] ) {
-      for ( idats[1]=0; idats[1]<size(1); ++idats[1] ) {
-        F val = value(idats);
-        pwr += val*val;
-      }
-    }
+    const F* pdat = alignedData();
+    Index ndat = size();
+    for ( Index idat=0; idat<ndat; ++idat ) pwr += pdat[idat]*pdat[idat];
     return pwr;
   }
 
+  // Element-wise operations on the full array.
+  // Add another array of the same shape. Returns nonzero if the shapes differ.
+  int add(const Real2dData& rhs, F fac =1.0) {
+    if ( rhs.nSamples() != nSamples() ) return 1;
+    F* pdat = alignedData();
+    const F* prhs = rhs.alignedData();
+    Index ndat = size();
+    for ( Index idat=0; idat<ndat; ++idat ) pdat[idat] += fac*prhs[idat];
+    return 0;
+  }
+
+  // Add a constant.
+  void add(F val) {
+    F* pdat = alignedData();
+    Index ndat = size();
+    for ( Index idat=0; idat<ndat; ++idat ) pdat[idat] += val;
+  }
+
+  // Multiply by a constant.
+  void scale(F fac) {
+    F* pdat = alignedData();
+    Index ndat = size();
+    for ( Index idat=0; idat<ndat; ++idat ) pdat[idat] *= fac;
+  }
+
+  // Replace values with magnitude below thresh with fill.
+  // Returns the number of values kept.
+  Index threshold(F thresh, F fill =0.0) {
+    F* pdat = alignedData();
+    Index ndat = size();
+    Index nkeep = 0;
+    for ( Index idat=0; idat<ndat; ++idat ) {
+      bool keep = std::abs(pdat[idat]) >= thresh;
+      pdat[idat] = keep ? pdat[idat] : fill;
+      nkeep += keep;
+    }
+    return nkeep;
+  }
+
+  // Return the transpose.
+  // Blocked to keep both the reads and writes in cache.
+  Real2dData transpose() const;
+
+  // Return the sum (or median) for each row (fixed index 0) or column
+  // (fixed index 1). Median of an even count is the mean of the middle two.
+  StdVector rowSums() const;
+  StdVector columnSums() const;
+  StdVector rowMedians() const;
+  StdVector columnMedians() const;
+
+  // Return a copy with npad0 rows and npad1 columns of fill added at the end
+  // of each dimension, e.g. to zero-pad for a linear convolution with a DFT.
+  Real2dData padded(Index npad0, Index npad1, F fill =0.0) const;
+
 private:
 
+  // Data pointers with the alignment made known to the compiler.
+  const F* alignedData() const {
+    return static_cast<const F*>(__builtin_assume_aligned(m_data.data(), DataVector::allocator_type::alignment()));
+  }
+  F* alignedData() {
+    return static_cast<F*>(__builtin_assume_aligned(m_data.data(), DataVector::allocator_type::alignment()));
+  }
+
+  // Median of n values. The values are reordered.
+  static F median(F* pval, Index nval) {
+    if ( nval == 0 ) return 0.0;
+    Index imid = nval/2;
+    std::nth_element(pval, pval + imid, pval + nval);
+    F med = pval[imid];
+    if ( nval%2 == 0 ) med = 0.5*(med + *std::max_element(pval, pval + imid));
+    return med;
+  }
+
+
   IndexArray m_nsams;
   DataVector m_data;
 
@@ -224,4 +329,93 @@ private:
 
 //**********************************************************************
 
+template<typename F>
+Real2dData<F> Real2dData<F>::transpose() const {
+  const Index nblk = 32;
+  Index nrow = size(0);
+  Index ncol = size(1);
+  Real2dData out({ncol, nrow});
+  for ( Index irow0=0; irow0<nrow; irow0+=nblk ) {
+    Index irow1 = std::min(irow0 + nblk, nrow);
+    for ( Index icol0=0; icol0<ncol; icol0+=nblk ) {
+      Index icol1 = std::min(icol0 + nblk, ncol);
+      for ( Index irow=irow0; irow<irow1; ++irow ) {
+        const F* pin = row(irow);
+        for ( Index icol=icol0; icol<icol1; ++icol ) out(icol, irow) = pin[icol];
+      }
+    }
+  }
+  return out;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename Real2dData<F>::StdVector Real2dData<F>::rowSums() const {
+  Index nrow = size(0);
+  Index ncol = size(1);
+  StdVector sums(nrow, 0.0);
+  for ( Index irow=0; irow<nrow; ++irow ) {
+    const F* pin = row(irow);
+    F sum = 0.0;
+    for ( Index icol=0; icol<ncol; ++icol ) sum += pin[icol];
+    sums[irow] = sum;
+  }
+  return sums;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename Real2dData<F>::StdVector Real2dData<F>::columnSums() const {
+  Index nrow = size(0);
+  Index ncol = size(1);
+  StdVector sums(ncol, 0.0);
+  F* psum = sums.data();
+  for ( Index irow=0; irow<nrow; ++irow ) {
+    const F* pin = row(irow);
+    for ( Index icol=0; icol<ncol; ++icol ) psum[icol] += pin[icol];
+  }
+  return sums;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename Real2dData<F>::StdVector Real2dData<F>::rowMedians() const {
+  Index nrow = size(0);
+  Index ncol = size(1);
+  StdVector meds(nrow, 0.0);
+  StdVector buf(ncol);
+  for ( Index irow=0; irow<nrow; ++irow ) {
+    std::copy(row(irow), row(irow) + ncol, buf.begin());
+    meds[irow] = median(buf.data(), ncol);
+  }
+  return meds;
+}
+
+//**********************************************************************
+
+template<typename F>
+typename Real2dData<F>::StdVector Real2dData<F>::columnMedians() const {
+  Real2dData tdat = transpose();
+  return tdat.rowMedians();
+}
+
+//**********************************************************************
+
+template<typename F>
+Real2dData<F> Real2dData<F>::padded(Index npad0, Index npad1, F fill) const {
+  Index nrow = size(0);
+  Index ncol = size(1);
+  Real2dData out({nrow + npad0, ncol + npad1});
+  if ( fill != F(0) ) std::fill(out.m_data.begin(), out.m_data.end(), fill);
+  for ( Index irow=0; irow<nrow; ++irow ) {
+    std::copy(row(irow), row(irow) + ncol, out.row(irow));
+  }
+  return out;
+}
+
+//**********************************************************************
+
 #endif
@@ -7,12 +7,20 @@
 // i.e. an array of floats indexed by channel and tick.
 //
 // The data may be read with data().value(..) and written wiht data().setValue(..).
+// For loops over the ROI, use channelData(icha) to get the tick array for one
+// channel or the Real2dData row and whole-array methods.
+//
+// For FFT processing, loadBuffer() copies the data into a pooled FFTW-ready
+// buffer (see Tpc2dRoiBuffer.h) that can be transformed in place and
+// unloadBuffer() copies the result back and returns the buffer to the pool.
+// A buffer still held when the ROI is deleted is returned to the pool.
 
 #ifndef Tpc2dRoi_H
 #define Tpc2dRoi_H
 
 #include "dunecore/DuneInterface/Data/Real2dData.h"
 #include "dunecore/DuneInterface/Data/FftwReal2dDftData.h"
+#include "dunecore/DuneInterface/Data/Tpc2dRoiBuffer.h"
 #include <memory>
 
 class Tpc2dRoi {
@@ -25,6 +33,8 @@ public:
   using IndexArray = DataArray::IndexArray;
   using Dft = FftwDouble2dDftData;
   using DftPtr = std::unique_ptr<Dft>;
+  using Buffer = Tpc2dRoiBuffer;
+  using BufferPtr = std::unique_ptr<Buffer>;
 
   // Ctor for an ROI with no size.
   Tpc2dRoi() : m_sampleOffset(0), m_channelOffset(0) { }
@@ -33,6 +43,11 @@ public:
   Tpc2dRoi(Index ncha, Index nsam, Index icha0, LongIndex isam0 =0)
   : m_data({ncha, nsam}), m_sampleOffset(isam0), m_channelOffset(icha0) { }
 
+  // Move only. The buffer is returned to the pool on deletion.
+  Tpc2dRoi(Tpc2dRoi&&) =default;
+  Tpc2dRoi& operator=(Tpc2dRoi&&) =default;
+  ~Tpc2dRoi() { releaseBuffer(); }
+
   // Return the offset for the first tick wrt to a common reference.
   // Step size is one data tick assumed the same for all channels in the plane.
   LongIndex sampleOffset() const { return m_sampleOffset; }
@@ -55,13 +70,22 @@ public:
   float value(Index icha, LongIndex itck, float valdef =0.0) const {
     if ( icha < channelOffset() ) return valdef;
     if ( itck < sampleOffset() ) return valdef;
-    Index chk = 0;
-    DataArray::IndexArray idxs;
-    idxs[0] = icha - channelOffset();
-    idxs[1] = itck - sampleOffset();
-    float val = data().value(idxs, &chk);
-    if ( chk ) return valdef;
-    return val;
+    Index kcha = icha - channelOffset();
+    LongIndex ktck = itck - sampleOffset();
+    if ( kcha >= channelSize() || ktck >= sampleSize() ) return valdef;
+    return m_data(kcha, ktck);
+  }
+
+  // Return the tick array for a channel (absolute numbering).
+  // The array has length sampleSize() and its first entry is for tick
+  // sampleOffset(). Returns null if the channel is not in the ROI.
+  const float* channelData(Index icha) const {
+    if ( icha < channelOffset() || icha - channelOffset() >= channelSize() ) return nullptr;
+    return m_data.row(icha - channelOffset());
+  }
+  float* channelData(Index icha) {
+    if ( icha < channelOffset() || icha - channelOffset() >= channelSize() ) return nullptr;
+    return m_data.row(icha - channelOffset());
   }
 
   // Return a pointer to DFT. Null if undefined.
@@ -72,12 +96,42 @@ public:
   // This class now owns that DFT data.
   void resetDft(Dft* pdft) { m_pdft.reset(pdft); }
 
+  // Return the FFT buffer. Null if none is held.
+  Buffer* buffer() { return m_pbuf.get(); }
+  const Buffer* buffer() const { return m_pbuf.get(); }
+
+  // Obtain a buffer from the thread pool (if not already held) and fill it
+  // with the ROI data.
+  Buffer& loadBuffer() {
+    if ( ! m_pbuf ) m_pbuf.reset(new Buffer(Tpc2dRoiBufferPool::threadPool().acquire(m_data.nSamples())));
+    m_pbuf->copyIn(m_data);
+    return *m_pbuf;
+  }
+
+  // Copy the buffer data (scaled by fac) into the ROI data and release the
+  // buffer. Returns nonzero and keeps the buffer if there is no buffer or
+  // it holds a DFT.
+  int unloadBuffer(double fac =1.0) {
+    if ( ! m_pbuf ) return 1;
+    if ( m_pbuf->copyOut(m_data, fac) ) return 2;
+    releaseBuffer();
+    return 0;
+  }
+
+  // Return the buffer to the thread pool without copying.
+  void releaseBuffer() {
+    if ( ! m_pbuf ) return;
+    Tpc2dRoiBufferPool::threadPool().release(std::move(*m_pbuf));
+    m_pbuf.reset();
+  }
+
 private:
 
   Real2dData<float> m_data;
   LongIndex m_sampleOffset;
   Index m_channelOffset;
   DftPtr m_pdft;
+  BufferPtr m_pbuf;
 
 };
 
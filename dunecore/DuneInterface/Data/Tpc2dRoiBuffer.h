@@ -0,0 +1,240 @@
+// Tpc2dRoiBuffer.h
+//
+// FFTW-ready storage for the data of a 2D ROI and a per-thread pool of
+// such buffers.
+//
+// Tpc2dRoiFftwBuffer<F> holds n0 x n1 real values in the FFTW in-place r2c layout:
+// each row is padded to 2*(n1/2 + 1) values so that, after a forward
+// transform, the same memory holds the n0 x (n1/2 + 1) complex DFT in the
+// layout of FftwReal2dDftData. The memory is obtained with fftw_malloc and
+// so has the alignment FFTW uses for its SIMD kernels.
+//
+// F is the FFTW precision: Tpc2dRoiBuffer (double) or Tpc2dRoiFloatBuffer
+// (float). The float buffer halves the memory and bandwidth for whole-plane
+// processing.
+//
+// The buffer may be transformed in place with Fw2dFFT::fftForward(buf, norm)
+// and Fw2dFFT::fftBackward(buf, norm). isDft() records which domain the
+// buffer currently holds.
+//
+// Tpc2dRoiFftwBufferPool<F> keeps released buffers by capacity and hands out the
+// smallest one that is large enough, so ROIs of similar size reuse memory
+// across ROIs and events. Each thread has its own pool (threadPool()).
+//
+// Usage:
+//   Tpc2dRoiBuffer& buf = roi.loadBuffer();  // pooled buffer filled from ROI data
+//   fft.fftForward(buf, norm);
+//   ... modify buf.complexData() ...
+//   fft.fftBackward(buf, norm);
+//   roi.unloadBuffer();                      // copy back and return buffer to pool
+
+#ifndef Tpc2dRoiBuffer_H
+#define Tpc2dRoiBuffer_H
+
+#include "dunecore/DuneInterface/Data/Real2dData.h"
+#include "fftw3.h"
+#include <array>
+#include <complex>
+#include <map>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+template<typename F> class Tpc2dRoiFftwBuffer;
+template<typename F> class Tpc2dRoiFftwBufferPool;
+using Tpc2dRoiBuffer = Tpc2dRoiFftwBuffer<double>;
+using Tpc2dRoiFloatBuffer = Tpc2dRoiFftwBuffer<float>;
+using Tpc2dRoiBufferPool = Tpc2dRoiFftwBufferPool<double>;
+using Tpc2dRoiFloatBufferPool = Tpc2dRoiFftwBufferPool<float>;
+
+//**********************************************************************
+
+template<typename F>
+class Tpc2dRoiFftwBuffer {
+
+public:
+
+  using Index = unsigned int;
+  using IndexArray = std::array<Index,2>;
+  using Size = std::size_t;
+  using Float = F;
+  using Complex = std::complex<Float>;     // same memory layout as fftw_complex
+  using FftwComplex = Float[2];            // fftw_complex or fftwf_complex
+  using Data = Real2dData<float>;
+
+  // Number of values in each padded row for n1 real values.
+  static Index rowStride(Index n1) { return 2*(n1/2 + 1); }
+
+  // Number of values needed for dimensions nsams.
+  static Size floatSize(const IndexArray& nsams) {
+    return Size(nsams[0])*rowStride(nsams[1]);
+  }
+
+  // Ctor with no storage.
+  Tpc2dRoiFftwBuffer() =default;
+
+  // Ctor with capacity for ncap values.
+  explicit Tpc2dRoiFftwBuffer(Size ncap) { reserve(ncap); }
+
+  // Move only.
+  Tpc2dRoiFftwBuffer(const Tpc2dRoiFftwBuffer&) =delete;
+  Tpc2dRoiFftwBuffer& operator=(const Tpc2dRoiFftwBuffer&) =delete;
+  Tpc2dRoiFftwBuffer(Tpc2dRoiFftwBuffer&& rhs) noexcept { swap(rhs); }
+  Tpc2dRoiFftwBuffer& operator=(Tpc2dRoiFftwBuffer&& rhs) noexcept { swap(rhs); return *this; }
+
+  ~Tpc2dRoiFftwBuffer() { if ( m_data != nullptr ) fftw_free(m_data); }
+
+  void swap(Tpc2dRoiFftwBuffer& rhs) noexcept {
+    std::swap(m_data, rhs.m_data);
+    std::swap(m_capacity, rhs.m_capacity);
+    std::swap(m_nsams, rhs.m_nsams);
+    std::swap(m_isDft, rhs.m_isDft);
+  }
+
+  // Ensure the capacity is at least ncap values. Content is not kept.
+  void reserve(Size ncap) {
+    if ( ncap <= m_capacity ) return;
+    if ( m_data != nullptr ) fftw_free(m_data);
+    m_data = static_cast<Float*>(fftw_malloc(ncap*sizeof(Float)));
+    m_capacity = ncap;
+  }
+
+  // Set the dimensions, growing the storage if needed. The content is
+  // undefined and the buffer is marked as holding real data.
+  void reset(const IndexArray& nsams) {
+    reserve(floatSize(nsams));
+    m_nsams = nsams;
+    m_isDft = false;
+  }
+
+  // Capacity in values.
+  Size capacity() const { return m_capacity; }
+
+  // Dimensions of the real data.
+  const IndexArray& nSamples() const { return m_nsams; }
+  Index rowStride() const { return rowStride(m_nsams[1]); }
+
+  // Number of complex values in each DFT row and in the full DFT.
+  Index complexRowSize() const { return m_nsams[1]/2 + 1; }
+  Size complexSize() const { return Size(m_nsams[0])*complexRowSize(); }
+
+  // Return if the buffer holds the DFT (true) or real data (false).
+  bool isDft() const { return m_isDft; }
+  void setDft(bool val) { m_isDft = val; }
+
+  // Real data access. Row irow holds n1 values followed by padding.
+  Float* data() { return m_data; }
+  const Float* data() const { return m_data; }
+  Float* row(Index irow) { return m_data + Size(irow)*rowStride(); }
+  const Float* row(Index irow) const { return m_data + Size(irow)*rowStride(); }
+
+  // DFT access.
+  Complex* complexData() { return reinterpret_cast<Complex*>(m_data); }
+  const Complex* complexData() const { return reinterpret_cast<const Complex*>(m_data); }
+  FftwComplex* fftwData() { return reinterpret_cast<FftwComplex*>(m_data); }
+
+  // Fill from 2D data. The dimensions are taken from the data.
+  void copyIn(const Data& dat) {
+    reset(dat.nSamples());
+    Index n1 = m_nsams[1];
+    Index nstr = rowStride();
+    for ( Index irow=0; irow<m_nsams[0]; ++irow ) {
+      const float* pin = dat.row(irow);
+      Float* pout = row(irow);
+      for ( Index icol=0; icol<n1; ++icol ) pout[icol] = pin[icol];
+      for ( Index icol=n1; icol<nstr; ++icol ) pout[icol] = 0.0;
+    }
+  }
+
+  // Copy real data out, scaling by fac. Returns nonzero if the buffer holds a DFT.
+  int copyOut(Data& dat, Float fac =1.0) const {
+    if ( m_isDft ) return 1;
+    if ( dat.nSamples() != m_nsams ) dat.reset(m_nsams);
+    Index n1 = m_nsams[1];
+    for ( Index irow=0; irow<m_nsams[0]; ++irow ) {
+      const Float* pin = row(irow);
+      float* pout = dat.row(irow);
+      for ( Index icol=0; icol<n1; ++icol ) pout[icol] = fac*pin[icol];
+    }
+    return 0;
+  }
+
+private:
+
+  Float* m_data =nullptr;
+  Size m_capacity =0;
+  IndexArray m_nsams = {0, 0};
+  bool m_isDft =false;
+
+};
+
+//**********************************************************************
+
+template<typename F>
+class Tpc2dRoiFftwBufferPool {
+
+public:
+
+  using Buffer = Tpc2dRoiFftwBuffer<F>;
+  using Size = typename Buffer::Size;
+  using IndexArray = typename Buffer::IndexArray;
+
+  // Return the pool for the current thread.
+  static Tpc2dRoiFftwBufferPool& threadPool() {
+    thread_local Tpc2dRoiFftwBufferPool pool;
+    return pool;
+  }
+
+  // Set the maximum number of buffers held in the pool.
+  void setMaxBuffers(Size nmax) { m_maxBuffers = nmax; }
+  Size maxBuffers() const { return m_maxBuffers; }
+
+  // Return the number of buffers in the pool.
+  Size bufferCount() const { return m_count; }
+
+  // Return a buffer reset to dimensions nsams.
+  // The smallest pooled buffer with sufficient capacity is used if there
+  // is one. Otherwise a new buffer is allocated.
+  Buffer acquire(const IndexArray& nsams) {
+    Buffer buf;
+    Size ncap = Buffer::floatSize(nsams);
+    auto ibuf = m_bufs.lower_bound(ncap);
+    if ( ibuf != m_bufs.end() ) {
+      buf = std::move(ibuf->second.back());
+      ibuf->second.pop_back();
+      if ( ibuf->second.empty() ) m_bufs.erase(ibuf);
+      --m_count;
+    }
+    buf.reset(nsams);
+    return buf;
+  }
+
+  // Return a buffer to the pool. It is freed if the pool is full.
+  void release(Buffer&& buf) {
+    Size ncap = buf.capacity();
+    if ( ncap == 0 ) return;
+    if ( m_count >= m_maxBuffers ) {
+      Buffer tmp(std::move(buf));
+      return;
+    }
+    m_bufs[ncap].push_back(std::move(buf));
+    ++m_count;
+  }
+
+  // Free all pooled buffers.
+  void clear() {
+    m_bufs.clear();
+    m_count = 0;
+  }
+
+private:
+
+  std::map<Size, std::vector<Buffer>> m_bufs;
+  Size m_count =0;
+  Size m_maxBuffers =1000;
+
+};
+
+//**********************************************************************
+
+#endif
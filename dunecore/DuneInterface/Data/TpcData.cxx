@@ -1,6 +1,7 @@
 // TpcData.cxx
 
 #include "dunecore/DuneInterface/Data/TpcData.h"
+#include "dunecore/DuneInterface/Data/AdcBufferPool.h"
 
 using std::cout;
 using std::endl;
@@ -21,6 +22,15 @@ TpcData::TpcData(const AdcDataVector& adcs) : m_parent(nullptr), m_adcs(adcs) {
 
 //**********************************************************************
 
+TpcData::~TpcData() {
+  // Delete the constituents first so ADC data shared with them is
+  // owned only by this object when it is cleared.
+  m_dat.clear();
+  clearAdcData();
+}
+
+//**********************************************************************
+
 TpcData* TpcData::addTpcData(Name nam, bool copyAdcData) {
   if ( nam == "" || nam == "." ) return nullptr;
   Name::size_type ipos = nam.rfind("/");
@@ -102,6 +112,20 @@ TpcData::AdcDataPtr TpcData::createAdcData(bool updateParent) {
 
 //**********************************************************************
 
+TpcData::AdcDataPtr
+TpcData::createAdcData(const AdcChannelVector& chans, Index nsam, bool updateParent) {
+  AdcDataPtr padc(new AdcChannelDataMap);
+  AdcBufferPool& pool = AdcBufferPool::threadPool();
+  for ( AdcChannel icha : chans ) {
+    AdcChannelData& acd = (*padc)[icha];
+    acd.setChannelInfo(icha);
+    pool.acquire(acd, nsam);
+  }
+  return addAdcData(padc, updateParent);
+}
+
+//**********************************************************************
+
 TpcData::AdcDataPtr TpcData::addAdcData(AdcDataPtr padc, bool updateParent) {
   m_adcs.push_back(padc);
   if ( updateParent && m_parent != nullptr ) m_parent->addAdcData(padc, true);
@@ -111,6 +135,10 @@ TpcData::AdcDataPtr TpcData::addAdcData(AdcDataPtr padc, bool updateParent) {
 //**********************************************************************
 
 void TpcData::clearAdcData() {
+  AdcBufferPool& pool = AdcBufferPool::threadPool();
+  for ( AdcDataPtr& padc : m_adcs ) {
+    if ( padc && padc.use_count() == 1 ) pool.release(*padc);
+  }
   m_adcs.clear();
 }
 
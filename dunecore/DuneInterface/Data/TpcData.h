@@ -47,6 +47,9 @@ public:
   // Copy ctor.
   TpcData(const TpcData& rhs) =delete;
 
+  // Dtor. ADC data owned only by this object is released to the buffer pool.
+  ~TpcData();
+
   // Accessors.
   TpcData* getParent() { return m_parent; }
   const TpcData* getParent() const { return m_parent; }
@@ -81,10 +84,16 @@ public:
 
   // Add ADC data.
   // If updateParent is true, the same object is added to all ancestors.
+  // The second form creates an entry for each channel in chans with raw,
+  // samples and flags reserved for nsam ticks from the thread buffer pool
+  // so that buffers released by earlier events are reused.
   AdcDataPtr createAdcData(bool updateParent =true);
+  AdcDataPtr createAdcData(const AdcChannelVector& chans, Index nsam, bool updateParent =true);
   AdcDataPtr addAdcData(AdcDataPtr padc, bool updateParent =true);
 
   // Delete the ADC data. References in acestor and descendants are not affected.
+  // Sample buffers of ADC data not referenced elsewhere are returned to the
+  // thread buffer pool (see AdcBufferPool.h) for reuse in later events.
   void clearAdcData();
 
   // Print a brief description of thid object:
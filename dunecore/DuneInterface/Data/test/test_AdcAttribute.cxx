@@ -0,0 +1,166 @@
+// test_AdcAttribute.cxx
+//
+// Test AdcAttribute and the attribute access in AdcChannelData.
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+//**********************************************************************
+
+int test_AdcAttribute() {
+  const string myname = "test_AdcAttribute: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = myname + "-----------------------------";
+
+  cout << line << endl;
+  cout << myname << "Check attribute parsing." << endl;
+  AdcAttribute aped("pedestal");
+  assert( aped.key() == AdcAttribute::Pedestal );
+  assert( aped.level() == 0 );
+  assert( aped.isBuiltin() );
+  assert( AdcAttribute::builtinKey("metadata") == AdcAttribute::Metadata );
+  assert( AdcAttribute::builtinName(AdcAttribute::Channel) == "channel" );
+  AdcAttribute amy("myNewAttribute");
+  assert( amy.isMetadata() );
+  assert( ! amy.isBuiltin() );
+  assert( amy.name() == "myNewAttribute" );
+  AdcAttribute apar("../../myNewAttribute");
+  assert( apar.level() == 2 );
+  assert( apar.isMetadata() );
+  assert( apar.name() == "myNewAttribute" );
+  assert( apar.fullName() == "../../myNewAttribute" );
+  AdcAttribute apped("../pedestal");
+  assert( apped.key() == AdcAttribute::Pedestal );
+  assert( apped.level() == 1 );
+  AdcAttribute achan(AdcAttribute::Channel);
+  assert( achan.name() == "channel" );
+
+  cout << line << endl;
+  cout << myname << "Check channel data." << endl;
+  AdcChannelData acd;
+  acd.setChannelInfo(123);
+  acd.pedestal = 12.5;
+  acd.samples.resize(20);
+  acd.setMetadata("myNewAttribute", 4.5);
+  assert( acd.getAttribute(aped) == 12.5 );
+  assert( acd.getAttribute("pedestal") == 12.5 );
+  assert( acd.getAttribute(AdcAttribute::Channel) == 123 );
+  assert( acd.getAttribute("samples") == 20 );
+  assert( acd.getAttribute(amy) == 4.5 );
+  assert( acd.getAttribute("myNewAttribute") == 4.5 );
+  assert( acd.getAttribute("notSet", -1.0) == -1.0 );
+  assert( acd.getAttribute("metadata") == 1 );
+  assert( acd.hasAttribute(aped) );
+  assert( acd.hasAttribute(amy) );
+  assert( ! acd.hasAttribute(AdcAttribute("zzz")) );
+  assert( ! acd.hasAttribute("notSet") );
+  acd.setMetadata("zzz", 7.0);
+  assert( acd.hasMetadata("zzz") );
+  assert( acd.getMetadata(AdcAttribute("zzz")) == 7.0 );
+
+  cout << line << endl;
+  cout << myname << "Metadata is a name-indexed map." << endl;
+  const AdcChannelData::FloatMap& mdat = acd.metadata;
+  assert( mdat.size() == 2 );
+  assert( mdat.begin()->first == "myNewAttribute" );
+  assert( mdat.at("zzz") == 7.0 );
+
+  cout << line << endl;
+  cout << myname << "Metadata index." << endl;
+  assert( acd.hasMetadataIndex() );
+  assert( amy.fieldKey() == AdcAttribute::fieldKey("myNewAttribute") );
+  assert( apar.fieldKey() == amy.fieldKey() );
+  AdcAttribute aidx("indexed");
+  acd.setMetadata(aidx, 2.5);
+  assert( acd.hasMetadataIndex() );
+  assert( acd.metadata.at("indexed") == 2.5 );
+  assert( acd.getMetadata(aidx) == 2.5 );
+  acd.setMetadata(aidx, 3.5);
+  assert( acd.hasMetadataIndex() );
+  assert( acd.metadata.size() == 3 );
+  assert( acd.getAttribute(aidx) == 3.5 );
+  // A direct insert into the map is seen through the map fallback.
+  acd.metadata["direct"] = 1.5;
+  assert( ! acd.hasMetadataIndex() );
+  assert( acd.getMetadata("direct") == 1.5 );
+  assert( acd.getMetadata(aidx) == 3.5 );
+  // A direct value change needs indexMetadata.
+  acd.metadata["direct"] = 0.5;
+  acd.indexMetadata();
+  assert( acd.hasMetadataIndex() );
+  assert( acd.getMetadata("direct") == 0.5 );
+  assert( acd.hasAttribute("direct") );
+  assert( ! acd.hasMetadata("nosuch") );
+  acd.metadata.erase("direct");
+  acd.metadata.erase("indexed");
+  assert( ! acd.hasMetadataIndex() );
+  assert( ! acd.hasMetadata("direct") );
+  acd.setMetadata("zzz", 7.0);
+  assert( acd.hasMetadataIndex() );
+  assert( ! acd.hasMetadata(aidx) );
+
+  cout << line << endl;
+  cout << myname << "Check parent access." << endl;
+  AdcChannelData::View& vw = acd.updateView("sub");
+  vw.resize(1);
+  AdcChannelData& acdv = vw[0];
+  acdv.viewParent = &acd;
+  acdv.pedestal = 1.0;
+  assert( acdv.getAttribute(aped) == 1.0 );
+  assert( acdv.getAttribute(apped) == 12.5 );
+  assert( acdv.getAttribute("../pedestal") == 12.5 );
+  assert( acdv.getMetadata("../zzz") == 7.0 );
+  assert( acdv.hasMetadata("../zzz") );
+  assert( ! acdv.hasMetadata("zzz") );
+  assert( ! acd.hasAttribute(apped) );
+  assert( acd.getAttribute(apped, -2.0) == -2.0 );
+  assert( ! acdv.hasAttribute(apar) );
+  acdv.setMetadata("../fromView", 9.0);
+  assert( acd.getMetadata("fromView") == 9.0 );
+  assert( ! acdv.hasMetadata("fromView") );
+  assert( acd.hasMetadataIndex() );
+
+  cout << line << endl;
+  cout << myname << "Concurrent access." << endl;
+  {
+    std::vector<std::thread> threads;
+    std::vector<int> oks(4, 0);
+    for ( int ithr=0; ithr<4; ++ithr ) {
+      threads.emplace_back([&acdv, &oks, ithr]() {
+        bool ok = true;
+        for ( int itry=0; itry<1000; ++itry ) {
+          ok &= acdv.getAttribute("../myNewAttribute") == 4.5;
+          ok &= acdv.getAttribute(AdcAttribute("pedestal")) == 1.0;
+        }
+        oks[ithr] = ok;
+      });
+    }
+    for ( std::thread& thr : threads ) thr.join();
+    for ( int ok : oks ) assert( ok );
+  }
+
+  cout << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_AdcAttribute();
+}
+
+//**********************************************************************
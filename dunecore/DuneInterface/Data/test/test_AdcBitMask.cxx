@@ -0,0 +1,125 @@
+// test_AdcBitMask.cxx
+//
+// Test AdcBitMask.
+
+#include <string>
+#include <iostream>
+#include "dunecore/DuneInterface/Data/AdcBitMask.h"
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include "dunecore/DuneInterface/Data/AdcCountSelection.h"
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+using Index = AdcIndex;
+
+//**********************************************************************
+
+int test_AdcBitMask() {
+  const string myname = "test_AdcBitMask: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = myname + "-----------------------------";
+
+  cout << line << endl;
+  cout << myname << "Check construction and access." << endl;
+  AdcBitMask msk0(130, true);
+  assert( msk0.size() == 130 );
+  assert( msk0.words().size() == 3 );
+  assert( msk0.count() == 130 );
+  assert( msk0.all() );
+  msk0.resize(200, true);
+  assert( msk0.count() == 200 );
+  msk0.flip();
+  assert( ! msk0.any() );
+  msk0.set(3);
+  msk0.set(64);
+  msk0.set(199);
+  assert( msk0.count() == 3 );
+  assert( msk0.test(64) );
+  assert( ! msk0[65] );
+  assert( msk0.findNext(0) == 3 );
+  assert( msk0.findNext(4) == 64 );
+  assert( msk0.findNext(65) == 199 );
+  assert( msk0.findNextUnset(64) == 65 );
+  assert( msk0.findNextUnset(199) == 200 );
+  Index nset = 0;
+  msk0.forEachSet([&nset](Index ibit) { assert( ibit == 3 || ibit == 64 || ibit == 199 ); ++nset; });
+  assert( nset == 3 );
+
+  cout << line << endl;
+  cout << myname << "Check ROI conversion." << endl;
+  AdcRoiVector rois = {{2, 5}, {60, 140}, {190, 250}};
+  AdcBitMask msk1(rois, 200);
+  assert( msk1.count() == 4 + 81 + 10 );
+  AdcRoiVector rois1 = msk1.toRois();
+  assert( rois1.size() == 3 );
+  assert( rois1[1] == AdcRoi(60, 140) );
+  assert( rois1[2] == AdcRoi(190, 199) );
+  msk1.dilate(2, 3);
+  rois1 = msk1.toRois();
+  assert( rois1.size() == 3 );
+  assert( rois1[0] == AdcRoi(0, 8) );
+  assert( rois1[1] == AdcRoi(58, 143) );
+  assert( rois1[2] == AdcRoi(188, 199) );
+  AdcFilterVector filt = msk1.toFilter();
+  assert( filt.size() == 200 );
+  assert( filt[58] && ! filt[57] );
+  assert( AdcBitMask(filt) == msk1 );
+
+  cout << line << endl;
+  cout << myname << "Check threshold." << endl;
+  AdcSignalVector sams(100, 0.0);
+  sams[10] = 5.0;
+  sams[11] = 20.0;
+  sams[80] = -20.0;
+  AdcBitMask msk2(sams, 10.0);
+  assert( msk2.count() == 1 );
+  assert( msk2.test(11) );
+  AdcBitMask msk3(sams, 10.0, true);
+  assert( msk3.count() == 2 );
+  assert( msk3.test(80) );
+  msk3 &= msk2;
+  assert( msk3 == msk2 );
+
+  cout << line << endl;
+  cout << myname << "Check channel data and selection." << endl;
+  AdcChannelData acd;
+  acd.samples = sams;
+  acd.flags.resize(100, AdcGood);
+  acd.flags[70] = AdcOverflow;
+  AdcBitMask sig(acd.samples, 10.0, true);
+  sig.dilate(1, 1);
+  acd.setSignal(sig);
+  assert( acd.signal.size() == 100 );
+  assert( acd.signal[12] );
+  assert( acd.rois.size() == 2 );
+  assert( acd.rois[0] == AdcRoi(10, 12) );
+  assert( acd.signalMask() == sig );
+  assert( acd.roiMask() == sig );
+  assert( acd.flagMask().count() == 1 );
+  AdcCountVector cnts(100, 0);
+  AdcCountSelection acs(cnts, 1, 0.0);
+  assert( acs.filterMask().all() );
+  acs.setFilter(sig);
+  assert( ! acs.filter[0] );
+  assert( acs.filter[11] );
+
+  cout << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_AdcBitMask();
+}
+
+//**********************************************************************
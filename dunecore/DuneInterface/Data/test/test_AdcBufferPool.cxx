@@ -0,0 +1,137 @@
+// test_AdcBufferPool.cxx
+//
+// Test AdcBufferPool.
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "dunecore/DuneInterface/Data/AdcBufferPool.h"
+#include "dunecore/DuneInterface/Data/TpcData.h"
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Index = AdcIndex;
+
+//**********************************************************************
+
+int test_AdcBufferPool() {
+  const string myname = "test_AdcBufferPool: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = myname + "-----------------------------";
+
+  AdcBufferPool& pool = AdcBufferPool::threadPool();
+  assert( &pool == &AdcBufferPool::threadPool() );
+  pool.clear();
+  assert( pool.bufferCount<AdcCount>() == 0 );
+  assert( pool.bufferCount<AdcSignal>() == 0 );
+
+  cout << line << endl;
+  cout << myname << "Acquire from empty pool." << endl;
+  Index nsam = 1000;
+  AdcChannelData acd;
+  pool.acquire(acd, nsam);
+  assert( acd.raw.capacity() >= nsam );
+  assert( acd.samples.capacity() >= nsam );
+  assert( acd.flags.capacity() >= nsam );
+  acd.raw.resize(nsam, 1);
+  acd.samples.resize(nsam, 2.0);
+  const AdcSignal* psam = acd.samples.data();
+
+  cout << line << endl;
+  cout << myname << "Release and reuse." << endl;
+  pool.release(acd);
+  assert( acd.raw.empty() );
+  assert( acd.samples.capacity() == 0 );
+  assert( pool.bufferCount<AdcCount>() == 2 );
+  assert( pool.bufferCount<AdcFlag>() == 2 );
+  assert( pool.bufferCount<AdcSignal>() == 1 );
+  AdcSignalVector sams;
+  assert( pool.acquire(sams, 500) );
+  assert( sams.data() == psam );
+  assert( sams.empty() );
+  assert( pool.bufferCount<AdcSignal>() == 0 );
+  assert( ! pool.acquire(sams, 2000) );
+  assert( pool.bufferCount<AdcSignal>() == 1 );
+
+  cout << line << endl;
+  cout << myname << "Check limit." << endl;
+  pool.clear();
+  pool.setMaxBuffers(1);
+  AdcCountVector v1(10), v2(10);
+  pool.release(v1);
+  pool.release(v2);
+  assert( pool.bufferCount<AdcCount>() == 1 );
+  pool.setMaxBuffers(100000);
+
+  cout << line << endl;
+  cout << myname << "Release from TpcData." << endl;
+  pool.clear();
+  {
+    TpcData tpd;
+    TpcData* psub = tpd.addTpcData("sub");
+    TpcData::AdcDataPtr padc = psub->createAdcData();
+    for ( AdcChannel icha=0; icha<5; ++icha ) (*padc)[icha].samples.resize(nsam);
+    padc.reset();
+  }
+  assert( pool.bufferCount<AdcSignal>() == 5 );
+  {
+    TpcData tpd;
+    TpcData::AdcDataPtr padc = tpd.createAdcData();
+    (*padc)[0].samples.resize(nsam);
+    tpd.clearAdcData();
+    assert( (*padc)[0].samples.size() == nsam );
+  }
+  assert( pool.bufferCount<AdcSignal>() == 5 );
+
+  cout << line << endl;
+  cout << myname << "Reuse in TpcData." << endl;
+  pool.clear();
+  AdcChannelVector chans = {10, 11, 12};
+  vector<const AdcSignal*> psams;
+  {
+    TpcData tpd;
+    TpcData::AdcDataPtr padc = tpd.createAdcData(chans, nsam);
+    assert( padc->size() == chans.size() );
+    assert( pool.bufferCount<AdcSignal>() == 0 );
+    for ( AdcChannelDataMap::value_type& iacd : *padc ) {
+      assert( iacd.second.channel() == iacd.first );
+      assert( iacd.second.samples.capacity() >= nsam );
+      psams.push_back(iacd.second.samples.data());
+    }
+  }
+  assert( pool.bufferCount<AdcSignal>() == chans.size() );
+  assert( pool.bufferCount<AdcCount>() == 2*chans.size() );
+  {
+    TpcData tpd;
+    TpcData::AdcDataPtr padc = tpd.createAdcData(chans, nsam);
+    assert( pool.bufferCount<AdcSignal>() == 0 );
+    assert( pool.bufferCount<AdcCount>() == 0 );
+    for ( AdcChannelDataMap::value_type& iacd : *padc ) {
+      const AdcSignal* psam = iacd.second.samples.data();
+      assert( std::find(psams.begin(), psams.end(), psam) != psams.end() );
+    }
+  }
+  assert( pool.bufferCount<AdcSignal>() == chans.size() );
+
+  cout << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_AdcBufferPool();
+}
+
+//**********************************************************************
@@ -0,0 +1,186 @@
+// test_AdcChannelBlock.cxx
+//
+// Test AdcChannelBlock.
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include "dunecore/DuneInterface/Data/AdcChannelBlock.h"
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::vector;
+
+using Index = AdcIndex;
+
+//**********************************************************************
+
+int test_AdcChannelBlock() {
+  const string myname = "test_AdcChannelBlock: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = myname + "-----------------------------";
+
+  cout << line << endl;
+  cout << myname << "Create channel map." << endl;
+  AdcChannelDataMap acds;
+  AdcChannelData::EventInfoPtr pevi(new DuneEventInfo(123, 456));
+  vector<AdcChannel> chans = {105, 101, 103};
+  for ( AdcChannel chan : chans ) {
+    AdcChannelData& acd = acds[chan];
+    acd.setEventInfo(pevi);
+    acd.setChannelInfo(chan, 7);
+    acd.pedestal = 500 + chan;
+    acd.tick0 = chan;
+    acd.sampleUnit = "ADC count";
+    Index nsam = chan - 95;
+    for ( Index isam=0; isam<nsam; ++isam ) {
+      acd.raw.push_back(chan + isam);
+      acd.samples.push_back(0.5*isam);
+    }
+  }
+
+  cout << line << endl;
+  cout << myname << "Create block." << endl;
+  AdcChannelBlock blk(acds);
+  assert( blk.nChannel() == 3 );
+  assert( blk.stride() == 10 );
+  assert( blk.hasRaw() );
+  assert( blk.hasSamples() );
+  assert( ! blk.hasFlags() );
+  assert( blk.channel(0) == 101 );
+  assert( blk.channel(2) == 105 );
+  assert( blk.channelIndex(103) == 1 );
+  assert( blk.channelIndex(102) == AdcChannelBlock::badIndex() );
+  assert( blk.nSample(0) == 6 );
+  assert( blk.nSample(2) == 10 );
+  assert( blk.sampleUnit() == "ADC count" );
+  assert( blk.rawData().size() == 30 );
+  assert( blk.raw(1) == blk.rawData().data() + 10 );
+  assert( blk.raw(0)[5] == 106 );
+  assert( blk.raw(0)[6] == 0 );
+  assert( blk.samples(2)[9] == 4.5 );
+  assert( blk.pedestals()[1] == 603 );
+  assert( blk.tick0s()[2] == 105 );
+
+  cout << line << endl;
+  cout << myname << "Update block and export." << endl;
+  for ( Index icha=0; icha<blk.nChannel(); ++icha ) {
+    AdcSignal* psam = blk.samples(icha);
+    for ( Index isam=0; isam<blk.nSample(icha); ++isam ) psam[isam] += 1.0;
+  }
+  AdcFlag* pflg = blk.flags(1);
+  assert( blk.hasFlags() );
+  pflg[2] = AdcOverflow;
+  assert( blk.exportTo(acds) == 0 );
+  const AdcChannelData& acd = acds[103];
+  assert( acd.samples.size() == 8 );
+  assert( acd.samples[0] == 1.0 );
+  assert( acd.flags.size() == 8 );
+  assert( acd.flags[2] == AdcOverflow );
+  assert( acd.channel() == 103 );
+  assert( acd.fembID() == 7 );
+  assert( acd.run() == 123 );
+
+  cout << line << endl;
+  cout << myname << "Convert to map." << endl;
+  AdcChannelDataMap acds2 = blk.toChannelDataMap();
+  assert( acds2.size() == 3 );
+  assert( acds2[105].raw.size() == 10 );
+  assert( acds2[105].raw[9] == 114 );
+  assert( acds2[101].event() == 456 );
+
+  cout << line << endl;
+  cout << myname << "View a channel." << endl;
+  {
+    AdcChannelData vacd;
+    blk.viewChannel(2, vacd);
+    assert( vacd.hasSampleRef() );
+    assert( vacd.samples.empty() );
+    assert( vacd.raw.empty() );
+    assert( vacd.sampleData() == blk.samples(2) );
+    assert( vacd.sampleCount() == 10 );
+    assert( vacd.sample(9) == 5.5 );
+    assert( vacd.pedestal == 605 );
+    assert( vacd.channel() == 105 );
+    // Reading and writing back the unmodified view copies nothing.
+    vacd.pedestal = 600;
+    assert( blk.importView(2, vacd) == 0 );
+    assert( blk.pedestals()[2] == 600 );
+    assert( blk.samples(2)[9] == 5.5 );
+    assert( blk.nRaw(2) == 10 );
+    assert( blk.raw(2)[9] == 114 );
+    // Modified samples are copied and written back.
+    AdcSignalVector& sams = vacd.mutableSamples();
+    assert( ! vacd.hasSampleRef() );
+    for ( AdcSignal& sam : sams ) sam *= 2.0;
+    assert( blk.samples(2)[9] == 5.5 );
+    assert( blk.importView(2, vacd) == 0 );
+    assert( blk.samples(2)[9] == 11.0 );
+    assert( blk.nSample(2) == 10 );
+    assert( blk.raw(2)[9] == 114 );
+    assert( blk.flags(1)[2] == AdcOverflow );
+  }
+
+  cout << line << endl;
+  cout << myname << "Import with truncation." << endl;
+  AdcChannelBlock blk2(chans, 4);
+  assert( blk2.nChannel() == 3 );
+  assert( ! blk2.hasRaw() );
+  assert( blk2.importChannel(2, acds[105]) == 6 );
+  assert( blk2.nSample(2) == 4 );
+  assert( blk2.raw(2)[3] == 108 );
+  assert( blk2.raw(0)[0] == 0 );
+
+  cout << line << endl;
+  cout << myname << "Fields with different lengths." << endl;
+  {
+    AdcChannelDataMap acds3;
+    acds3[201].raw.assign(12, 3);
+    acds3[201].samples.assign(5, 1.5);
+    acds3[202].samples.assign(7, 2.5);
+    AdcChannelBlock blk3(acds3);
+    assert( blk3.stride() == 12 );
+    assert( blk3.nRaw(0) == 12 );
+    assert( blk3.nSample(0) == 5 );
+    assert( blk3.nFlag(0) == 0 );
+    assert( blk3.nRaw(1) == 0 );
+    assert( blk3.nSample(1) == 7 );
+    AdcChannelDataMap acds4 = blk3.toChannelDataMap();
+    assert( acds4[201].raw.size() == 12 );
+    assert( acds4[201].samples.size() == 5 );
+    assert( acds4[201].flags.empty() );
+    assert( acds4[202].raw.empty() );
+    assert( acds4[202].samples.size() == 7 );
+    cout << myname << "Reuse a row." << endl;
+    AdcChannelData acdnew;
+    acdnew.samples.assign(2, 9.0);
+    assert( blk3.importChannel(0, acdnew) == 0 );
+    assert( blk3.nRaw(0) == 0 );
+    assert( blk3.nSample(0) == 2 );
+    assert( blk3.raw(0)[0] == 0 );
+    assert( blk3.samples(0)[2] == 0.0 );
+    AdcChannelData acdout;
+    blk3.exportChannel(0, acdout);
+    assert( acdout.raw.empty() );
+    assert( acdout.samples.size() == 2 );
+  }
+
+  cout << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_AdcChannelBlock();
+}
+
+//**********************************************************************
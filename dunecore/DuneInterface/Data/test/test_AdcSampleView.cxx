@@ -0,0 +1,133 @@
+// test_AdcSampleView.cxx
+//
+// Test the referenced-sample views of AdcChannelData.
+
+#include <string>
+#include <iostream>
+#include "dunecore/DuneInterface/Data/AdcChannelData.h"
+#include "dunecore/DuneInterface/Data/AdcChannelBlock.h"
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+using Index = AdcIndex;
+
+//**********************************************************************
+
+int test_AdcSampleView() {
+  const string myname = "test_AdcSampleView: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = myname + "-----------------------------";
+
+  cout << line << endl;
+  cout << myname << "Create data." << endl;
+  AdcChannelData acd;
+  acd.setEventInfo(111, 222);
+  acd.setChannelInfo(333);
+  acd.tick0 = 10;
+  acd.pedestal = 500.0;
+  acd.sampleUnit = "ke";
+  Index nsam = 2500;
+  for ( Index isam=0; isam<nsam; ++isam ) acd.samples.push_back(isam);
+  assert( ! acd.hasSampleRef() );
+  assert( acd.sampleCount() == nsam );
+  assert( acd.sampleData() == acd.samples.data() );
+
+  cout << line << endl;
+  cout << myname << "Create views." << endl;
+  string vnam = "trun1000";
+  for ( Index ibeg=0; ibeg<nsam; ibeg+=1000 ) acd.addSampleView(vnam, ibeg, 1000);
+  assert( acd.viewSize(vnam) == 3 );
+  for ( Index ivie=0; ivie<3; ++ivie ) {
+    const AdcChannelData& vacd = *acd.viewEntry(vnam, ivie);
+    assert( vacd.hasSampleRef() );
+    assert( vacd.samples.empty() );
+    assert( vacd.sampleData() == acd.samples.data() + 1000*ivie );
+    assert( vacd.tick0 == AdcInt(10 + 1000*ivie) );
+    assert( vacd.channel() == 333 );
+    assert( vacd.run() == 111 );
+    assert( vacd.sampleUnit == "ke" );
+    assert( vacd.getAttribute("../pedestal") == 500.0 );
+  }
+  const AdcChannelData& vlast = *acd.viewEntry(vnam, 2);
+  assert( vlast.sampleCount() == 500 );
+  assert( vlast.sample(0) == 2000 );
+  assert( vlast.getAttribute("samples") == 500 );
+
+  cout << line << endl;
+  cout << myname << "Nested view." << endl;
+  AdcChannelData& vmid = *acd.mutableViewEntry(vnam, 1);
+  AdcChannelData& vsub = vmid.addSampleView("sub", 100, 10);
+  assert( vsub.sample(0) == 1100 );
+  assert( vsub.tick0 == 1110 );
+
+  cout << line << endl;
+  cout << myname << "Copy on write." << endl;
+  AdcSignalVector& sams = vmid.mutableSamples();
+  assert( ! vmid.hasSampleRef() );
+  assert( sams.size() == 1000 );
+  sams[0] = -1.0;
+  assert( acd.samples[1000] == 1000 );
+  assert( vmid.sample(0) == -1.0 );
+  assert( vsub.sample(0) == 1100 );
+
+  cout << line << endl;
+  cout << myname << "Copies do not reference samples." << endl;
+  {
+    AdcChannelData acdcopy(vlast);
+    assert( ! acdcopy.hasSampleRef() );
+    assert( acdcopy.sampleCount() == 0 );
+  }
+
+  cout << line << endl;
+  cout << myname << "Held samples take precedence." << endl;
+  {
+    AdcChannelData& vdir = acd.addSampleView("direct", 0, 10);
+    assert( vdir.hasSampleRef() );
+    vdir.samples.assign(3, -5.0);
+    assert( ! vdir.hasSampleRef() );
+    assert( vdir.sampleCount() == 3 );
+    assert( vdir.sampleData() == vdir.samples.data() );
+    assert( vdir.mutableSamples().size() == 3 );
+    vdir.samples.clear();
+    assert( ! vdir.hasSampleRef() );
+    assert( vdir.sampleCount() == 0 );
+  }
+
+  cout << line << endl;
+  cout << myname << "Import to block." << endl;
+  AdcChannelDataMap acds;
+  acds[333] = std::move(acd.addSampleView("tmp", 2000, 500));
+  assert( acds[333].hasSampleRef() );
+  AdcChannelBlock blk(acds);
+  assert( blk.stride() == 500 );
+  assert( blk.samples(0)[1] == 2001 );
+  blk.exportTo(acds);
+  assert( ! acds[333].hasSampleRef() );
+  assert( acds[333].samples.size() == 500 );
+
+  cout << line << endl;
+  cout << myname << "Clear." << endl;
+  vsub.clear();
+  assert( ! vsub.hasSampleRef() );
+  assert( vsub.sampleCount() == 0 );
+
+  cout << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_AdcSampleView();
+}
+
+//**********************************************************************
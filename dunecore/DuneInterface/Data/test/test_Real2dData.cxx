@@ -0,0 +1,108 @@
+// test_Real2dData.cxx
+//
+// Test Real2dData.
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include "dunecore/DuneInterface/Data/Real2dData.h"
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+using Data = Float2dData;
+using Index = Data::Index;
+
+//**********************************************************************
+
+int test_Real2dData() {
+  const string myname = "test_Real2dData: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = myname + "-----------------------------";
+
+  cout << line << endl;
+  cout << myname << "Create data." << endl;
+  Index nrow = 37;
+  Index ncol = 70;
+  Data dat({nrow, ncol});
+  assert( dat.isValid() );
+  assert( reinterpret_cast<std::uintptr_t>(dat.dataPointer())%64 == 0 );
+  for ( Index irow=0; irow<nrow; ++irow ) {
+    float* prow = dat.row(irow);
+    for ( Index icol=0; icol<ncol; ++icol ) prow[icol] = 100*irow + icol;
+  }
+  assert( dat(3, 5) == 305 );
+  assert( dat.value({3, 5}) == 305 );
+  Data::StdVector vals(dat.data().begin(), dat.data().end());
+  Data dat2({nrow, ncol}, vals);
+  assert( dat2(36, 69) == 3669 );
+
+  cout << line << endl;
+  cout << myname << "Element-wise operations." << endl;
+  assert( dat2.add(dat, -1.0) == 0 );
+  assert( dat2.power() == 0.0 );
+  dat2.add(2.0);
+  dat2.scale(3.0);
+  assert( dat2(10, 10) == 6.0 );
+  assert( dat2.add(Data({2, 2})) == 1 );
+  Data dat3({nrow, ncol}, vals);
+  dat3.add(-50.0);
+  Index nkeep = dat3.threshold(20.0);
+  assert( nkeep == nrow*ncol - 39 );
+  assert( dat3(0, 29) == -21.0 );
+  assert( dat3(0, 30) == -20.0 );
+  assert( dat3(0, 31) == 0.0 );
+  assert( dat3(0, 69) == 0.0 );
+  assert( dat3(1, 0) == 50.0 );
+
+  cout << line << endl;
+  cout << myname << "Transpose." << endl;
+  Data tdat = dat.transpose();
+  assert( tdat.size(0) == ncol );
+  assert( tdat.size(1) == nrow );
+  for ( Index irow=0; irow<nrow; ++irow ) {
+    for ( Index icol=0; icol<ncol; ++icol ) assert( tdat(icol, irow) == dat(irow, icol) );
+  }
+
+  cout << line << endl;
+  cout << myname << "Sums and medians." << endl;
+  Data::StdVector rsums = dat.rowSums();
+  Data::StdVector csums = dat.columnSums();
+  assert( rsums.size() == nrow );
+  assert( csums.size() == ncol );
+  assert( rsums[1] == 100*ncol + ncol*(ncol - 1)/2 );
+  assert( csums[2] == 100*nrow*(nrow - 1)/2 + 2*nrow );
+  Data::StdVector rmeds = dat.rowMedians();
+  Data::StdVector cmeds = dat.columnMedians();
+  assert( rmeds[2] == 234.5 );
+  assert( cmeds[4] == 1804 );
+
+  cout << line << endl;
+  cout << myname << "Padding." << endl;
+  Data pdat = dat.padded(3, 10);
+  assert( pdat.size(0) == nrow + 3 );
+  assert( pdat.size(1) == ncol + 10 );
+  assert( pdat(5, 6) == 506 );
+  assert( pdat(5, 75) == 0.0 );
+  assert( pdat(38, 6) == 0.0 );
+  assert( pdat.rowSums()[7] == rsums[7] );
+
+  cout << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main() {
+  return test_Real2dData();
+}
+
+//**********************************************************************
@@ -92,6 +92,16 @@ int test_Tpc2dRoi() {
   }
   cout << myname << "Test count: " << ntst << endl;
 
+  cout << myline << endl;
+  cout << myname << "Check channel arrays." << endl;
+  assert( roi1.channelData(icha0 - 1) == nullptr );
+  assert( roi1.channelData(icha0 + ncha) == nullptr );
+  assert( roi1.value(icha0 + ncha, isam0) == 0.0 );
+  assert( roi1.value(icha0, isam0 + nsam, -1.0) == -1.0 );
+  const float* pcha = roi1.channelData(icha0 + 3);
+  assert( pcha != nullptr );
+  assert( pcha[5] == roi1.value(icha0 + 3, isam0 + 5) );
+
   cout << myline << endl;
   cout << myname << "All tests passed." << endl;
   return 0;
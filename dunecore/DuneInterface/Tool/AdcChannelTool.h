@@ -35,6 +35,13 @@
 // The default for updateMap(acds) does the same using update(acd) unless
 // viewWithModify() is true in which case the call is forwarded to viewMap(acds).
 //
+// If threadSafeUpdate() is true, the default updateMap(acds) calls update(acd)
+// for the channels in parallel (TBB). The results are merged in channel order
+// after all channels are processed so the returned DataMap is the same as for
+// the serial loop. Tools that declare this must not modify tool state in
+// update(acd) or must protect it, and must not touch channels other than the
+// one passed.
+//
 // Implementers which handle multiple channels, e.g. correlated noise removal
 // or event display, can instead override viewMap(acds) or updateMap(acds).
 // The single-object methods view(acd) and update(acd) will return status
@@ -49,7 +56,9 @@
 #include "dunecore/DuneInterface/Data/AdcChannelData.h"
 #include "dunecore/DuneInterface/Data/DataMap.h"
 #include "dunecore/DuneInterface/Data/DuneEventInfo.h"
+#include "tbb/parallel_for.h"
 #include <set>
+#include <vector>
 
 class AdcChannelTool {
 
@@ -96,6 +105,10 @@ public:
   // In both cases, the passed dat is first copied.
   virtual bool viewWithUpdate() const { return false; }
 
+  // If this is true, update(acd) may be called concurrently for different
+  // channels and the default updateMap runs the channels in parallel.
+  virtual bool threadSafeUpdate() const { return false; }
+
   // Optional call at the start of processing an event.
   virtual DataMap beginEvent(const DuneEventInfo&) const { return DataMap(); }
 
@@ -140,15 +153,32 @@ DataMap AdcChannelTool::updateMap(AdcChannelDataMap& acds) const {
   DataMap ret;
   DataMap::IntVector failedChannels;
   std::set<int> failedCodeSet;
-  for ( AdcChannelDataMap::value_type& iacd : acds ) {
-    DataMap dm = update(iacd.second);
-    if ( dm.status() == interfaceNotImplemented() ) return DataMap(interfaceNotImplemented());
+  // Merge the result for one channel. Returns false if update is not implemented.
+  auto merge = [&](AdcChannel icha, const DataMap& dm) {
+    if ( dm.status() == interfaceNotImplemented() ) return false;
     else if ( dm.status() ) {
-      failedChannels.push_back(iacd.first);
+      failedChannels.push_back(icha);
       failedCodeSet.insert(dm.status());
       if ( ! ret.status() ) ret.setStatus(dm.status());
     }
     else ret += dm;
+    return true;
+  };
+  if ( threadSafeUpdate() && acds.size() > 1 ) {
+    std::vector<AdcChannelDataMap::value_type*> iacds;
+    iacds.reserve(acds.size());
+    for ( AdcChannelDataMap::value_type& iacd : acds ) iacds.push_back(&iacd);
+    std::vector<DataMap> dms(iacds.size());
+    tbb::parallel_for(std::size_t(0), iacds.size(), [&](std::size_t ient) {
+      dms[ient] = update(iacds[ient]->second);
+    });
+    for ( std::size_t ient=0; ient<iacds.size(); ++ient ) {
+      if ( ! merge(iacds[ient]->first, dms[ient]) ) return DataMap(interfaceNotImplemented());
+    }
+  } else {
+    for ( AdcChannelDataMap::value_type& iacd : acds ) {
+      if ( ! merge(iacd.first, update(iacd.second)) ) return DataMap(interfaceNotImplemented());
+    }
   }
   DataMap::IntVector failedCodes(failedCodeSet.begin(), failedCodeSet.end());
   ret.setIntVector("failedChannels", failedChannels);
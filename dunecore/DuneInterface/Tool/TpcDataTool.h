@@ -7,6 +7,8 @@
 //
 // It inherits from AdcChannelTool and the default implementation here
 // calls the ADC channel map methods of that class.
+// Tools that declare threadSafeUpdate() have the channels in each map
+// updated in parallel (see AdcChannelTool.h).
 
 #ifndef TpcDataTool_H
 #define TpcDataTool_H
@@ -59,6 +59,25 @@ DataMap AdcChannelTool_update::update(AdcChannelData& acd) const {
 
 //**********************************************************************
 
+// Thread-safe tool that modfies data.
+// Sets femb = 100+channel and fails for channels divisible by 3.
+
+class AdcChannelTool_threadSafe : public AdcChannelTool {
+public:
+  DataMap update(AdcChannelData& acd) const override;
+  bool threadSafeUpdate() const override { return true; }
+};
+  
+DataMap AdcChannelTool_threadSafe::update(AdcChannelData& acd) const {
+  if ( acd.channel()%3 == 0 ) return DataMap(10 + acd.channel());
+  acd.setChannelInfo(acd.channel(), 100 + acd.channel());
+  DataMap ret;
+  ret.setInt("chan", acd.channel());
+  return ret;
+}
+
+//**********************************************************************
+
 // Test with all default methods.
 
 int test_AdcChannelTool_default() {
@@ -182,9 +201,53 @@ int test_AdcChannelTool_update() {
 
 //**********************************************************************
 
+// Test with parallel update.
+
+int test_AdcChannelTool_threadSafe() {
+  const string myname = "test_AdcChannelTool_threadSafe: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+
+  cout << endl;
+  cout << myname << line << endl;
+  cout << myname << "Instantiate tool." << endl;
+  AdcChannelTool_threadSafe act;
+  Index ncha = 10;
+  AdcChannelDataMap acds = makeAdcData(ncha);
+
+  cout << myname << line << endl;
+  cout << myname << "Call updateMap." << endl;
+  DataMap ret = act.updateMap(acds);
+  ret.print();
+  assert( ret.status() == 10 );
+  DataMap::IntVector expFailedChannels = {0, 3, 6, 9};
+  DataMap::IntVector expFailedCodes = {10, 13, 16, 19};
+  assert( ret.getIntVector("failedChannels") == expFailedChannels );
+  assert( ret.getIntVector("failedCodes") == expFailedCodes );
+  // Results are merged in channel order so the last success is kept.
+  assert( ret.getInt("chan") == 8 );
+  for ( const auto& iacd : acds ) {
+    const AdcChannelData& acd = iacd.second;
+    Index icha = acd.channel();
+    assert( icha == iacd.first );
+    if ( icha%3 ) assert( acd.fembID() == 100 + icha );
+    else assert( acd.fembID() == icha%4 );
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Test complete." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
 int main(int argc, char* argv[]) {
   test_AdcChannelTool_default();
   test_AdcChannelTool_update();
+  test_AdcChannelTool_threadSafe();
   return 0;
 }
 
@@ -0,0 +1,243 @@
+// ChannelGeoTable.cxx
+
+#include "ChannelGeoTable.h"
+
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "fhiclcpp/ParameterSet.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <type_traits>
+#include <typeinfo>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::string;
+using std::ofstream;
+using std::ostringstream;
+
+static_assert(std::is_trivially_copyable<ChannelGeoTable::Point>::value,
+              "ChannelGeoTable requires trivially copyable points.");
+static_assert(std::is_trivially_copyable<ChannelGeoTable::EndPoints>::value,
+              "ChannelGeoTable requires trivially copyable endpoints.");
+static_assert(sizeof(ChannelGeoTable::Point) == 3*sizeof(double),
+              "ChannelGeoTable requires points to be three doubles.");
+
+namespace {
+
+// File layout:
+//   Header
+//   channel offsets (ncha+1 x uint32), padded to 8 bytes
+//   top points (ncha)
+//   bottom points (ncha)
+//   wire endpoints (nseg)
+const std::uint64_t tableMagic = 0x44554e4543474554;  // "DUNECGET"
+const std::uint64_t tableVersion = 2;
+const std::size_t nameSize = 128;
+
+struct Header {
+  std::uint64_t magic;
+  std::uint64_t version;
+  std::uint64_t key;
+  std::uint64_t ncha;
+  std::uint64_t nseg;
+  char detName[nameSize];
+};
+
+std::size_t offsetBytes(std::size_t ncha) {
+  std::size_t nbyte = (ncha + 1)*sizeof(std::uint32_t);
+  return 8*((nbyte + 7)/8);
+}
+
+}  // end unnamed namespace
+
+//**********************************************************************
+
+ChannelGeoTable::Key
+ChannelGeoTable::makeKey(const geo::GeometryCore* pgeo, const geo::WireReadoutGeom* wireReadout,
+                         const fhicl::ParameterSet& readoutPars) {
+  string sclass = string("ChannelGeoTable/") + typeid(*wireReadout).name();
+  return geo::GeometryKey::makeKey(pgeo, readoutPars, sclass);
+}
+
+//**********************************************************************
+
+ChannelGeoTable::Key
+ChannelGeoTable::makeKey(const geo::GeometryCore* pgeo, const geo::WireReadoutGeom* wireReadout) {
+  const fhicl::ParameterSet* ppars = geo::GeometryKey::readoutParameters(wireReadout);
+  return makeKey(pgeo, wireReadout, ppars == nullptr ? fhicl::ParameterSet() : *ppars);
+}
+
+//**********************************************************************
+
+string ChannelGeoTable::fileName(string dir, Key key) {
+  return geo::GeometryKey::fileName(dir, "ChannelGeoTable", key);
+}
+
+//**********************************************************************
+
+ChannelGeoTable::ChannelGeoTable()
+: ChannelGeoTable(&art::ServiceHandle<geo::WireReadout>()->Get(),
+                  art::ServiceHandle<geo::Geometry>()->DetectorName(),
+                  makeKey(art::ServiceHandle<geo::Geometry>().get(),
+                          &art::ServiceHandle<geo::WireReadout>()->Get())) { }
+
+//**********************************************************************
+
+ChannelGeoTable::
+ChannelGeoTable(const geo::WireReadoutGeom* wireReadout, string detectorName, Key key)
+: m_detName(detectorName), m_key(key) {
+  m_ncha = wireReadout->Nchannels();
+  // Loop over wires once to count the segments for each channel.
+  // This avoids the per-channel search in ChannelToWire.
+  IndexVector wireChannels;
+  IndexVector nsegs(m_ncha, 0);
+  std::vector<geo::PlaneID> pids;
+  for ( const geo::PlaneID& pid : wireReadout->Iterate<geo::PlaneID>() ) {
+    pids.push_back(pid);
+    for ( Index iwir=0; iwir<wireReadout->Nwires(pid); ++iwir ) {
+      Index icha = wireReadout->PlaneWireToChannel(geo::WireID(pid, iwir));
+      wireChannels.push_back(icha);
+      if ( icha < m_ncha ) ++nsegs[icha];
+    }
+  }
+  m_offsData.resize(m_ncha + 1, 0);
+  for ( Index icha=0; icha<m_ncha; ++icha ) {
+    m_offsData[icha+1] = m_offsData[icha] + nsegs[icha];
+  }
+  m_nseg = m_offsData[m_ncha];
+  // Second loop to fill the endpoints.
+  m_segsData.resize(m_nseg);
+  m_topsData.resize(m_ncha);
+  m_botsData.resize(m_ncha);
+  IndexVector iseg(m_offsData.begin(), m_offsData.end() - 1);
+  Index iwirAll = 0;
+  for ( const geo::PlaneID& pid : pids ) {
+    for ( Index iwir=0; iwir<wireReadout->Nwires(pid); ++iwir ) {
+      Index icha = wireChannels[iwirAll++];
+      if ( icha >= m_ncha ) continue;
+      EndPoints ends = wireReadout->WireEndPoints(geo::WireID(pid, iwir));
+      if ( ends.first.y() > ends.second.y() ) std::swap(ends.first, ends.second);
+      if ( iseg[icha] == m_offsData[icha] ) {
+        m_botsData[icha] = ends.first;
+        m_topsData[icha] = ends.second;
+      } else {
+        if ( ends.first.y() < m_botsData[icha].y() ) m_botsData[icha] = ends.first;
+        if ( ends.second.y() > m_topsData[icha].y() ) m_topsData[icha] = ends.second;
+      }
+      m_segsData[iseg[icha]++] = ends;
+    }
+  }
+  setPointers();
+}
+
+//**********************************************************************
+
+ChannelGeoTable::ChannelGeoTable(string detectorName, Key key)
+: m_detName(detectorName), m_key(key) { }
+
+//**********************************************************************
+
+std::unique_ptr<ChannelGeoTable>
+ChannelGeoTable::read(string fname, Key key, Index ncha) {
+  std::unique_ptr<ChannelGeoTable> ptab;
+  int fd = open(fname.c_str(), O_RDONLY);
+  if ( fd < 0 ) return ptab;
+  struct stat fst;
+  if ( fstat(fd, &fst) != 0 || std::size_t(fst.st_size) < sizeof(Header) ) {
+    close(fd);
+    return ptab;
+  }
+  std::size_t mapSize = fst.st_size;
+  void* pmap = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if ( pmap == MAP_FAILED ) return ptab;
+  const char* pbeg = static_cast<const char*>(pmap);
+  const Header* phdr = reinterpret_cast<const Header*>(pbeg);
+  string fileDetName(phdr->detName, strnlen(phdr->detName, nameSize));
+  std::size_t nbyteOff = offsetBytes(phdr->ncha);
+  std::size_t nbyteExp = sizeof(Header) + nbyteOff +
+                         2*phdr->ncha*sizeof(Point) + phdr->nseg*sizeof(EndPoints);
+  if ( phdr->magic != tableMagic || phdr->version != tableVersion ||
+       phdr->key != key ||
+       (ncha > 0 && phdr->ncha != ncha) ||
+       nbyteExp != mapSize ) {
+    munmap(pmap, mapSize);
+    return ptab;
+  }
+  ptab.reset(new ChannelGeoTable(fileDetName, key));
+  ptab->m_ncha = phdr->ncha;
+  ptab->m_nseg = phdr->nseg;
+  ptab->m_pmap = pmap;
+  ptab->m_mapSize = mapSize;
+  const char* pdat = pbeg + sizeof(Header);
+  ptab->m_offs = reinterpret_cast<const std::uint32_t*>(pdat);
+  pdat += nbyteOff;
+  ptab->m_tops = reinterpret_cast<const Point*>(pdat);
+  pdat += phdr->ncha*sizeof(Point);
+  ptab->m_bots = reinterpret_cast<const Point*>(pdat);
+  pdat += phdr->ncha*sizeof(Point);
+  ptab->m_segs = reinterpret_cast<const EndPoints*>(pdat);
+  return ptab;
+}
+
+//**********************************************************************
+
+ChannelGeoTable::~ChannelGeoTable() {
+  if ( m_pmap != nullptr ) munmap(m_pmap, m_mapSize);
+}
+
+//**********************************************************************
+
+int ChannelGeoTable::write(string fname) const {
+  if ( m_detName.size() >= nameSize ) return 1;
+  Header hdr;
+  std::memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = tableMagic;
+  hdr.version = tableVersion;
+  hdr.key = m_key;
+  hdr.ncha = m_ncha;
+  hdr.nseg = m_nseg;
+  std::memcpy(hdr.detName, m_detName.data(), m_detName.size());
+  // Write to a temporary file and rename so readers never see a partial file.
+  ostringstream sstmp;
+  sstmp << fname << ".tmp" << getpid();
+  string ftmp = sstmp.str();
+  {
+    ofstream fout(ftmp, std::ios::binary | std::ios::trunc);
+    if ( ! fout ) return 2;
+    fout.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+    std::vector<char> offBuf(offsetBytes(m_ncha), 0);
+    std::memcpy(offBuf.data(), m_offs, (m_ncha + 1)*sizeof(std::uint32_t));
+    fout.write(offBuf.data(), offBuf.size());
+    fout.write(reinterpret_cast<const char*>(m_tops), m_ncha*sizeof(Point));
+    fout.write(reinterpret_cast<const char*>(m_bots), m_ncha*sizeof(Point));
+    fout.write(reinterpret_cast<const char*>(m_segs), m_nseg*sizeof(EndPoints));
+    if ( ! fout ) {
+      std::remove(ftmp.c_str());
+      return 3;
+    }
+  }
+  if ( std::rename(ftmp.c_str(), fname.c_str()) ) {
+    std::remove(ftmp.c_str());
+    return 4;
+  }
+  return 0;
+}
+
+//**********************************************************************
+
+void ChannelGeoTable::setPointers() {
+  m_offs = m_offsData.data();
+  m_tops = m_topsData.data();
+  m_bots = m_botsData.data();
+  m_segs = m_segsData.data();
+}
+
+//**********************************************************************
@@ -0,0 +1,135 @@
+// ChannelGeoTable.h
+//
+// Wire endpoints and top/bottom points for all channels in a geometry.
+//
+// This holds the same information as ChannelGeo but is built once for the
+// full detector and stored in contiguous arrays. The segments for channel
+// icha are wires(icha)[iwir] for iwir < nWires(icha).
+//
+// The table may be written to a file and later read back. The file is memory
+// mapped so reading is fast and the data are shared between processes on the
+// same node. The file is identified by a key (see GeometryKey) built from the
+// GDML content, detector name, readout class and readout configuration and
+// read fails if the key or channel count does not match the expected value:
+//
+//   Key key = ChannelGeoTable::makeKey(pgeo, wireReadout);
+//   string fname = ChannelGeoTable::fileName(dir, key);
+//   std::unique_ptr<ChannelGeoTable> ptab = ChannelGeoTable::read(fname, key);
+//   if ( ! ptab ) {
+//     ptab.reset(new ChannelGeoTable(wireReadout, pgeo->DetectorName(), key));
+//     ptab->write(fname);
+//   }
+
+#ifndef ChannelGeoTable_H
+#define ChannelGeoTable_H
+
+#include "dunecore/Geometry/ChannelGeo.h"
+#include "dunecore/Geometry/GeometryKey.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class ChannelGeoTable {
+
+public:
+
+  using Index = ChannelGeo::Index;
+  using Point = ChannelGeo::Point;
+  using EndPoints = ChannelGeo::EndPoints;
+  using IndexVector = std::vector<std::uint32_t>;
+  using PointVector = std::vector<Point>;
+  using EndPointsVector = ChannelGeo::EndPointsVector;
+  using Key = geo::GeometryKey::Key;
+
+  // Return the key for a geometry, wire readout and readout configuration.
+  static Key makeKey(const geo::GeometryCore* pgeo, const geo::WireReadoutGeom* wireReadout,
+                     const fhicl::ParameterSet& readoutPars);
+
+  // Return the key using the configuration recorded for the readout by the
+  // readout service (see GeometryKey::readoutParameters) or an empty
+  // configuration if none was recorded.
+  static Key makeKey(const geo::GeometryCore* pgeo, const geo::WireReadoutGeom* wireReadout);
+
+  // Return the table file name for a directory and key.
+  static std::string fileName(std::string dir, Key key);
+
+  // Ctor from geometry and the key to record when the table is written.
+  ChannelGeoTable(const geo::WireReadoutGeom* wireReadout, std::string detectorName, Key key =0);
+
+  // Ctor using the current geometry service. The key is evaluated.
+  ChannelGeoTable();
+
+  // Read a table from a file.
+  // Returns null if the file cannot be read or does not match the
+  // key and channel count (if nonzero).
+  static std::unique_ptr<ChannelGeoTable>
+  read(std::string fname, Key key, Index ncha =0);
+
+  // Dtor. Unmaps the file if needed.
+  ~ChannelGeoTable();
+
+  ChannelGeoTable(const ChannelGeoTable&) =delete;
+  ChannelGeoTable& operator=(const ChannelGeoTable&) =delete;
+
+  // Write the table to a file.
+  // Returns 0 for success.
+  int write(std::string fname) const;
+
+  // Return the detector name and geometry key.
+  const std::string& detectorName() const { return m_detName; }
+  Key key() const { return m_key; }
+
+  // Return the number of channels.
+  Index size() const { return m_ncha; }
+
+  // Return if a channel is in the table.
+  bool isValid(Index icha) const { return icha < m_ncha; }
+
+  // Return if the table is memory mapped from a file.
+  bool isMapped() const { return m_pmap != nullptr; }
+
+  // Return the number of wires (wire segments) for a channel.
+  Index nWires(Index icha) const { return m_offs[icha+1] - m_offs[icha]; }
+
+  // Return the wire endpoints for a channel.
+  // The lower point (in y) is first.
+  const EndPoints* wires(Index icha) const { return m_segs + m_offs[icha]; }
+
+  // Return the top or bottom endpoint for a channel.
+  const Point& top(Index icha) const { return m_tops[icha]; }
+  const Point& bottom(Index icha) const { return m_bots[icha]; }
+
+private:
+
+  // Ctor for read.
+  ChannelGeoTable(std::string detectorName, Key key);
+
+  // Set the data pointers to the owned vectors.
+  void setPointers();
+
+  std::string m_detName;
+  Key m_key =0;
+  Index m_ncha =0;
+  Index m_nseg =0;
+
+  // Owned data. These are empty if the data are mapped.
+  IndexVector m_offsData;
+  PointVector m_topsData;
+  PointVector m_botsData;
+  EndPointsVector m_segsData;
+
+  // Mapped file.
+  void* m_pmap =nullptr;
+  std::size_t m_mapSize =0;
+
+  // Data.
+  const std::uint32_t* m_offs =nullptr;
+  const Point* m_tops =nullptr;
+  const Point* m_bots =nullptr;
+  const EndPoints* m_segs =nullptr;
+
+};
+
+#endif
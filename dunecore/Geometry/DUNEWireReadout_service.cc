@@ -22,6 +22,7 @@
 #include "dunecore/Geometry/WireReadoutSorterAPA.h"
 #include "dunecore/Geometry/WireReadoutSorter35.h"
 #include "dunecore/Geometry/WireReadoutSorterICEBERG.h"
+#include "dunecore/Geometry/GeometryKey.h"
 
 // LArSoft libraries
 #include "larcore/Geometry/Geometry.h"
@@ -194,6 +195,9 @@ dune::DUNEWireReadout::DUNEWireReadout(fhicl::ParameterSet const& pset)
     // Create channel map and set sorter.
     fWireReadout = std::make_unique<geo::DuneApaWireReadoutGeom>(pset, geom, std::move(psort));
   }
+
+  // Record the configuration for tables keyed on this readout.
+  geo::GeometryKey::setReadoutParameters(fWireReadout.get(), pset);
 }
 
 //**********************************************************************
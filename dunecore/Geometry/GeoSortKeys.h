@@ -0,0 +1,51 @@
+#ifndef GEO_GEOSORTKEYS_H
+#define GEO_GEOSORTKEYS_H
+
+// Decorate-sort for the DUNE geometry sorters that own their sort.
+//
+// sortByKey evaluates the key for each element of a range once, sorts the
+// keys and then applies the resulting permutation. It is used where the sort
+// key is expensive to evaluate, e.g. the ProtoDUNE-SP CRT spiral sort.
+// The sorts made by the larcorealg GeoObjectSorter and WireReadoutSorter base
+// classes call the DUNE comparators directly and cannot use it.
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace geo {
+
+  // Sort [begin, end) by key. keyOf(element) returns the key and
+  // less(key1, key2) orders the keys.
+  template <class ITERATOR, class KEYFUN, class KEYLESS>
+  void sortByKey(ITERATOR begin, ITERATOR end, KEYFUN keyOf, KEYLESS less)
+  {
+    using Value = typename std::iterator_traits<ITERATOR>::value_type;
+    using Key = std::decay_t<decltype(keyOf(*begin))>;
+    using KeyIndex = std::pair<Key, std::size_t>;
+    std::size_t const n = std::distance(begin, end);
+    if ( n < 2 ) return;
+    std::vector<KeyIndex> keys;
+    keys.reserve(n);
+    std::size_t i = 0;
+    for ( ITERATOR it=begin; it!=end; ++it ) keys.emplace_back(keyOf(*it), i++);
+    std::sort(keys.begin(), keys.end(),
+              [&less](KeyIndex const& lhs, KeyIndex const& rhs) { return less(lhs.first, rhs.first); });
+    std::vector<Value> sorted;
+    sorted.reserve(n);
+    for ( KeyIndex const& ki : keys ) sorted.push_back(std::move(*std::next(begin, ki.second)));
+    std::move(sorted.begin(), sorted.end(), begin);
+  }
+
+  // Sort a vector by key.
+  template <class T, class KEYFUN, class KEYLESS>
+  void sortByKey(std::vector<T>& objs, KEYFUN keyOf, KEYLESS less)
+  {
+    sortByKey(objs.begin(), objs.end(), keyOf, less);
+  }
+
+}
+
+#endif // GEO_GEOSORTKEYS_H
@@ -0,0 +1,98 @@
+// GeometryKey.cxx
+
+#include "GeometryKey.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "cetlib_except/exception.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+
+using std::string;
+using std::ifstream;
+using std::ostringstream;
+using geo::GeometryKey;
+
+namespace {
+
+// 64-bit FNV-1a hash.
+class Fnv1a {
+public:
+  void add(const char* pch, std::size_t nch) {
+    for ( std::size_t ich=0; ich<nch; ++ich ) {
+      m_val ^= static_cast<unsigned char>(pch[ich]);
+      m_val *= 0x100000001b3;
+    }
+  }
+  void add(const string& str) { add(str.data(), str.size()); }
+  std::uint64_t value() const { return m_val; }
+private:
+  std::uint64_t m_val = 0xcbf29ce484222325;
+};
+
+// Configuration recorded for each readout object.
+// Entries are never removed so the returned pointers stay valid.
+std::mutex& readoutParsMutex() {
+  static std::mutex mtx;
+  return mtx;
+}
+
+std::map<const geo::WireReadoutGeom*, std::unique_ptr<fhicl::ParameterSet>>& readoutParsMap() {
+  static std::map<const geo::WireReadoutGeom*, std::unique_ptr<fhicl::ParameterSet>> pars;
+  return pars;
+}
+
+}  // end unnamed namespace
+
+//**********************************************************************
+
+GeometryKey::Key
+GeometryKey::makeKey(const GeometryCore* pgeo,
+                     const fhicl::ParameterSet& pset,
+                     string sclass) {
+  Fnv1a hash;
+  hash.add(sclass);
+  hash.add(pgeo->DetectorName());
+  string gdmlFile = pgeo->GDMLFile();
+  ifstream fin(gdmlFile, std::ios::binary);
+  if ( ! fin ) {
+    throw cet::exception("GeometryKey") << "Unable to open GDML file " << gdmlFile;
+  }
+  char buf[65536];
+  while ( fin.read(buf, sizeof(buf)) || fin.gcount() ) hash.add(buf, fin.gcount());
+  hash.add(pset.to_string());
+  return hash.value();
+}
+
+//**********************************************************************
+
+string GeometryKey::fileName(string dir, string sclass, Key key) {
+  ostringstream ssout;
+  if ( dir.size() ) ssout << dir << "/";
+  ssout << sclass << "_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+  return ssout.str();
+}
+
+//**********************************************************************
+
+void GeometryKey::
+setReadoutParameters(const WireReadoutGeom* prdo, const fhicl::ParameterSet& pset) {
+  std::lock_guard<std::mutex> lock(readoutParsMutex());
+  std::unique_ptr<fhicl::ParameterSet>& ppars = readoutParsMap()[prdo];
+  if ( ppars ) *ppars = pset;
+  else ppars = std::make_unique<fhicl::ParameterSet>(pset);
+}
+
+//**********************************************************************
+
+const fhicl::ParameterSet* GeometryKey::readoutParameters(const WireReadoutGeom* prdo) {
+  std::lock_guard<std::mutex> lock(readoutParsMutex());
+  auto ipars = readoutParsMap().find(prdo);
+  return ipars == readoutParsMap().end() ? nullptr : ipars->second.get();
+}
+
+//**********************************************************************
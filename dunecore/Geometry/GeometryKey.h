@@ -0,0 +1,52 @@
+// GeometryKey.h
+//
+// Key identifying a geometry and readout configuration for files holding
+// tables derived from the geometry, e.g. ChannelGeoTable.
+//
+// The key is a 64-bit hash of the content of the GDML file, the detector
+// name, a class name identifying the table and the readout configuration.
+// A file is used only if its key matches that of the current job:
+//
+//   Key key = GeometryKey::makeKey(pgeo, readoutPars, "MyTable");
+//   string fname = GeometryKey::fileName(dir, "MyTable", key);
+//
+// The readout service records its configuration for the readout object it
+// creates (setReadoutParameters) so that tables derived from a readout can
+// be keyed on it without access to the service configuration.
+
+#ifndef GeometryKey_H
+#define GeometryKey_H
+
+#include "larcorealg/Geometry/fwd.h"
+#include "fhiclcpp/fwd.h"
+
+#include <string>
+#include <cstdint>
+
+namespace geo {
+
+class GeometryKey {
+
+public:
+
+  using Key = std::uint64_t;
+
+  // Return the key for a geometry and readout configuration.
+  // The class name is included so different tables never share a file.
+  static Key makeKey(const GeometryCore* pgeo,
+                     const fhicl::ParameterSet& pset,
+                     std::string sclass);
+
+  // Return the file name for a directory, class name and key.
+  static std::string fileName(std::string dir, std::string sclass, Key key);
+
+  // Record the configuration for a readout object and fetch it.
+  // Fetch returns null if nothing was recorded for the readout.
+  static void setReadoutParameters(const WireReadoutGeom* prdo, const fhicl::ParameterSet& pset);
+  static const fhicl::ParameterSet* readoutParameters(const WireReadoutGeom* prdo);
+
+};
+
+}  // end namespace geo
+
+#endif
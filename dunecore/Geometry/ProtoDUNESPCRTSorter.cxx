@@ -11,6 +11,7 @@
 //#include "larcoreobj/SimpleTypesAndConstants/geo_vectors_utils.h" 
 
 #include "dunecore/Geometry/ProtoDUNESPCRTSorter.h"
+#include "dunecore/Geometry/GeoSortKeys.h"
                         
 
 //c++ includes                                                                                                                 
@@ -64,33 +65,28 @@ namespace
     //If this is really a bottleneck, one could probably write some                                         
     //multi-return-statement version that's more efficient.                                                                    
   
-    std::sort(begin, end, [&center](const geo::AuxDetGeo* first,const geo::AuxDetGeo* second)
+    //The readout edge and angle are evaluated once per panel and the panels
+    //are then sorted on those keys.
+    struct SpiralKey { double phi; bool upstream; };
+    auto keyOf = [&center](const geo::AuxDetGeo* det)
               {
-                //Find the readout edge of each CRT                                                                            
-		geo::Vector_t firstEdge = FindEdge(*first,center);
-		geo::Vector_t secondEdge = FindEdge(*second,center);
+                //Find the readout edge of the CRT and the vector from the center to it
+                geo::Vector_t edgeVec = FindEdge(*det,center)-center;
 
-                //Calculate the vector from the center to each edge                                                            
-		geo::Vector_t firstVec = firstEdge-center;
-		geo::Vector_t secondVec = secondEdge-center;
+                //Calculate the angle Phi (Angle in X-Y Plane)
+                double phi = edgeVec.Phi();
 
-                //Calculate the angle Phi (Angle in X-Y Plane)                                                                 
-                double firstPhi = firstVec.Phi();
-                double secondPhi = secondVec.Phi();
-
-
-                //We want to start at verticle (pi) and go in a spiral from there                                                              //so this means pushing the angles of >pi to the end of the array                                              
-                //by subtracting 2*pi                                                                                          
-                                                                                                              
-                if (firstPhi>1.57) firstPhi-=6.28;
-                if (secondPhi>1.57) secondPhi-=6.28;
-
-		if ((*first).GetCenter().Z() <0.0){
-		  return firstPhi > secondPhi;
-		} else {
-                  return firstPhi < secondPhi;
-		}
+                //We want to start at verticle (pi) and go in a spiral from there
+                //so this means pushing the angles of >pi to the end of the array
+                //by subtracting 2*pi
+                if (phi>1.57) phi-=6.28;
 
+                return SpiralKey{phi, det->GetCenter().Z() < 0.0};
+              };
+    geo::sortByKey(begin, end, keyOf, [](const SpiralKey& first, const SpiralKey& second)
+              {
+                if (first.upstream) return first.phi > second.phi;
+                return first.phi < second.phi;
               });
 
     // loop through the sorted vector and print out to check it is working as intended                                                                                                                                    
@@ -17,9 +17,36 @@
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <limits>
+
 geo::WireReadoutSorter35::WireReadoutSorter35(fhicl::ParameterSet const& p)
   : fDetVersion(p.get< std::string >("DetectorVersion", "dune35t4apa"))
-{}
+  , fHasSplitRegion(true)
+  , fSplitZMin(0.0)
+  , fSplitZMax(std::numeric_limits<double>::infinity())
+{
+  ///////////////////////////////////////////////////////////
+  // Hard code a number to tell sorting when to look
+  // for top/bottom APAs and when to look for only one
+  if(fDetVersion=="dune35t") {                        // the old
+    fSplitZMin = 76.35;
+  } else if(fDetVersion=="dune35t4apa") {             // the new...
+    fSplitZMin = 51;
+    fSplitZMax = 102;
+  } else if(fDetVersion=="dune35t4apa_v2") {          // ...and improved
+    fSplitZMin = 52.74;
+    fSplitZMax = 106.23;
+  } else if(fDetVersion=="dune35t4apa_v3"
+            || fDetVersion=="dune35t4apa_v4"
+            || fDetVersion=="dune35t4apa_v5"
+            || fDetVersion=="dune35t4apa_v6") {
+    fSplitZMin = 51.41045;
+    fSplitZMax = 103.33445;
+  } else {
+    fHasSplitRegion = false;
+  }
+  ///////////////////////////////////////////////////////////
+}
 
 bool geo::WireReadoutSorter35::compareWires(WireGeo const& w1, WireGeo const& w2) const
 {
@@ -35,22 +62,7 @@ bool geo::WireReadoutSorter35::compareWires(WireGeo const& w1, WireGeo const& w2
   // vertical wires should always have same y, and always increase in z direction
   if( xyz1.Y()==xyz2.Y() && xyz1.Z()<xyz2.Z() ) return true;
 
-  ///////////////////////////////////////////////////////////
-  // Hard code a number to tell sorting when to look
-  // for top/bottom APAs and when to look for only one
-  bool InVertSplitRegion = false;
-  if(fDetVersion=="dune35t")             InVertSplitRegion = xyz1.Z() > 76.35;      // the old
-  else if(fDetVersion=="dune35t4apa")    InVertSplitRegion = ((51 < xyz1.Z())       // the new...
-                                                              && (xyz1.Z() < 102)); //
-  else if(fDetVersion=="dune35t4apa_v2") InVertSplitRegion = ((52.74 < xyz1.Z())    // ...and improved
-                                                              && (xyz1.Z() < 106.23));
-  else if(fDetVersion=="dune35t4apa_v3"
-          || fDetVersion=="dune35t4apa_v4"
-          || fDetVersion=="dune35t4apa_v5"
-          || fDetVersion=="dune35t4apa_v6"
-          ) InVertSplitRegion = ((51.41045 < xyz1.Z())
-                                 && (xyz1.Z() < 103.33445));
-  ///////////////////////////////////////////////////////////
+  bool InVertSplitRegion = fHasSplitRegion && fSplitZMin < xyz1.Z() && xyz1.Z() < fSplitZMax;
 
   // we want the wires to be sorted such that the smallest corner wire
   // on the readout end of a plane is wire zero, with wire number
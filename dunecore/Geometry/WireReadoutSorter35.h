@@ -28,6 +28,12 @@ namespace geo {
     bool compareWires(WireGeo const& w1, WireGeo const& w2) const override;
 
     std::string fDetVersion;
+
+    // Range in z where the APAs are split vertically, evaluated once from
+    // the detector version rather than in each comparison.
+    bool fHasSplitRegion;
+    double fSplitZMin;
+    double fSplitZMax;
   };
 
 } // namespace
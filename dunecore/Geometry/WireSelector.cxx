@@ -9,6 +9,8 @@
 
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <numeric>
 
 using std::string;
 using std::cout;
@@ -119,6 +121,9 @@ const WireSelector::WireInfoVector& WireSelector::fillData() {
   const string myname = "WireSelector::fillData: ";
   const double piOver2 = 0.5*acos(-1.0);
   if ( haveData() ) return m_data;
+  Index nwirAll = 0;
+  for ( geo::PlaneID pid : planeIDs() ) nwirAll += m_wireReadout->Nwires(pid);
+  m_data.reserve(nwirAll);
   for ( geo::PlaneID pid : planeIDs() ) {
     auto const& tpcid = pid;
     const geo::PlaneGeo& gpla = m_wireReadout->Plane(pid);
@@ -127,22 +132,33 @@ const WireSelector::WireInfoVector& WireSelector::fillData() {
     double xLastPlane = gplaLast.MiddleWire().GetCenter().x();
     double xThisPlane = gpla.MiddleWire().GetCenter().x();
     double driftOffset = fabs(xThisPlane - xLastPlane);
+    // The rotation, drift and pitch are the same for all wires in the plane.
+    double driftSign = gpla.GetNormalDirection().x();
+    if ( fabs(fabs(driftSign) - 1.0) > 0.001 ) {
+      cout << myname << "ERROR: Plane normal is not along x." << endl;
+      continue;
+    }
+    double rotAngle = gpla.ThetaZ() - piOver2;
+    ROOT::Math::RotationX const rot{rotAngle};
+    double driftDist = m_pgeo->TPC(tpcid).DriftDistance() - driftOffset;
+    double pitch = gpla.WirePitch();
+    PlaneIndex pin;
+    pin.pid = pid;
+    pin.rotAngle = rotAngle;
+    pin.halfPitch = 0.5*pitch;
+    pin.begin = m_data.size();
     for ( Index iwir=0; iwir<gpla.Nwires(); ++iwir ) {
       geo::WireID wid(pid, iwir);
-      const geo::WireGeo* pgwir = gpla.WirePtr(wid);
-      auto const xyzWire = ROOT::Math::RotationX{gpla.ThetaZ() - piOver2}(pgwir->GetCenter());
-      double driftSign = gpla.GetNormalDirection().x();
-      if ( fabs(fabs(driftSign) - 1.0) > 0.001 ) {
-        cout << myname << "ERROR: Plane normal is not along x." << endl;
-        continue;
-      }
-      double driftDist = m_pgeo->TPC(tpcid).DriftDistance() - driftOffset;
+      const geo::WireGeo& gwir = gpla.Wire(iwir);
+      auto const xyzWire = rot(gwir.GetCenter());
       m_data.emplace_back(xyzWire.x(), xyzWire.y(), xyzWire.z(),
                           driftSign*driftDist,
-                          pgwir->Length(),
-                          gpla.WirePitch(),
+                          gwir.Length(),
+                          pitch,
                           m_wireReadout->PlaneWireToChannel(wid));
     }
+    pin.end = m_data.size();
+    m_wireIndex.planes.push_back(pin);
   }
   m_haveData = true;
   return m_data;
@@ -160,6 +176,31 @@ const WireSelector::WireInfoMap& WireSelector::fillDataMap() {
 
 //**********************************************************************
 
+const WireSelector::WireInfoPtrVector& WireSelector::fillChannelIndex() {
+  if ( haveData() && m_chaIndex.size() == m_data.size() ) return m_chaIndex;
+  const WireInfoVector& dats = fillData();
+  m_chaIndex.clear();
+  m_chaIndex.reserve(dats.size());
+  for ( const WireInfo& dat : dats ) m_chaIndex.push_back(&dat);
+  // Stable sort keeps the wires for each channel in data order as for the multimap.
+  std::stable_sort(m_chaIndex.begin(), m_chaIndex.end(),
+                   [](const WireInfo* lhs, const WireInfo* rhs) { return lhs->channel < rhs->channel; });
+  return m_chaIndex;
+}
+
+//**********************************************************************
+
+WireSelector::ChannelRange WireSelector::channelWires(Index icha) {
+  const WireInfoPtrVector& pdats = fillChannelIndex();
+  auto ient1 = std::lower_bound(pdats.begin(), pdats.end(), icha,
+                                [](const WireInfo* pdat, Index ich) { return pdat->channel < ich; });
+  auto ient2 = ient1;
+  while ( ient2 != pdats.end() && (*ient2)->channel == icha ) ++ient2;
+  return ChannelRange(ient1, ient2);
+}
+
+//**********************************************************************
+
 const WireSelector::WireSummary& WireSelector::fillWireSummary() {
   if ( haveData() && m_wireSummary.size() == m_data.size() ) return m_wireSummary;
   WireSummary& ws = m_wireSummary;
@@ -190,10 +231,153 @@ const WireSelector::WireSummary& WireSelector::fillWireSummary() {
 
 //**********************************************************************
 
+const WireSelector::WireIndex& WireSelector::fillWireIndex() {
+  if ( haveData() && m_wireIndex.size() == m_data.size() ) return m_wireIndex;
+  const WireInfoVector& dats = fillData();
+  WireIndex& win = m_wireIndex;
+  win.zWire.resize(dats.size());
+  win.iWire.resize(dats.size());
+  for ( const PlaneIndex& pin : win.planes ) {
+    auto ibeg = win.iWire.begin() + pin.begin;
+    auto iend = win.iWire.begin() + pin.end;
+    std::iota(ibeg, iend, pin.begin);
+    std::sort(ibeg, iend, [&dats](Index lhs, Index rhs) { return dats[lhs].z < dats[rhs].z; });
+    for ( Index iidx=pin.begin; iidx<pin.end; ++iidx ) {
+      win.zWire[iidx] = dats[win.iWire[iidx]].z;
+    }
+  }
+  return win;
+}
+
+//**********************************************************************
+
+WireSelector::IndexVector
+WireSelector::wiresInBox(const Point& pmin, const Point& pmax) {
+  IndexVector iwirs;
+  const WireIndex& win = fillWireIndex();
+  double xmin = std::min(pmin.x(), pmax.x());
+  double xmax = std::max(pmin.x(), pmax.x());
+  for ( const PlaneIndex& pin : win.planes ) {
+    // Corners of the box in the y-z plane, in order around the perimeter,
+    // transformed to the wire frame.
+    ROOT::Math::RotationX const rot{pin.rotAngle};
+    Point cors[4] = {
+      rot(Point(0.0, pmin.y(), pmin.z())),
+      rot(Point(0.0, pmax.y(), pmin.z())),
+      rot(Point(0.0, pmax.y(), pmax.z())),
+      rot(Point(0.0, pmin.y(), pmax.z()))
+    };
+    double zmin = cors[0].z();
+    double zmax = zmin;
+    for ( const Point& cor : cors ) {
+      zmin = std::min(zmin, cor.z());
+      zmax = std::max(zmax, cor.z());
+    }
+    auto izbeg = win.zWire.begin() + pin.begin;
+    auto izend = win.zWire.begin() + pin.end;
+    auto iz1 = std::lower_bound(izbeg, izend, zmin - pin.halfPitch);
+    auto iz2 = std::upper_bound(iz1, izend, zmax + pin.halfPitch);
+    for ( auto iz=iz1; iz!=iz2; ++iz ) {
+      Index iwir = win.iWire[iz - win.zWire.begin()];
+      const WireInfo& dat = m_data[iwir];
+      if ( dat.x2() < xmin || dat.x1() > xmax ) continue;
+      // Find the y-range of the box in the slab z1 < z < z2 of this wire.
+      // This is the range of the corners inside the slab and of the
+      // crossings of the edges with the slab boundaries.
+      double za = dat.z1();
+      double zb = dat.z2();
+      double ymin = 1.e20;
+      double ymax = -1.e20;
+      for ( Index icor=0; icor<4; ++icor ) {
+        const Point& c1 = cors[icor];
+        const Point& c2 = cors[(icor + 1)%4];
+        if ( c1.z() >= za && c1.z() <= zb ) {
+          ymin = std::min(ymin, c1.y());
+          ymax = std::max(ymax, c1.y());
+        }
+        double dz = c2.z() - c1.z();
+        if ( dz == 0.0 ) continue;
+        for ( double zval : {za, zb} ) {
+          double t = (zval - c1.z())/dz;
+          if ( t < 0.0 || t > 1.0 ) continue;
+          double yval = c1.y() + t*(c2.y() - c1.y());
+          ymin = std::min(ymin, yval);
+          ymax = std::max(ymax, yval);
+        }
+      }
+      if ( ymax < dat.y1() || ymin > dat.y2() ) continue;
+      iwirs.push_back(iwir);
+    }
+  }
+  return iwirs;
+}
+
+//**********************************************************************
+
+WireSelector::IndexVector
+WireSelector::wiresCrossingSegment(const Point& p1, const Point& p2) {
+  IndexVector iwirs;
+  const WireIndex& win = fillWireIndex();
+  for ( const PlaneIndex& pin : win.planes ) {
+    ROOT::Math::RotationX const rot{pin.rotAngle};
+    Point q1 = rot(p1);
+    Point q2 = rot(p2);
+    double dz = q2.z() - q1.z();
+    double zmin = std::min(q1.z(), q2.z());
+    double zmax = std::max(q1.z(), q2.z());
+    auto izbeg = win.zWire.begin() + pin.begin;
+    auto izend = win.zWire.begin() + pin.end;
+    auto iz1 = std::lower_bound(izbeg, izend, zmin - pin.halfPitch);
+    auto iz2 = std::upper_bound(iz1, izend, zmax + pin.halfPitch);
+    for ( auto iz=iz1; iz!=iz2; ++iz ) {
+      Index iwir = win.iWire[iz - win.zWire.begin()];
+      const WireInfo& dat = m_data[iwir];
+      // Find the part of the segment in the z-range of this wire.
+      double t1 = 0.0;
+      double t2 = 1.0;
+      if ( dz != 0.0 ) {
+        t1 = (dat.z1() - q1.z())/dz;
+        t2 = (dat.z2() - q1.z())/dz;
+        if ( t1 > t2 ) std::swap(t1, t2);
+        t1 = std::max(t1, 0.0);
+        t2 = std::min(t2, 1.0);
+        if ( t1 > t2 ) continue;
+      } else if ( q1.z() < dat.z1() || q1.z() > dat.z2() ) {
+        continue;
+      }
+      // Clip that part to the y and then the x range of the drift volume.
+      bool cross = true;
+      for ( Index icrd : {1, 0} ) {
+        double c1 = icrd ? q1.y() : q1.x();
+        double dc = (icrd ? q2.y() : q2.x()) - c1;
+        double cmin = icrd ? dat.y1() : dat.x1();
+        double cmax = icrd ? dat.y2() : dat.x2();
+        if ( dc == 0.0 ) {
+          if ( c1 < cmin || c1 > cmax ) cross = false;
+        } else {
+          double ta = (cmin - c1)/dc;
+          double tb = (cmax - c1)/dc;
+          if ( ta > tb ) std::swap(ta, tb);
+          t1 = std::max(t1, ta);
+          t2 = std::min(t2, tb);
+          if ( t1 > t2 ) cross = false;
+        }
+        if ( ! cross ) break;
+      }
+      if ( cross ) iwirs.push_back(iwir);
+    }
+  }
+  return iwirs;
+}
+
+//**********************************************************************
+
 void WireSelector::clearData() {
   m_data.clear();
   m_datamap.clear();
+  m_chaIndex.clear();
   m_wireSummary.clear();
+  m_wireIndex.clear();
   m_haveData = false;
 }
 
@@ -11,17 +11,27 @@
 // to construct the vector of wires.
 //
 // To fetch all the wires for a channel with selelector sel:
-//   auto rng = sel.dataMap().equal_range(icha);
-//   for ( auto ient=rng.first; ient!=rng.secon; ++ient) {
-//     const WireSelector::WireInfo& win = *(ient->second);
+//   auto rng = sel.channelWires(icha);
+//   for ( auto ient=rng.first; ient!=rng.second; ++ient) {
+//     const WireSelector::WireInfo& win = **ient;
+//
+// The older multimap interface dataMap() is retained but the channel-sorted
+// array returned by fillChannelIndex() is faster to build and search.
+//
+// Call fillWireIndex() to build the spatial index. For each selected plane,
+// the wires are held in a contiguous block sorted by the measured coordinate
+// z so that wires crossing a box or a track segment can be found with a
+// binary search in each plane rather than a scan over all wires.
 
 #ifndef WireSelector_H
 #define WireSelector_H
 
 #include "larcorealg/Geometry/fwd.h"
 #include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
 #include <vector>
 #include <map>
+#include <utility>
 
 class WireSelector {
 
@@ -94,6 +104,35 @@ public:
 
   using WireInfoVector = std::vector<WireInfo>;
   using WireInfoMap = std::multimap<Index, const WireInfo*>;
+  using WireInfoPtrVector = std::vector<const WireInfo*>;
+  using ChannelRange = std::pair<WireInfoPtrVector::const_iterator, WireInfoPtrVector::const_iterator>;
+  using Point = geo::Point_t;
+
+  // Spatial index for the wires in one plane.
+  // Wires are entries [begin, end) in the index arrays.
+  struct PlaneIndex {
+    PlaneID pid;
+    double rotAngle =0.0;   // Rotation about x from global to the wire frame.
+    float halfPitch =0.0;
+    Index begin =0;
+    Index end =0;
+  };
+
+  // Spatial index for all the selected wires.
+  // zWire holds the wire coordinate z (sorted in each plane) and iWire the
+  // corresponding index in data().
+  class WireIndex {
+  public:
+    std::vector<PlaneIndex> planes;
+    std::vector<float> zWire;
+    IndexVector iWire;
+    Index size() const { return iWire.size(); }
+    void clear() {
+      planes.clear();
+      zWire.clear();
+      iWire.clear();
+    }
+  };
 
   // Ctor from a cryostat.
   explicit WireSelector(Index icry =0);
@@ -125,7 +164,9 @@ public:
   bool haveData() const { return m_haveData; };
   const WireInfoVector& data() const { return m_data; }
   const WireInfoMap& dataMap() const { return m_datamap; }
+  const WireInfoPtrVector& channelIndex() const { return m_chaIndex; }
   const WireSummary& wireSummary() const { return m_wireSummary; }
+  const WireIndex& wireIndex() const { return m_wireIndex; }
 
   // Non-const methods.
 
@@ -164,9 +205,28 @@ public:
   // Returns the channel-mapped wire data after building it if it is not already present.
   const WireInfoMap& fillDataMap();
 
+  // Returns the wires sorted by channel after building if needed.
+  const WireInfoPtrVector& fillChannelIndex();
+
+  // Returns the range of wires for a channel, building the channel index if needed.
+  ChannelRange channelWires(Index icha);
+
   // Returns the wire summary data after building if needed.
   const WireSummary& fillWireSummary();
 
+  // Returns the spatial index after building if needed.
+  const WireIndex& fillWireIndex();
+
+  // Return the indices in data() of the wires whose drift volume crosses an
+  // axis-aligned box in global coordinates.
+  // Here and below, the wire drift volume is the region [x1, x2] x [y1, y2] x [z1, z2]
+  // in the wire frame, i.e. it has the width of the wire pitch.
+  IndexVector wiresInBox(const Point& pmin, const Point& pmax);
+
+  // Return the indices in data() of the wires whose drift volume is crossed
+  // by a segment (e.g. a track) in global coordinates.
+  IndexVector wiresCrossingSegment(const Point& p1, const Point& p2);
+
   // Clear the wire data.
   void clearData();
 
@@ -185,7 +245,9 @@ private:
   bool m_haveData =false;
   WireInfoVector m_data;
   WireInfoMap m_datamap;
+  WireInfoPtrVector m_chaIndex;
   WireSummary m_wireSummary;
+  WireIndex m_wireIndex;
 
 };
 
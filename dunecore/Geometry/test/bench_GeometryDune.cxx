@@ -0,0 +1,189 @@
+// bench_GeometryDune.cxx
+
+// Time the channel-mapping queries of the DUNE wire readout geometries.
+//
+// Usage: bench_GeometryDune [gname] [rname] [nrep] [ofname]
+//   gname: Geometry configuration, e.g. dune10kt_1x2x6_geo
+//   rname: Wire readout configuration, e.g. dune_wire_readout
+//   nrep: Number of passes over all channels (or wires) for each query
+//   ofname: If not blank, the results are appended to this file
+//
+// Each query is timed over all channels or wires and the result is
+// reported as one JSON object per line:
+//   {"geometry": "...", "query": "...", "ncall": N, "ns_per_call": T}
+// so the output of many runs may be collected and compared.
+//
+// The service helper can be loaded only once per process so each job
+// benchmarks a single geometry.
+
+#include "larcore/Geometry/WireReadout.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/WireGeo.h"
+#include "dunecore/ArtSupport/ArtServiceHelper.h"
+#include "dunecore/Geometry/ChannelGeo.h"
+#include "dunecore/Geometry/ChannelGeoTable.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::ofstream;
+using std::istringstream;
+using std::ostringstream;
+using std::vector;
+using geo::PlaneID;
+using geo::WireID;
+using Index = unsigned int;
+using Clock = std::chrono::steady_clock;
+
+//**********************************************************************
+
+namespace {
+
+// Accumulates results from the timed calls so they are not optimized away.
+volatile Index sink = 0;
+
+class Reporter {
+public:
+  Reporter(string gname, string ofname) : m_gname(gname), m_ofname(ofname) { }
+  void report(string query, Index ncall, Clock::duration dt) const {
+    double nsec = std::chrono::duration<double, std::nano>(dt).count();
+    double nsPerCall = ncall ? nsec/ncall : 0.0;
+    ostringstream sout;
+    sout << "{\"geometry\": \"" << m_gname << "\", \"query\": \"" << query << "\""
+         << ", \"ncall\": " << ncall
+         << ", \"ns_per_call\": " << std::fixed << std::setprecision(2) << nsPerCall << "}";
+    cout << sout.str() << endl;
+    if ( m_ofname.size() ) {
+      ofstream fout(m_ofname, std::ios::app);
+      fout << sout.str() << endl;
+    }
+  }
+private:
+  string m_gname;
+  string m_ofname;
+};
+
+}  // end unnamed namespace
+
+//**********************************************************************
+
+int bench_GeometryDune(string gname, string rname, Index nrep, string ofname) {
+  const string myname = "bench_GeometryDune: ";
+  Reporter rep(gname, ofname);
+  if ( nrep == 0 ) nrep = 1;
+
+  cout << myname << "Loading geometry " << gname << " with readout " << rname << endl;
+  std::stringstream config;
+  config << "#include \"geometry_dune.fcl\"" << endl;
+  config << "services.Geometry: @local::" << gname << endl;
+  config << "services.WireReadout: @local::" << rname << endl;
+  Clock::time_point t0 = Clock::now();
+  ArtServiceHelper::load_services(config);
+  art::ServiceHandle<geo::Geometry> pgeo;
+  auto const& wireReadout = art::ServiceHandle<geo::WireReadout>()->Get();
+  rep.report("Construction", 1, Clock::now() - t0);
+
+  Index ncha = wireReadout.Nchannels();
+  cout << myname << "  Detector: " << pgeo->DetectorName() << endl;
+  cout << myname << "  # channels: " << ncha << endl;
+
+  // Collect the wire IDs and wire centers outside the timing loops.
+  vector<WireID> wids;
+  vector<geo::Point_t> centers;
+  for ( const PlaneID& pid : wireReadout.Iterate<PlaneID>() ) {
+    for ( Index iwir=0; iwir<wireReadout.Nwires(pid); ++iwir ) {
+      WireID wid(pid, iwir);
+      wids.push_back(wid);
+      centers.push_back(wireReadout.Wire(wid).GetCenter());
+    }
+  }
+  Index nwir = wids.size();
+  cout << myname << "  # wires: " << nwir << endl;
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    for ( Index icha=0; icha<ncha; ++icha ) sink += wireReadout.ChannelToWire(icha).size();
+  }
+  rep.report("ChannelToWire", nrep*ncha, Clock::now() - t0);
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    for ( Index icha=0; icha<ncha; ++icha ) sink += wireReadout.ChannelToROP(icha).ROP;
+  }
+  rep.report("ChannelToROP", nrep*ncha, Clock::now() - t0);
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    for ( Index icha=0; icha<ncha; ++icha ) sink += wireReadout.SignalType(icha);
+  }
+  rep.report("SignalType", nrep*ncha, Clock::now() - t0);
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    for ( Index iwir=0; iwir<nwir; ++iwir ) {
+      sink += wireReadout.NearestWireID(centers[iwir], wids[iwir].planeID()).Wire;
+    }
+  }
+  rep.report("NearestWireID", nrep*nwir, Clock::now() - t0);
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    for ( Index iwir=0; iwir<nwir; ++iwir ) sink += wireReadout.PlaneWireToChannel(wids[iwir]);
+  }
+  rep.report("PlaneWireToChannel", nrep*nwir, Clock::now() - t0);
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    for ( Index icha=0; icha<ncha; ++icha ) sink += ChannelGeo(icha, &wireReadout).nWires();
+  }
+  rep.report("ChannelGeo", nrep*ncha, Clock::now() - t0);
+
+  t0 = Clock::now();
+  for ( Index irep=0; irep<nrep; ++irep ) {
+    ChannelGeoTable tab(&wireReadout, pgeo->DetectorName());
+    sink += tab.size();
+  }
+  rep.report("ChannelGeoTable", nrep*ncha, Clock::now() - t0);
+
+  return 0;
+}
+
+//**********************************************************************
+
+int main(int argc, char* argv[]) {
+  string gname = "dune10kt_1x2x6_geo";
+  string rname = "dune_wire_readout";
+  Index nrep = 1;
+  string ofname;
+  if ( argc > 1 ) {
+    string sarg = argv[1];
+    if ( sarg == "-h" ) {
+      cout << "Usage: " << argv[0] << " [gname] [rname] [nrep] [ofname]" << endl;
+      cout << "  gname: Geometry name, e.g. protodunev7_geo" << endl;
+      cout << "  rname: Wire readout name, e.g. dune_wire_readout" << endl;
+      cout << "  nrep: # passes for each query" << endl;
+      cout << "  ofname: If not blank, results are appended to this file" << endl;
+      return 0;
+    }
+    gname = sarg;
+    if ( argc > 2 ) {
+      rname = argv[2];
+      if ( argc > 3 ) {
+        istringstream ssarg(argv[3]);
+        ssarg >> nrep;
+        if ( argc > 4 ) ofname = argv[4];
+      }
+    }
+  }
+  return bench_GeometryDune(gname, rname, nrep, ofname);
+}
+
+//**********************************************************************
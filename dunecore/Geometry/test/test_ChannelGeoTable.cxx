@@ -0,0 +1,141 @@
+// test_ChannelGeoTable.cxx
+//
+// Test ChannelGeoTable: build the table for a geometry, write it to a file,
+// read it back and check the values against ChannelGeo. Also check that the
+// table key changes with the readout configuration.
+
+#undef NDEBUG
+
+#include "dunecore/Geometry/ChannelGeoTable.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcore/Geometry/Geometry.h"
+#include "dunecore/ArtSupport/ArtServiceHelper.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "fhiclcpp/ParameterSet.h"
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using Index = ChannelGeoTable::Index;
+using Key = ChannelGeoTable::Key;
+
+//**********************************************************************
+
+bool samePoint(const ChannelGeoTable::Point& pt1, const ChannelGeoTable::Point& pt2) {
+  return pt1.x() == pt2.x() && pt1.y() == pt2.y() && pt1.z() == pt2.z();
+}
+
+// Check a table against ChannelGeo for every channel.
+// Returns the number of mismatched channels.
+Index checkTable(const ChannelGeoTable& tab, const geo::WireReadoutGeom* wireReadout) {
+  Index nbad = 0;
+  for ( Index icha=0; icha<tab.size(); ++icha ) {
+    ChannelGeo cgeo(icha, wireReadout);
+    bool ok = cgeo.isValid() && tab.isValid(icha) && tab.nWires(icha) == cgeo.nWires();
+    if ( ok && cgeo.nWires() ) {
+      ok = samePoint(tab.top(icha), cgeo.top()) && samePoint(tab.bottom(icha), cgeo.bottom());
+    }
+    for ( Index iwir=0; ok && iwir<cgeo.nWires(); ++iwir ) {
+      ok = samePoint(tab.wires(icha)[iwir].first, cgeo.wires()[iwir].first) &&
+           samePoint(tab.wires(icha)[iwir].second, cgeo.wires()[iwir].second);
+    }
+    if ( ! ok ) ++nbad;
+  }
+  return nbad;
+}
+
+//**********************************************************************
+
+int test_ChannelGeoTable(string gname) {
+  const string myname = "test_ChannelGeoTable: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+
+  cout << myname << line << endl;
+  cout << myname << "Load geometry " << gname << endl;
+  std::stringstream config;
+  config << "#include \"geometry_dune.fcl\"" << endl;
+  config << "services.Geometry:                   @local::" + gname << endl;
+  config << "services.WireReadout:     @local::dune_wire_readout" << endl;
+  ArtServiceHelper::load_services(config);
+  const geo::GeometryCore* pgeo = art::ServiceHandle<geo::Geometry>().get();
+  const geo::WireReadoutGeom* wireReadout = &art::ServiceHandle<geo::WireReadout>()->Get();
+  Index ncha = wireReadout->Nchannels();
+  cout << myname << "  # channels: " << ncha << endl;
+  assert( ncha > 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Build the table." << endl;
+  ChannelGeoTable tab;
+  Key key = ChannelGeoTable::makeKey(pgeo, wireReadout);
+  assert( tab.key() == key );
+  assert( tab.size() == ncha );
+  assert( tab.detectorName() == pgeo->DetectorName() );
+  assert( ! tab.isMapped() );
+  assert( checkTable(tab, wireReadout) == 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Check the key depends on the readout configuration." << endl;
+  const fhicl::ParameterSet* prdoPars = geo::GeometryKey::readoutParameters(wireReadout);
+  assert( prdoPars != nullptr );
+  assert( ChannelGeoTable::makeKey(pgeo, wireReadout, *prdoPars) == key );
+  fhicl::ParameterSet sortPars = *prdoPars;
+  string sorter = sortPars.get<string>("WireSorterClass", "");
+  string otherSorter = sorter == "WireReadoutSorter35" ? "WireReadoutSorterAPA" : "WireReadoutSorter35";
+  sortPars.put_or_replace("WireSorterClass", otherSorter);
+  Key sortKey = ChannelGeoTable::makeKey(pgeo, wireReadout, sortPars);
+  cout << myname << "  Key: " << std::hex << key << ", with other sorter: " << sortKey << std::dec << endl;
+  assert( sortKey != key );
+
+  cout << myname << line << endl;
+  cout << myname << "Write and read back." << endl;
+  string fname = ChannelGeoTable::fileName(".", key);
+  cout << myname << "  File: " << fname << endl;
+  assert( tab.write(fname) == 0 );
+  std::unique_ptr<ChannelGeoTable> ptab = ChannelGeoTable::read(fname, key, ncha);
+  assert( ptab );
+  assert( ptab->isMapped() );
+  assert( ptab->key() == key );
+  assert( ptab->size() == ncha );
+  assert( ptab->detectorName() == pgeo->DetectorName() );
+  assert( checkTable(*ptab, wireReadout) == 0 );
+
+  cout << myname << line << endl;
+  cout << myname << "Reject mismatches." << endl;
+  assert( ! ChannelGeoTable::read(fname, key + 1) );
+  assert( ! ChannelGeoTable::read(fname, sortKey) );
+  assert( ! ChannelGeoTable::read(fname, key, ncha + 1) );
+  assert( ! ChannelGeoTable::read(fname + ".nosuch", key) );
+  ptab.reset();
+  std::remove(fname.c_str());
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main(int argc, char* argv[]) {
+  string gname = "dune10kt_1x2x6_geo";
+  if ( argc > 1 ) {
+    string sarg = argv[1];
+    if ( sarg == "-h" ) {
+      cout << "Usage: " << argv[0] << " [gname]" << endl;
+      cout << "  gname: Geometry name, e.g. protodunev7_geo" << endl;
+      return 0;
+    }
+    gname = sarg;
+  }
+  return test_ChannelGeoTable(gname);
+}
+
+//**********************************************************************
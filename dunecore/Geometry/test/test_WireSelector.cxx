@@ -26,6 +26,7 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include "dunecore/ArtSupport/ArtServiceHelper.h"
 #include "art/Framework/Services/Registry/ServiceHandle.h"
 #include "../WireSelector.h"
@@ -263,6 +264,112 @@ int test_WireSelector(string gname, double wireAngle, double minDrift, unsigned
   assert( ws.data().size() == nwirSel );
   assert( ws.dataMap().size() == nwirSel );
   assert( wsum.size() == nwirSel );
+  const WireSelector::WireInfoPtrVector& chaIndex = ws.fillChannelIndex();
+  cout << myname << "   Indexed wire count: " << chaIndex.size() << endl;
+  assert( chaIndex.size() == nwirSel );
+  for ( Index icha=0; icha<ncha; icha += 97 ) {
+    auto rng = ws.channelWires(icha);
+    auto mrng = ws.dataMap().equal_range(icha);
+    assert( Index(rng.second - rng.first) == ws.dataMap().count(icha) );
+    for ( auto ient=rng.first; ient!=rng.second; ++ient, ++mrng.first ) {
+      assert( *ient == mrng.first->second );
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Check spatial index" << endl;
+  const WireSelector::WireIndex& win = ws.fillWireIndex();
+  assert( win.size() == nwirSel );
+  {
+    // Box at the center of the selected region.
+    double dx = 0.1*(wsum.xmax - wsum.xmin);
+    double dy = 0.1*(wsum.ymax - wsum.ymin);
+    double dz = 0.1*(wsum.zmax - wsum.zmin);
+    double xc = 0.5*(wsum.xmax + wsum.xmin);
+    double yc = 0.5*(wsum.ymax + wsum.ymin);
+    double zc = 0.5*(wsum.zmax + wsum.zmin);
+    WireSelector::Point pmin(xc - dx, yc - dy, zc - dz);
+    WireSelector::Point pmax(xc + dx, yc + dy, zc + dz);
+    WireSelector::IndexVector iwirsBox = ws.wiresInBox(pmin, pmax);
+    cout << myname << "  # wires crossing box: " << iwirsBox.size() << endl;
+    WireSelector::IndexVector iwirsSeg = ws.wiresCrossingSegment(pmin, pmax);
+    cout << myname << "  # wires crossing segment: " << iwirsSeg.size() << endl;
+    assert( iwirsBox.size() > 0 );
+    // Brute-force evaluation over all wires without the index.
+    WireSelector::IndexVector iwirsBoxChk;
+    WireSelector::IndexVector iwirsSegChk;
+    for ( const WireSelector::PlaneIndex& pin : win.planes ) {
+      ROOT::Math::RotationX const rot{pin.rotAngle};
+      ROOT::Math::RotationX const rotInv = rot.Inverse();
+      // Box corners in the wire frame.
+      vector<WireSelector::Point> boxCors;
+      for ( double yval : {pmin.y(), pmax.y()} ) {
+        for ( double zval : {pmin.z(), pmax.z()} ) {
+          boxCors.push_back(rot(WireSelector::Point(0.0, yval, zval)));
+        }
+      }
+      WireSelector::Point q1 = rot(pmin);
+      WireSelector::Point q2 = rot(pmax);
+      for ( Index iwir=pin.begin; iwir<pin.end; ++iwir ) {
+        const WireSelector::WireInfo& dat = ws.data()[iwir];
+        // Box: the x ranges overlap and no separating axis in the y-z plane.
+        bool inBox = dat.x2() >= pmin.x() && dat.x1() <= pmax.x();
+        // Wire axes.
+        double ymin = 1.e20, ymax = -1.e20, zmin = 1.e20, zmax = -1.e20;
+        for ( const WireSelector::Point& cor : boxCors ) {
+          ymin = std::min(ymin, cor.y());
+          ymax = std::max(ymax, cor.y());
+          zmin = std::min(zmin, cor.z());
+          zmax = std::max(zmax, cor.z());
+        }
+        if ( ymax < dat.y1() || ymin > dat.y2() ) inBox = false;
+        if ( zmax < dat.z1() || zmin > dat.z2() ) inBox = false;
+        // Global axes.
+        ymin = 1.e20; ymax = -1.e20; zmin = 1.e20; zmax = -1.e20;
+        for ( double yval : {dat.y1(), dat.y2()} ) {
+          for ( double zval : {dat.z1(), dat.z2()} ) {
+            WireSelector::Point cor = rotInv(WireSelector::Point(0.0, yval, zval));
+            ymin = std::min(ymin, cor.y());
+            ymax = std::max(ymax, cor.y());
+            zmin = std::min(zmin, cor.z());
+            zmax = std::max(zmax, cor.z());
+          }
+        }
+        if ( ymax < pmin.y() || ymin > pmax.y() ) inBox = false;
+        if ( zmax < pmin.z() || zmin > pmax.z() ) inBox = false;
+        if ( inBox ) iwirsBoxChk.push_back(iwir);
+        // Segment: clip to each coordinate range of the drift volume.
+        double t1 = 0.0;
+        double t2 = 1.0;
+        double c1s[3] = {q1.x(), q1.y(), q1.z()};
+        double c2s[3] = {q2.x(), q2.y(), q2.z()};
+        double cmins[3] = {dat.x1(), dat.y1(), dat.z1()};
+        double cmaxs[3] = {dat.x2(), dat.y2(), dat.z2()};
+        for ( Index icrd=0; icrd<3 && t1<=t2; ++icrd ) {
+          double dc = c2s[icrd] - c1s[icrd];
+          if ( dc == 0.0 ) {
+            if ( c1s[icrd] < cmins[icrd] || c1s[icrd] > cmaxs[icrd] ) t2 = -1.0;
+            continue;
+          }
+          double ta = (cmins[icrd] - c1s[icrd])/dc;
+          double tb = (cmaxs[icrd] - c1s[icrd])/dc;
+          t1 = std::max(t1, std::min(ta, tb));
+          t2 = std::min(t2, std::max(ta, tb));
+        }
+        if ( t1 <= t2 ) iwirsSegChk.push_back(iwir);
+      }
+    }
+    cout << myname << "  # wires crossing box (brute force): " << iwirsBoxChk.size() << endl;
+    cout << myname << "  # wires crossing segment (brute force): " << iwirsSegChk.size() << endl;
+    std::sort(iwirsBox.begin(), iwirsBox.end());
+    std::sort(iwirsSeg.begin(), iwirsSeg.end());
+    assert( iwirsBox == iwirsBoxChk );
+    assert( iwirsSeg == iwirsSegChk );
+    // Every wire crossing the box diagonal also crosses the box.
+    for ( Index iwir : iwirsSeg ) {
+      assert( std::binary_search(iwirsBox.begin(), iwirsBox.end(), iwir) );
+    }
+  }
 
   // Build discriminated adcdata as a vector of x-values for each channel.
   cout << myname << line << endl;
@@ -295,9 +402,9 @@ int test_WireSelector(string gname, double wireAngle, double minDrift, unsigned
   vector<float> zsigs;
   for ( Index icha=0; icha<ncha; ++icha ) {
     // Loop over the wires read out by this channel.
-    auto range = ws.dataMap().equal_range(icha);
+    auto range = ws.channelWires(icha);
     for ( auto ient=range.first; ient!=range.second; ++ient ) {
-      const WireSelector::WireInfo* pdat = ient->second;
+      const WireSelector::WireInfo* pdat = *ient;
       float zsig = pdat->z;
       // Loop over the ticks hit for this channel.
       for ( float xsig : adcdata[icha] ) {
@@ -12,6 +12,10 @@
 //    projected (drifted) charge.
 //  - LEM borders and dead areas can be taken into account
 // 
+// The geometry needed to evaluate the gain for each channel (plane, other
+// plane, drift coordinate and the LEM row along the wire) is cached at the
+// start of each run so that the per-tick evaluation is a table lookup.
+// Use viewCharges to evaluate all the ticks of a SimChannel in one call.
 //
 ////////////////////////////////////////////////////////////////////////
 
@@ -20,20 +24,28 @@
 
 #include <vector>
 #include <string>
+#include <map>
 
 #include "larcorealg/Geometry/fwd.h"
+#include "larcoreobj/SimpleTypesAndConstants/geo_types.h"
 #include "larcoreobj/SimpleTypesAndConstants/geo_vectors.h"
 #include "art/Framework/Services/Registry/ServiceMacros.h"
 #include "fhiclcpp/fwd.h"
 
-namespace sim {
-  class SimChannel;
-}
-
 namespace util {
   class CrpGainService;
 }
 
+namespace art {
+  class ActivityRegistry;
+  class Run;
+}
+
+namespace sim {
+  class SimChannel;
+  struct IDE;
+}
+
 class FloatArrayTool;
 
 
@@ -45,21 +57,63 @@ class CrpGainService {
 public:
   using FloatArrayPtr = const FloatArrayTool*;
   
-  explicit CrpGainService(fhicl::ParameterSet const& ps);
+  CrpGainService(fhicl::ParameterSet const& ps, art::ActivityRegistry& reg);
   // The compiler-generated destructor is fine for non-base
   // classes without bare pointers or other resource use.
   
   // get charge collected on a view after amplification in CRP
   double viewCharge( const sim::SimChannel* psc, unsigned itck ) const;
+
+  // get the charge for all ticks of a channel
+  // qtcks[itck] is set for each tick itck < qtcks.size() with charge
+  // and other entries are left unchanged
+  void viewCharges( const sim::SimChannel* psc, std::vector<double>& qtcks ) const;
   
   // calculate the gain based on position information
   double crpGain( geo::Point_t const &pos ) const;
 
   // default value of the effective gain
   double crpDefaultGain() const { return m_CrpDefGain; }
+
+  // (re)build the channel cache
+  // this is done at the start of each run; before that the gain
+  // geometry is evaluated for each call
+  void buildChannelCache();
+
+  // return if the channel cache has been built
+  bool hasChannelCache() const { return !m_chanInfos.empty(); }
   
 private:
+  // geometry for the other view in a CRP
+  // the wire coordinate is c0 + cx*x + cy*y + cz*z
+  struct PlaneInfo {
+    double c0 = 0.0;
+    double cx = 0.0;
+    double cy = 0.0;
+    double cz = 0.0;
+    int nwires = 0;
+  };
+
+  // precomputed information for each channel
+  // for wire wother in the other view, the LEM ID within the CRP is
+  //   lemBase + (wother / m_LemViewChans) * lemStride
+  // and the index in the LEM transparency map is
+  //   effBase + (wother % m_LemViewChans) * effStride
+  struct ChannelInfo {
+    int crp = -1;         // < 0 if the gain cannot be evaluated for this channel
+    int otherPlane = -1;  // index in m_planeInfos
+    unsigned lemBase = 0;
+    unsigned lemStride = 0;
+    unsigned effBase = 0;
+    unsigned effStride = 0;
+  };
+
   // methods
+  void   beginRun( art::Run const& run );
+  ChannelInfo makeChannelInfo( unsigned chan, std::vector<PlaneInfo>& planeInfos,
+                               std::map<geo::PlaneID, int>& planeIndex ) const;
+  double idesCharge( const ChannelInfo& info, const PlaneInfo& pin,
+                     const std::vector<sim::IDE>& ides ) const;
   bool   checkGeoConfig() const;
   int    getLemId( unsigned crp, int chx, int chy ) const;
   double getCrpGain( unsigned crp, int chx, int chy ) const;
@@ -90,6 +144,13 @@ private:
   // dummy for now ...
   std::vector<float> m_lemgainmap;
 
+  // copy of the LEM transparency map
+  std::vector<float> m_lemeff;
+
+  // channel cache
+  std::vector<PlaneInfo> m_planeInfos;
+  std::vector<ChannelInfo> m_chanInfos;
+
   // detector geometry
   const geo::GeometryCore* m_geo;
   const geo::WireReadoutGeom* m_wireReadout;
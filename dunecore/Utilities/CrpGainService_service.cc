@@ -11,6 +11,8 @@
 
 #include "CrpGainService.h"
 #include "art/Framework/Services/Registry/ServiceDefinitionMacros.h"
+#include "art/Framework/Services/Registry/ActivityRegistry.h"
+#include "art/Framework/Principal/Run.h"
 #include "fhiclcpp/ParameterSet.h"
 
 #include "larcore/Geometry/WireReadout.h"
@@ -29,7 +31,7 @@ using std::endl;
 using std::string;
 
 // ctor
-util::CrpGainService::CrpGainService(fhicl::ParameterSet const& ps)
+util::CrpGainService::CrpGainService(fhicl::ParameterSet const& ps, art::ActivityRegistry& reg)
 {
   const string myname = "util::CrpGainService::ctor: ";
   m_LogLevel     = ps.get<int>("LogLevel");
@@ -89,7 +91,13 @@ util::CrpGainService::CrpGainService(fhicl::ParameterSet const& ps)
     if( m_LemTotChans != m_plemeff->size() ){
       cout<<myname<<"WARNING the LEM transmission map does not match the expected size."<<endl;
     }
+    // keep a local copy of the map to avoid a virtual call per lookup
+    m_lemeff.resize( m_plemeff->size() );
+    for( unsigned idx=0; idx<m_lemeff.size(); ++idx ) m_lemeff[idx] = m_plemeff->value(idx, 0.0);
   }
+
+  // the channel cache is (re)built at the start of each run
+  if( !m_UseDefGain ) reg.sPreBeginRun.watch(this, &util::CrpGainService::beginRun);
   
   // dump
   int nlemeff = ps.get<int>("DumpLemEff", 0);
@@ -133,24 +141,44 @@ bool util::CrpGainService::checkGeoConfig() const
 
 
 //
-// get view charge
-double util::CrpGainService::viewCharge( const sim::SimChannel* psc, unsigned itck ) const
+// build the channel cache at the start of each run
+void util::CrpGainService::beginRun( art::Run const& )
 {
-  const string myname = "util::CrpGainService::viewCharge: ";
-  
-  double q = psc->Charge(itck);
-  if(q <= 1.0E-3) return 0; //if 0 nothing to do -> return 0
+  buildChannelCache();
+}
 
-  // default result: divide the charge equally between collection views
-  q *= (0.5 * m_CrpDefGain);
-  
-  // use default gain value given if no other information is provided
-  if( m_UseDefGain ) return q;
+//
+//
+void util::CrpGainService::buildChannelCache()
+{
+  const string myname = "util::CrpGainService::buildChannelCache: ";
+  m_planeInfos.clear();
+  m_chanInfos.clear();
+  std::map<geo::PlaneID, int> planeIndex;
+  unsigned nchan = m_wireReadout->Nchannels();
+  m_chanInfos.reserve( nchan );
+  for( unsigned chan=0; chan<nchan; ++chan )
+    {
+      m_chanInfos.push_back( makeChannelInfo( chan, m_planeInfos, planeIndex ) );
+    }
+  if( m_LogLevel >= 1 )
+    {
+      cout<<myname<<"Cached geometry for "<<m_chanInfos.size()<<" channels and "
+	  <<m_planeInfos.size()<<" planes"<<endl;
+    }
+}
 
-  //
-  // otherwise ... 
+//
+//
+util::CrpGainService::ChannelInfo
+util::CrpGainService::makeChannelInfo( unsigned chan, std::vector<PlaneInfo>& planeInfos,
+                                       std::map<geo::PlaneID, int>& planeIndex ) const
+{
+  const string myname = "util::CrpGainService::makeChannelInfo: ";
+  ChannelInfo info;
 
-  std::vector< geo::WireID > wids = m_wireReadout->ChannelToWire( psc->Channel() );
+  std::vector< geo::WireID > wids = m_wireReadout->ChannelToWire( chan );
+  if( wids.empty() ) return info;
   geo::WireID wid  = wids[0];
   
   // get tpc
@@ -164,7 +192,8 @@ double util::CrpGainService::viewCharge( const sim::SimChannel* psc, unsigned it
   // other plane
   unsigned widother = 0;
   if(wid.Plane == 0 ) widother = 1;
-  const geo::PlaneGeo& pother = m_wireReadout->Plane({tpcid, widother});
+  geo::PlaneID const pidother{tpcid, widother};
+  const geo::PlaneGeo& pother = m_wireReadout->Plane(pidother);
   
   // get drift axis
   auto const [axis, _] = m_geo->TPC(wid).DriftAxisWithSign();
@@ -181,7 +210,7 @@ double util::CrpGainService::viewCharge( const sim::SimChannel* psc, unsigned it
 
   if( m_LogLevel >= 3 )
     {
-      cout<<myname<<"chan "<<psc->Channel()
+      cout<<myname<<"chan "<<chan
 	  <<" plane  "<<wid.Plane
 	  <<" wire "<<wire
 	  <<" view "<<pthis.View()
@@ -191,53 +220,176 @@ double util::CrpGainService::viewCharge( const sim::SimChannel* psc, unsigned it
 
   if( tcoord < 0 || (tcoord == 2 && pother.View() != geo::kZ) )
     {
-      cout<<myname<<"WARNING cannot figure out the coordinate system\n";
-      // return the default value
-      return q;
+      cout<<myname<<"WARNING cannot figure out the coordinate system for channel "<<chan<<"\n";
+      return info;
     }
 
-  
-  // get IDEs for this tick
-  std::vector<sim::IDE> IDEs = psc->TrackIDsAndEnergies( itck, itck );
-  if( IDEs.empty() )
+  // the wire coordinate is linear in position
+  auto iplane = planeIndex.find( pidother );
+  if( iplane == planeIndex.end() )
     {
-      cout<<myname<<"WARNING could not get IDEs for tick "<<itck<<endl;
-      return q;
+      PlaneInfo pin;
+      pin.c0 = pother.WireCoordinate( geo::Point_t{0.0, 0.0, 0.0} );
+      pin.cx = pother.WireCoordinate( geo::Point_t{1.0, 0.0, 0.0} ) - pin.c0;
+      pin.cy = pother.WireCoordinate( geo::Point_t{0.0, 1.0, 0.0} ) - pin.c0;
+      pin.cz = pother.WireCoordinate( geo::Point_t{0.0, 0.0, 1.0} ) - pin.c0;
+      pin.nwires = pother.Nwires();
+      iplane = planeIndex.emplace( pidother, planeInfos.size() ).first;
+      planeInfos.push_back( pin );
     }
-  
-  unsigned tpcnum = wid.TPC;
-  
-  //
+
+  // LEM and transparency map indices along this wire
+  // this view gives the x LEM coordinate in view kZ and y otherwise
+  unsigned iW = (unsigned)wire / m_LemViewChans;
+  unsigned jW = (unsigned)wire % m_LemViewChans;
+  info.crp        = wid.TPC;
+  info.otherPlane = iplane->second;
+  if( tcoord < 2 )
+    {
+      info.lemBase   = iW * m_CrpNLemPerSide;
+      info.lemStride = 1;
+      info.effBase   = jW;
+      info.effStride = m_LemViewChans;
+    }
+  else
+    {
+      info.lemBase   = iW;
+      info.lemStride = m_CrpNLemPerSide;
+      info.effBase   = jW * m_LemViewChans;
+      info.effStride = 1;
+    }
+  return info;
+}
+
+//
+// sum of the amplified charge for a list of IDEs
+double util::CrpGainService::idesCharge( const ChannelInfo& info, const PlaneInfo& pin,
+                                         const std::vector<sim::IDE>& ides ) const
+{
+  const string myname = "util::CrpGainService::idesCharge: ";
   double qsum = 0.0;
-  for(auto &ide: IDEs)
+  for(auto &ide: ides)
     {
 
       // get the wire number in the other view for this position
-      int wother = pother.WireCoordinate( geo::Point_t{ide.x, ide.y, ide.z} );
-      if( wother < 0 || wother >= (int)pother.Nwires() ) 
+      int wother = pin.c0 + pin.cx*ide.x + pin.cy*ide.y + pin.cz*ide.z;
+      if( wother < 0 || wother >= pin.nwires ) 
 	{
 	  cout<<myname<<"WARNING the wire number appeares to be incorrect "<<wother<<"\n";
 	  continue;
 	}
-      
+
+      // gain for this LEM per view
+      unsigned lemid = info.lemBase + ((unsigned)wother / m_LemViewChans) * info.lemStride;
       double G = 0;
-      if( tcoord < 2 ) // we are in view kZ
+      if( lemid >= m_CrpNLem )
+	{
+	  cout<<myname<<"WARNING LEM ID exceeds the number of declared LEMs: "<<lemid<<endl;
+	  G = getLemGain( -1 );
+	}
+      else
 	{
-          G = getCrpGain( tpcnum, wire, wother );
+	  G = getLemGain( lemid + info.crp * m_CrpNLem );
 	}
-      else // we are in view kX or kY
+
+      // transmission factor (dead areas)
+      if( m_plemeff )
 	{
-          G = getCrpGain( tpcnum, wother, wire );
+	  unsigned idx = info.effBase + ((unsigned)wother % m_LemViewChans) * info.effStride;
+	  G *= idx < m_lemeff.size() ? m_lemeff[idx] : 0.0;
 	}
+
       // the charge is divided equially between collectiong views
       // so the effective gain per view is 1/2 of the total effective CRP gain
       qsum += (0.5 * G) * ide.numElectrons;
     }
+  return qsum;
+}
+
+//
+// get view charge
+double util::CrpGainService::viewCharge( const sim::SimChannel* psc, unsigned itck ) const
+{
+  const string myname = "util::CrpGainService::viewCharge: ";
   
-  //if( q != qsum )
-  //cout<<q<<" "<<qsum<<endl;
+  double q = psc->Charge(itck);
+  if(q <= 1.0E-3) return 0; //if 0 nothing to do -> return 0
+
+  // default result: divide the charge equally between collection views
+  q *= (0.5 * m_CrpDefGain);
   
-  return qsum;
+  // use default gain value given if no other information is provided
+  if( m_UseDefGain ) return q;
+
+  //
+  // otherwise ... 
+
+  // use the cache if it has been built
+  unsigned chan = psc->Channel();
+  ChannelInfo info;
+  std::vector<PlaneInfo> planeInfos;
+  if( chan < m_chanInfos.size() )
+    {
+      info = m_chanInfos[chan];
+    }
+  else
+    {
+      std::map<geo::PlaneID, int> planeIndex;
+      info = makeChannelInfo( chan, planeInfos, planeIndex );
+    }
+  // return the default value if the coordinate system is not known
+  if( info.crp < 0 ) return q;
+  
+  // get IDEs for this tick
+  std::vector<sim::IDE> IDEs = psc->TrackIDsAndEnergies( itck, itck );
+  if( IDEs.empty() )
+    {
+      cout<<myname<<"WARNING could not get IDEs for tick "<<itck<<endl;
+      return q;
+    }
+
+  const PlaneInfo& pin = planeInfos.size() ? planeInfos[info.otherPlane] : m_planeInfos[info.otherPlane];
+  return idesCharge( info, pin, IDEs );
+}
+
+//
+// get the charges for all ticks of a channel
+void util::CrpGainService::viewCharges( const sim::SimChannel* psc, std::vector<double>& qtcks ) const
+{
+  unsigned chan = psc->Channel();
+  bool useCache = !m_UseDefGain && chan < m_chanInfos.size() && m_chanInfos[chan].crp >= 0;
+  if( !m_UseDefGain && !useCache )
+    {
+      // no cache or no valid coordinate system: fall back to the tick-by-tick evaluation
+      for( auto const& tdcide : psc->TDCIDEMap() )
+	{
+	  unsigned itck = tdcide.first;
+	  if( itck < qtcks.size() ) qtcks[itck] = viewCharge( psc, itck );
+	}
+      return;
+    }
+  for( auto const& tdcide : psc->TDCIDEMap() )
+    {
+      unsigned itck = tdcide.first;
+      if( itck >= qtcks.size() ) continue;
+      double q = 0.0;
+      for( auto const& ide : tdcide.second ) q += ide.numElectrons;
+      if( q <= 1.0E-3 )
+	{
+	  qtcks[itck] = 0.0;
+	}
+      else if( useCache )
+	{
+	  // IDEs merged by track as in viewCharge
+	  const ChannelInfo& info = m_chanInfos[chan];
+	  qtcks[itck] = idesCharge( info, m_planeInfos[info.otherPlane],
+				    psc->TrackIDsAndEnergies( itck, itck ) );
+	}
+      else
+	{
+	  qtcks[itck] = q * (0.5 * m_CrpDefGain);
+	}
+    }
 }
 
 //
@@ -0,0 +1,241 @@
+// test_CrpGainService.cxx
+//
+// Test CrpGainService: evaluate the view charges for a sequence of channels
+// that changes CRP and view from one channel to the next, first without the
+// channel cache and then with it, and check the results agree with each
+// other and with the per-position gain from crpGain.
+
+#include "dunecore/Utilities/CrpGainService.h"
+#include "dunecore/ArtSupport/DuneToolManager.h"
+#include "dunecore/ArtSupport/ArtServiceHelper.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "larcore/Geometry/WireReadout.h"
+#include "larcore/Geometry/Geometry.h"
+#include "larcorealg/Geometry/WireGeo.h"
+#include "larcorealg/Geometry/TPCGeo.h"
+#include "lardataobj/Simulation/SimChannel.h"
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+
+#undef NDEBUG
+#include <cassert>
+
+using std::string;
+using std::cout;
+using std::endl;
+using std::ofstream;
+using std::vector;
+using Index = unsigned int;
+using DoubleVector = vector<double>;
+
+//**********************************************************************
+
+bool sameCharge(double q1, double q2) {
+  return std::abs(q1 - q2) <= 1.e-9*(std::abs(q1) + std::abs(q2));
+}
+
+// Evaluate the charge for each tick with viewCharge and with viewCharges.
+void evaluate(const util::CrpGainService& svc, const vector<sim::SimChannel>& scs, Index ntck,
+              vector<DoubleVector>& qtcks, vector<DoubleVector>& qalls) {
+  qtcks.clear();
+  qalls.clear();
+  for ( const sim::SimChannel& sc : scs ) {
+    qtcks.emplace_back(ntck, 0.0);
+    qalls.emplace_back(ntck, 0.0);
+    for ( Index itck=0; itck<ntck; ++itck ) qtcks.back()[itck] = svc.viewCharge(&sc, itck);
+    svc.viewCharges(&sc, qalls.back());
+  }
+}
+
+//**********************************************************************
+
+int test_CrpGainService(string gname) {
+  const string myname = "test_CrpGainService: ";
+#ifdef NDEBUG
+  cout << myname << "NDEBUG must be off." << endl;
+  abort();
+#endif
+  string line = "-----------------------------";
+
+  Index nlem = 36;
+  Index nvch = 160;
+  Index ntck = 20;
+
+  cout << myname << line << endl;
+  cout << myname << "Create the LEM transparency tool." << endl;
+  string fclfile = "test_CrpGainService.fcl";
+  ofstream fout(fclfile.c_str());
+  fout << "tools: {" << endl;
+  fout << "  mylemeff: {" << endl;
+  fout << "    tool_type: FclFloatArray" << endl;
+  fout << "    LogLevel: 1" << endl;
+  fout << "    DefaultValue: 0.0" << endl;
+  fout << "    Offset: 0" << endl;
+  fout << "    Label: \"LEM transparency\"" << endl;
+  fout << "    Unit: \"\"" << endl;
+  fout << "    Values: [";
+  // Distinct values so that any indexing mismatch changes the charge.
+  for ( Index idx=0; idx<nvch*nvch; ++idx ) {
+    if ( idx ) fout << ", ";
+    fout << 1.0 - 1.e-5*idx;
+  }
+  fout << "]" << endl;
+  fout << "  }" << endl;
+  fout << "}" << endl;
+  fout.close();
+  DuneToolManager* ptm = DuneToolManager::instance(fclfile);
+  assert( ptm != nullptr );
+
+  cout << myname << line << endl;
+  cout << myname << "Load services for geometry " << gname << endl;
+  std::stringstream config;
+  config << "#include \"geometry_dune.fcl\"" << endl;
+  config << "services.Geometry:                   @local::" + gname << endl;
+  config << "services.WireReadout:     @local::dune_wire_readout" << endl;
+  config << "services.CrpGainService: {" << endl;
+  config << "  service_provider: CrpGainService" << endl;
+  config << "  LogLevel: 1" << endl;
+  config << "  CrpDefaultGain: 6" << endl;
+  config << "  CrpNumLem: " << nlem << endl;
+  config << "  LemViewChans: " << nvch << endl;
+  config << "  LemEffTool: mylemeff" << endl;
+  config << "}" << endl;
+  ArtServiceHelper::load_services(config);
+  const geo::GeometryCore* pgeo = art::ServiceHandle<geo::Geometry>().get();
+  const geo::WireReadoutGeom* wireReadout = &art::ServiceHandle<geo::WireReadout>()->Get();
+  util::CrpGainService& svc = *art::ServiceHandle<util::CrpGainService>();
+  assert( ! svc.hasChannelCache() );
+
+  cout << myname << line << endl;
+  cout << myname << "Create SimChannels." << endl;
+  // Channels are ordered so that consecutive channels change view and,
+  // every second channel, CRP.
+  vector<sim::SimChannel> scs;
+  Index ntpc = 0;
+  // Positions are placed between wire boundaries in both views so that the
+  // per-position reference and the cached linear wire coordinate agree.
+  for ( const geo::TPCID& tpcid : pgeo->Iterate<geo::TPCID>() ) {
+    if ( ntpc++ >= 2 ) break;
+    double xtpc = pgeo->TPC(tpcid).GetCenter().X();
+    for ( Index iwfr : {1, 3} ) {
+      for ( const geo::PlaneGeo& plane : wireReadout->Iterate<geo::PlaneGeo>(tpcid) ) {
+        const geo::PlaneGeo* pother = nullptr;
+        for ( const geo::PlaneGeo& plane2 : wireReadout->Iterate<geo::PlaneGeo>(tpcid) ) {
+          if ( plane2.ID() != plane.ID() ) pother = &plane2;
+        }
+        assert( pother != nullptr );
+        Index iwir = iwfr*plane.Nwires()/4;
+        geo::WireID wid(plane.ID(), iwir);
+        const geo::WireGeo& wire = wireReadout->Wire(wid);
+        // Move a quarter pitch off the wire and into the drift volume.
+        geo::Vector_t dwir = 0.25*plane.WirePitch()*plane.GetIncreasingWireDirection();
+        geo::Point_t pbeg = wire.GetStart() + dwir;
+        geo::Point_t pend = wire.GetEnd() + dwir;
+        pbeg.SetX(pbeg.X() + 0.1*(xtpc - pbeg.X()));
+        pend.SetX(pend.X() + 0.1*(xtpc - pend.X()));
+        geo::Vector_t ualong = (pend - pbeg).Unit();
+        double dwcAlong = pother->WireCoordinate(pbeg + ualong) - pother->WireCoordinate(pbeg);
+        assert( std::abs(dwcAlong) > 0.0 );
+        raw::ChannelID_t icha = wireReadout->PlaneWireToChannel(wid);
+        sim::SimChannel sc(icha);
+        // Each tick has a different position along the wire. Ticks with
+        // two tracks check the per-track sum.
+        for ( Index itck=0; itck<ntck; ++itck ) {
+          double frac = (itck + 0.5)/ntck;
+          geo::Point_t pos = pbeg + frac*(pend - pbeg);
+          // Center the position between two wires of the other view.
+          double wco = pother->WireCoordinate(pos);
+          pos += ((std::floor(wco) + 0.5 - wco)/dwcAlong)*ualong;
+          double xyz[3] = {pos.X(), pos.Y(), pos.Z()};
+          sc.AddIonizationElectrons(1, itck, 1000.0 + itck, xyz, 1.0);
+          if ( itck % 3 == 0 ) sc.AddIonizationElectrons(2, itck, 500.0, xyz, 0.5);
+        }
+        cout << myname << "  Channel " << icha << ": TPC " << tpcid.TPC
+             << ", plane " << plane.ID().Plane << ", wire " << iwir << endl;
+        scs.push_back(sc);
+      }
+    }
+  }
+  assert( scs.size() >= 4 );
+
+  cout << myname << line << endl;
+  cout << myname << "Evaluate the reference charges with the per-position gain." << endl;
+  vector<DoubleVector> qrefs;
+  for ( const sim::SimChannel& sc : scs ) {
+    qrefs.emplace_back(ntck, 0.0);
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      for ( const sim::IDE& ide : sc.TrackIDsAndEnergies(itck, itck) ) {
+        double gain = svc.crpGain(geo::Point_t{ide.x, ide.y, ide.z});
+        qrefs.back()[itck] += 0.5*gain*ide.numElectrons;
+      }
+    }
+  }
+
+  cout << myname << line << endl;
+  cout << myname << "Evaluate without the channel cache." << endl;
+  vector<DoubleVector> qtcksRaw, qallsRaw;
+  evaluate(svc, scs, ntck, qtcksRaw, qallsRaw);
+  assert( ! svc.hasChannelCache() );
+
+  cout << myname << line << endl;
+  cout << myname << "Evaluate with the channel cache." << endl;
+  svc.buildChannelCache();
+  assert( svc.hasChannelCache() );
+  vector<DoubleVector> qtcks, qalls;
+  evaluate(svc, scs, ntck, qtcks, qalls);
+
+  cout << myname << line << endl;
+  cout << myname << "Compare." << endl;
+  Index nbad = 0;
+  Index ndef = 0;
+  for ( Index isc=0; isc<scs.size(); ++isc ) {
+    for ( Index itck=0; itck<ntck; ++itck ) {
+      double qref = qrefs[isc][itck];
+      double qraw = qtcksRaw[isc][itck];
+      double qdef = 0.5*svc.crpDefaultGain()*scs[isc].Charge(itck);
+      assert( qref > 0.0 );
+      if ( sameCharge(qref, qdef) ) ++ndef;
+      bool ok = sameCharge(qraw, qref) &&
+                sameCharge(qtcks[isc][itck], qref) &&
+                sameCharge(qallsRaw[isc][itck], qref) &&
+                sameCharge(qalls[isc][itck], qref);
+      if ( ! ok ) {
+        cout << myname << "  Mismatch for channel " << scs[isc].Channel() << " tick " << itck
+             << ": " << qref << " " << qraw << " " << qtcks[isc][itck] << " "
+             << qallsRaw[isc][itck] << " " << qalls[isc][itck] << endl;
+        ++nbad;
+      }
+    }
+  }
+  cout << myname << "  # mismatches: " << nbad << endl;
+  cout << myname << "  # default gain: " << ndef << endl;
+  assert( nbad == 0 );
+  // The transparency map must be applied.
+  assert( ndef < scs.size()*ntck );
+
+  cout << myname << line << endl;
+  cout << myname << "Done." << endl;
+  return 0;
+}
+
+//**********************************************************************
+
+int main(int argc, char* argv[]) {
+  string gname = "protodunedphase_geo";
+  if ( argc > 1 ) {
+    string sarg = argv[1];
+    if ( sarg == "-h" ) {
+      cout << "Usage: " << argv[0] << " [gname]" << endl;
+      cout << "  gname: Geometry name, e.g. dunedphase10kt_geo" << endl;
+      return 0;
+    }
+    gname = sarg;
+  }
+  return test_CrpGainService(gname);
+}
+
+//**********************************************************************